@@ -0,0 +1,251 @@
+#include "AccessUnitParser.h"
+
+namespace {
+
+void addUnit(AccessUnitIndex* index, size_t offset, size_t size, uint8_t type, int temporal_id) {
+    if (index->nalCount >= MAX_ACCESS_UNIT_NALS) {
+        index->flags |= AU_FLAG_TRUNCATED;
+        return;
+    }
+    NalUnitInfo& unit = index->nals[index->nalCount++];
+    unit.offset = static_cast<uint32_t>(offset);
+    unit.size = static_cast<uint32_t>(size);
+    unit.type = type;
+    unit.temporalId = static_cast<int8_t>(temporal_id);
+    unit.reserved = 0;
+}
+
+// Returns the offset just past the next start code at or after from, and
+// stores the offset where that start code (including a leading zero byte of
+// a 4-byte code) begins. Returns size when there is none.
+size_t findStartCode(const uint8_t* data, size_t size, size_t from, size_t* code_begin) {
+    for (size_t i = from; i + 3 <= size; ++i) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            *code_begin = (i > from && data[i - 1] == 0) ? i - 1 : i;
+            return i + 3;
+        }
+    }
+    *code_begin = size;
+    return size;
+}
+
+void parseAnnexB(VideoCodecType codec_type, const uint8_t* data, size_t size, AccessUnitIndex* index) {
+    const bool hevc = codec_type == VIDEO_CODEC_H265;
+    size_t ignored;
+    size_t nal_start = findStartCode(data, size, 0, &ignored);
+    if (nal_start == size && size > 0) {
+        index->flags |= AU_FLAG_MALFORMED;
+        return;
+    }
+    while (nal_start < size) {
+        size_t next_code_begin;
+        size_t next_start = findStartCode(data, size, nal_start, &next_code_begin);
+        size_t nal_end = next_code_begin;
+        // Drop trailing_zero_8bits so size covers only the unit itself.
+        while (nal_end > nal_start && data[nal_end - 1] == 0) {
+            --nal_end;
+        }
+        const uint8_t* nal = data + nal_start;
+        size_t nal_size = nal_end - nal_start;
+        if (nal_size < (hevc ? 2u : 1u)) {
+            index->flags |= AU_FLAG_MALFORMED;
+            nal_start = next_start;
+            continue;
+        }
+
+        uint8_t type;
+        int temporal_id = -1;
+        bool vcl;
+        if (hevc) {
+            type = (nal[0] >> 1) & 0x3F;
+            temporal_id = (nal[1] & 0x07) - 1;
+            vcl = type < 32;
+            if (type >= 16 && type <= 23) {
+                index->flags |= AU_FLAG_KEYFRAME;
+            } else if (type == 32) {
+                index->flags |= AU_FLAG_HAS_VPS;
+            } else if (type == 33) {
+                index->flags |= AU_FLAG_HAS_SPS;
+            } else if (type == 34) {
+                index->flags |= AU_FLAG_HAS_PPS;
+            }
+        } else {
+            type = nal[0] & 0x1F;
+            vcl = (type >= 1 && type <= 5) || type == 14 || type == 20;
+            // Prefix and SVC slice units carry temporal_id in their header
+            // extension; plain AVC leaves it unsignalled.
+            if ((type == 14 || type == 20) && nal_size >= 4 && (nal[1] & 0x80)) {
+                temporal_id = nal[3] >> 5;
+            }
+            if (type == 5) {
+                index->flags |= AU_FLAG_KEYFRAME;
+            } else if (type == 7) {
+                index->flags |= AU_FLAG_HAS_SPS;
+            } else if (type == 8) {
+                index->flags |= AU_FLAG_HAS_PPS;
+            }
+        }
+        if (vcl && index->temporalId < 0) {
+            index->temporalId = temporal_id;
+        }
+        addUnit(index, nal_start, nal_size, type, temporal_id);
+        nal_start = next_start;
+    }
+}
+
+void parseAv1(const uint8_t* data, size_t size, AccessUnitIndex* index) {
+    enum {
+        OBU_SEQUENCE_HEADER = 1,
+        OBU_FRAME_HEADER = 3,
+        OBU_TILE_GROUP = 4,
+        OBU_FRAME = 6
+    };
+    bool reduced_still_picture_header = false;
+    size_t pos = 0;
+    while (pos < size) {
+        const size_t obu_start = pos;
+        const uint8_t header = data[pos++];
+        if (header & 0x80) {
+            index->flags |= AU_FLAG_MALFORMED;
+            return;
+        }
+        const uint8_t type = (header >> 3) & 0x0F;
+        const bool has_extension = (header & 0x04) != 0;
+        const bool has_size = (header & 0x02) != 0;
+        int temporal_id = -1;
+        if (has_extension) {
+            if (pos >= size) {
+                index->flags |= AU_FLAG_MALFORMED;
+                return;
+            }
+            temporal_id = data[pos++] >> 5;
+        }
+        uint64_t payload_size = size - pos;
+        if (has_size && (!readLeb128(data, size, &pos, &payload_size) || payload_size > size - pos)) {
+            index->flags |= AU_FLAG_MALFORMED;
+            return;
+        }
+        const uint8_t* payload = data + pos;
+        const size_t payload_end = pos + static_cast<size_t>(payload_size);
+
+        if (type == OBU_SEQUENCE_HEADER) {
+            index->flags |= AU_FLAG_HAS_SEQUENCE_HEADER;
+            BitReader reader(payload, static_cast<size_t>(payload_size));
+            uint32_t profile, still_picture, reduced;
+            if (reader.read(3, &profile) && reader.read(1, &still_picture) && reader.read(1, &reduced)) {
+                reduced_still_picture_header = reduced != 0;
+            }
+        } else if (type == OBU_FRAME_HEADER || type == OBU_FRAME) {
+            if (reduced_still_picture_header) {
+                index->flags |= AU_FLAG_KEYFRAME;
+            } else {
+                BitReader reader(payload, static_cast<size_t>(payload_size));
+                uint32_t show_existing_frame, frame_type;
+                if (reader.read(1, &show_existing_frame) && !show_existing_frame &&
+                    reader.read(2, &frame_type) && frame_type == 0) {
+                    index->flags |= AU_FLAG_KEYFRAME;
+                }
+            }
+        }
+        if ((type == OBU_FRAME_HEADER || type == OBU_TILE_GROUP || type == OBU_FRAME) &&
+            index->temporalId < 0) {
+            index->temporalId = temporal_id;
+        }
+        addUnit(index, obu_start, payload_end - obu_start, type, temporal_id);
+        pos = payload_end;
+    }
+}
+
+bool isVp8KeyFrame(const uint8_t* data, size_t size) {
+    // Bit 0 of the frame tag is 0 for key frames.
+    return size >= 3 && (data[0] & 0x01) == 0;
+}
+
+bool isVp9KeyFrame(const uint8_t* data, size_t size) {
+    BitReader reader(data, size);
+    uint32_t frame_marker, profile_low, profile_high, reserved, show_existing_frame, frame_type;
+    if (!reader.read(2, &frame_marker) || frame_marker != 2 ||
+        !reader.read(1, &profile_low) || !reader.read(1, &profile_high)) {
+        return false;
+    }
+    if (((profile_high << 1) | profile_low) == 3 && !reader.read(1, &reserved)) {
+        return false;
+    }
+    return reader.read(1, &show_existing_frame) && !show_existing_frame &&
+           reader.read(1, &frame_type) && frame_type == 0;
+}
+
+} // namespace
+
+bool readLeb128(const uint8_t* data, size_t size, size_t* pos, uint64_t* value) {
+    uint64_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+        if (*pos >= size) {
+            return false;
+        }
+        uint8_t byte = data[(*pos)++];
+        result |= static_cast<uint64_t>(byte & 0x7F) << (i * 7);
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void parseAccessUnit(VideoCodecType codec_type, const uint8_t* data, size_t size,
+                     AccessUnitIndex* out_index) {
+    out_index->flags = 0;
+    out_index->temporalId = -1;
+    out_index->nalCount = 0;
+    if (!data || size == 0) {
+        return;
+    }
+    switch (codec_type) {
+        case VIDEO_CODEC_H264:
+        case VIDEO_CODEC_H265:
+            parseAnnexB(codec_type, data, size, out_index);
+            break;
+        case VIDEO_CODEC_AV1:
+            parseAv1(data, size, out_index);
+            break;
+        case VIDEO_CODEC_VP8:
+            if (isVp8KeyFrame(data, size)) {
+                out_index->flags |= AU_FLAG_KEYFRAME;
+            }
+            break;
+        case VIDEO_CODEC_VP9:
+            if (isVp9KeyFrame(data, size)) {
+                out_index->flags |= AU_FLAG_KEYFRAME;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool isParameterSetUnit(VideoCodecType codec_type, uint8_t unit_type) {
+    switch (codec_type) {
+        case VIDEO_CODEC_H264:
+            return unit_type == 7 || unit_type == 8;
+        case VIDEO_CODEC_H265:
+            return unit_type >= 32 && unit_type <= 34;
+        case VIDEO_CODEC_AV1:
+            return unit_type == 1;
+        default:
+            return false;
+    }
+}
+
+bool isDelimiterUnit(VideoCodecType codec_type, uint8_t unit_type) {
+    switch (codec_type) {
+        case VIDEO_CODEC_H264:
+            return unit_type == 9;
+        case VIDEO_CODEC_H265:
+            return unit_type == 35;
+        case VIDEO_CODEC_AV1:
+            return unit_type == 2;
+        default:
+            return false;
+    }
+}
@@ -3,46 +3,56 @@
 #include <string.h>
 #include "native_buffer_api.h"
 
+namespace {
+
+struct JavaSamples {
+    JNIEnv* env;
+    jbyteArray array;
+};
+
+bool copyJavaSamples(uint8_t* dst, size_t size, void* context) {
+    JavaSamples* samples = static_cast<JavaSamples*>(context);
+    samples->env->GetByteArrayRegion(samples->array, 0, static_cast<jsize>(size),
+                                     reinterpret_cast<jbyte*>(dst));
+    return !samples->env->ExceptionCheck();
+}
+
+} // namespace
+
 extern "C" {
 
 JNIEXPORT jint JNICALL
-Java_org_webrtc_audio_AudioBufferUtil_initNativeBuffer(JNIEnv *env, jclass clazz, jstring jKey, jint capacity, jint bufferSize) {
+Java_org_webrtc_audio_AudioBufferUtil_initNativeBuffer(JNIEnv *env, jclass clazz, jstring jKey, jint capacity, jint bufferSize,
+                                                            jint mode, jint overflowPolicy) {
     const char* key = env->GetStringUTFChars(jKey, NULL);
     if (!key) {
         return 0;
     }
-    int result = initNativeBufferFFI(key, capacity, bufferSize);
+    int32_t handle = initNativeBufferFFI(key, capacity, bufferSize, mode, overflowPolicy);
     env->ReleaseStringUTFChars(jKey, key);
-    return static_cast<jint>(result);
+    return static_cast<jint>(handle);
 }
 
+// The samples are copied with GetByteArrayRegion straight into the ring
+// slot rather than pinned, so the push (which may take the buffer lock and
+// posts to Dart) never runs inside a JNI critical region that stalls the GC.
 JNIEXPORT jlong JNICALL
-Java_org_webrtc_audio_AudioBufferUtil_pushAudioData(JNIEnv *env, jclass clazz, jstring jKey,
+Java_org_webrtc_audio_AudioBufferUtil_pushAudioData(JNIEnv *env, jclass clazz, jint handle,
                                                              jbyteArray samples, jint sampleRate, jint channels, jlong frameTime) {
-    const char* key = env->GetStringUTFChars(jKey, NULL);
-    if (!key) {
-        return 0LL;
-    }
-    jbyte* byteArray = env->GetByteArrayElements(samples, NULL);
-    if (!byteArray) {
-        env->ReleaseStringUTFChars(jKey, key);
+    jsize size = env->GetArrayLength(samples);
+    if (size <= 0) {
         return 0LL;
     }
-    jsize size = env->GetArrayLength(samples);
-    int result = pushAudioNativeBufferFFI(key, reinterpret_cast<uint8_t*>(byteArray), static_cast<size_t>(size),
-                                             sampleRate, channels, static_cast<uint64_t>(frameTime));
-    env->ReleaseByteArrayElements(samples, byteArray, JNI_ABORT);
-    env->ReleaseStringUTFChars(jKey, key);
+    JavaSamples source{env, samples};
+    int result = pushAudioNativeBufferFilledByHandleFFI(handle, copyJavaSamples, &source,
+                                                        static_cast<size_t>(size), sampleRate, channels,
+                                                        static_cast<uint64_t>(frameTime));
     return static_cast<jlong>(result);
 }
 
 JNIEXPORT void JNICALL
-Java_org_webrtc_audio_AudioBufferUtil_freeNativeBuffer(JNIEnv *env, jclass clazz, jstring jKey) {
-    const char* key = env->GetStringUTFChars(jKey, NULL);
-    if (key) {
-        freeNativeBufferFFI(key);
-        env->ReleaseStringUTFChars(jKey, key);
-    }
+Java_org_webrtc_audio_AudioBufferUtil_freeNativeBuffer(JNIEnv *env, jclass clazz, jint handle) {
+    freeNativeBufferByHandleFFI(handle);
 }
 
 } // extern "C"
@@ -0,0 +1,548 @@
+#include "FragmentedMp4Writer.h"
+#include "AccessUnitParser.h"
+#include <cstring>
+
+namespace {
+
+const uint32_t kTrackId = 1;
+const uint32_t kSyncSampleFlags = 0x02000000;     // sample_depends_on = 2
+const uint32_t kNonSyncSampleFlags = 0x01010000;  // sample_depends_on = 1, is_non_sync
+
+// Big-endian box builder. beginBox returns the offset endBox patches the
+// size into, so nested boxes can be written in a single pass.
+class BoxWriter {
+public:
+    explicit BoxWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint32_t value) { out_.push_back(static_cast<uint8_t>(value)); }
+    void u16(uint32_t value) { u8(value >> 8); u8(value); }
+    void u32(uint32_t value) { u16(value >> 16); u16(value); }
+    void u64(uint64_t value) { u32(static_cast<uint32_t>(value >> 32)); u32(static_cast<uint32_t>(value)); }
+    void zeros(size_t count) { out_.insert(out_.end(), count, 0); }
+    void bytes(const uint8_t* data, size_t size) { out_.insert(out_.end(), data, data + size); }
+    void fourcc(const char* type) { bytes(reinterpret_cast<const uint8_t*>(type), 4); }
+
+    size_t beginBox(const char* type) {
+        size_t offset = out_.size();
+        u32(0);
+        fourcc(type);
+        return offset;
+    }
+    size_t beginFullBox(const char* type, uint8_t version, uint32_t flags) {
+        size_t offset = beginBox(type);
+        u32((static_cast<uint32_t>(version) << 24) | (flags & 0xFFFFFF));
+        return offset;
+    }
+    void endBox(size_t offset) { patch32(offset, static_cast<uint32_t>(out_.size() - offset)); }
+    void patch32(size_t offset, uint32_t value) {
+        out_[offset] = static_cast<uint8_t>(value >> 24);
+        out_[offset + 1] = static_cast<uint8_t>(value >> 16);
+        out_[offset + 2] = static_cast<uint8_t>(value >> 8);
+        out_[offset + 3] = static_cast<uint8_t>(value);
+    }
+    size_t size() const { return out_.size(); }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// Removes emulation prevention bytes (00 00 03) from a NAL unit.
+std::vector<uint8_t> unescapeRbsp(const uint8_t* data, size_t size) {
+    std::vector<uint8_t> rbsp;
+    rbsp.reserve(size);
+    int zeros = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (zeros >= 2 && data[i] == 3) {
+            zeros = 0;
+            continue;
+        }
+        rbsp.push_back(data[i]);
+        zeros = data[i] == 0 ? zeros + 1 : 0;
+    }
+    return rbsp;
+}
+
+const std::vector<uint8_t>* findUnit(VideoCodecType codec_type, uint8_t type,
+                                     const std::vector<std::vector<uint8_t>>& units) {
+    for (const std::vector<uint8_t>& unit : units) {
+        if (unit.empty()) {
+            continue;
+        }
+        uint8_t unit_type = codec_type == VIDEO_CODEC_H264 ? (unit[0] & 0x1F)
+                          : codec_type == VIDEO_CODEC_H265 ? ((unit[0] >> 1) & 0x3F)
+                          : ((unit[0] >> 3) & 0x0F);
+        if (unit_type == type) {
+            return &unit;
+        }
+    }
+    return nullptr;
+}
+
+void writeAvcC(BoxWriter& w, const std::vector<std::vector<uint8_t>>& units) {
+    const std::vector<uint8_t>* sps = findUnit(VIDEO_CODEC_H264, 7, units);
+    size_t box = w.beginBox("avcC");
+    w.u8(1);
+    w.u8(sps && sps->size() > 3 ? (*sps)[1] : 66);
+    w.u8(sps && sps->size() > 3 ? (*sps)[2] : 0);
+    w.u8(sps && sps->size() > 3 ? (*sps)[3] : 31);
+    w.u8(0xFC | 3);  // 4-byte NAL lengths
+    for (uint8_t type : {7, 8}) {
+        std::vector<const std::vector<uint8_t>*> matches;
+        for (const std::vector<uint8_t>& unit : units) {
+            if (!unit.empty() && (unit[0] & 0x1F) == type) {
+                matches.push_back(&unit);
+            }
+        }
+        w.u8(type == 7 ? (0xE0 | matches.size()) : matches.size());
+        for (const std::vector<uint8_t>* unit : matches) {
+            w.u16(static_cast<uint32_t>(unit->size()));
+            w.bytes(unit->data(), unit->size());
+        }
+    }
+    w.endBox(box);
+}
+
+void writeHvcC(BoxWriter& w, const std::vector<std::vector<uint8_t>>& units) {
+    // profile_tier_level starts right after the 2-byte NAL header and one
+    // byte of vps_id / max_sub_layers_minus1 / temporal_id_nesting_flag.
+    uint8_t ptl[12] = {0x01, 0x60, 0, 0, 0, 0, 0, 0, 0, 0, 0, 93};
+    uint8_t sub_layers_byte = 0x01;
+    const std::vector<uint8_t>* sps = findUnit(VIDEO_CODEC_H265, 33, units);
+    if (sps) {
+        std::vector<uint8_t> rbsp = unescapeRbsp(sps->data(), sps->size());
+        if (rbsp.size() >= 3 + sizeof(ptl)) {
+            sub_layers_byte = rbsp[2];
+            std::memcpy(ptl, rbsp.data() + 3, sizeof(ptl));
+        }
+    }
+    const uint32_t max_sub_layers = ((sub_layers_byte >> 1) & 0x07) + 1;
+    const uint32_t temporal_id_nested = sub_layers_byte & 0x01;
+
+    size_t box = w.beginBox("hvcC");
+    w.u8(1);
+    w.bytes(ptl, sizeof(ptl));
+    w.u16(0xF000);  // min_spatial_segmentation_idc = 0
+    w.u8(0xFC);     // parallelismType = 0
+    w.u8(0xFD);     // chroma_format_idc = 1 (4:2:0)
+    w.u8(0xF8);     // bit_depth_luma_minus8 = 0
+    w.u8(0xF8);     // bit_depth_chroma_minus8 = 0
+    w.u16(0);       // avgFrameRate
+    w.u8((max_sub_layers << 3) | (temporal_id_nested << 2) | 3);
+    std::vector<const std::vector<uint8_t>*> arrays[3];
+    for (const std::vector<uint8_t>& unit : units) {
+        uint8_t type = unit.empty() ? 0 : (unit[0] >> 1) & 0x3F;
+        if (type >= 32 && type <= 34) {
+            arrays[type - 32].push_back(&unit);
+        }
+    }
+    uint32_t array_count = 0;
+    for (const auto& array : arrays) {
+        array_count += array.empty() ? 0 : 1;
+    }
+    w.u8(array_count);
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (arrays[i].empty()) {
+            continue;
+        }
+        w.u8(32 + i);  // array_completeness = 0: more may arrive in band
+        w.u16(static_cast<uint32_t>(arrays[i].size()));
+        for (const std::vector<uint8_t>* unit : arrays[i]) {
+            w.u16(static_cast<uint32_t>(unit->size()));
+            w.bytes(unit->data(), unit->size());
+        }
+    }
+    w.endBox(box);
+}
+
+void writeAv1C(BoxWriter& w, const std::vector<std::vector<uint8_t>>& units) {
+    const std::vector<uint8_t>* sequence_header = findUnit(VIDEO_CODEC_AV1, 1, units);
+    uint32_t profile = 0, level = 31, tier = 0;
+    if (sequence_header && sequence_header->size() > 2) {
+        // Skip the OBU header, optional extension byte and size field.
+        const uint8_t* obu = sequence_header->data();
+        size_t pos = (obu[0] & 0x04) ? 2 : 1;
+        uint64_t payload_size = sequence_header->size() - pos;
+        if (!(obu[0] & 0x02) || readLeb128(obu, sequence_header->size(), &pos, &payload_size)) {
+            BitReader reader(obu + pos, sequence_header->size() - pos);
+            uint32_t still_picture, reduced, timing_info_present, display_delay_present, op_count, idc;
+            if (reader.read(3, &profile) && reader.read(1, &still_picture) && reader.read(1, &reduced)) {
+                if (reduced) {
+                    reader.read(5, &level);
+                } else if (reader.read(1, &timing_info_present) && !timing_info_present &&
+                           reader.read(1, &display_delay_present) && reader.read(5, &op_count) &&
+                           reader.read(12, &idc) && reader.read(5, &level) && level > 7) {
+                    // Without timing info the first operating point's level
+                    // and tier follow directly.
+                    reader.read(1, &tier);
+                }
+            }
+        }
+    }
+    size_t box = w.beginBox("av1C");
+    w.u8(0x81);  // marker, version 1
+    w.u8((profile << 5) | (level & 0x1F));
+    w.u8((tier << 7) | 0x0C);  // 8-bit 4:2:0, chroma_sample_position unknown
+    w.u8(0);
+    if (sequence_header) {
+        w.bytes(sequence_header->data(), sequence_header->size());
+    }
+    w.endBox(box);
+}
+
+void writeMatrix(BoxWriter& w, int rotation) {
+    int32_t a = 0x10000, b = 0, c = 0, d = 0x10000;
+    switch (((rotation % 360) + 360) % 360) {
+        case 90: a = 0; b = 0x10000; c = -0x10000; d = 0; break;
+        case 180: a = -0x10000; d = -0x10000; break;
+        case 270: a = 0; b = -0x10000; c = 0x10000; d = 0; break;
+        default: break;
+    }
+    w.u32(a); w.u32(b); w.u32(0);
+    w.u32(c); w.u32(d); w.u32(0);
+    w.u32(0); w.u32(0); w.u32(0x40000000);
+}
+
+// Appends an Annex-B frame as 4-byte length-prefixed NAL units, leaving out
+// access unit delimiters.
+void appendLengthPrefixed(VideoCodecType codec_type, const uint8_t* data, size_t size,
+                          std::vector<uint8_t>& out) {
+    size_t i = 0;
+    size_t nal_start = size;
+    auto emit = [&](size_t end) {
+        while (end > nal_start && data[end - 1] == 0) {
+            --end;
+        }
+        if (end <= nal_start) {
+            return;
+        }
+        uint8_t type = codec_type == VIDEO_CODEC_H265 ? (data[nal_start] >> 1) & 0x3F : data[nal_start] & 0x1F;
+        if (isDelimiterUnit(codec_type, type)) {
+            return;
+        }
+        uint32_t length = static_cast<uint32_t>(end - nal_start);
+        uint8_t prefix[4] = {static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16),
+                             static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+        out.insert(out.end(), prefix, prefix + 4);
+        out.insert(out.end(), data + nal_start, data + end);
+    };
+    while (i + 3 <= size) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            if (nal_start < size) {
+                emit(i);
+            }
+            i += 3;
+            nal_start = i;
+        } else {
+            ++i;
+        }
+    }
+    if (nal_start < size) {
+        emit(size);
+    }
+}
+
+// Appends an AV1 temporal unit without its temporal delimiters. The last OBU
+// may omit its size field; MP4 requires one, so it is added back.
+bool appendObus(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    size_t pos = 0;
+    while (pos < size) {
+        const uint8_t header = data[pos];
+        const size_t header_size = (header & 0x04) ? 2 : 1;
+        if (pos + header_size > size) {
+            return false;
+        }
+        size_t payload_pos = pos + header_size;
+        uint64_t payload_size = size - payload_pos;
+        if ((header & 0x02) &&
+            (!readLeb128(data, size, &payload_pos, &payload_size) || payload_size > size - payload_pos)) {
+            return false;
+        }
+        const size_t end = payload_pos + static_cast<size_t>(payload_size);
+        if (((header >> 3) & 0x0F) != 2) {
+            if (header & 0x02) {
+                out.insert(out.end(), data + pos, data + end);
+            } else {
+                out.push_back(header | 0x02);
+                out.insert(out.end(), data + pos + 1, data + pos + header_size);
+                uint64_t remaining = payload_size;
+                do {
+                    uint8_t byte = remaining & 0x7F;
+                    remaining >>= 7;
+                    out.push_back(remaining ? (byte | 0x80) : byte);
+                } while (remaining);
+                out.insert(out.end(), data + payload_pos, data + end);
+            }
+        }
+        pos = end;
+    }
+    return true;
+}
+
+} // namespace
+
+FragmentedMp4Writer::FragmentedMp4Writer() :
+    file_(nullptr),
+    codec_type_(VIDEO_CODEC_UNKNOWN),
+    failed_(false),
+    sequence_number_(0),
+    decode_time_(0),
+    pending_duration_(0)
+{
+}
+
+FragmentedMp4Writer::~FragmentedMp4Writer() {
+    close();
+}
+
+bool FragmentedMp4Writer::supportsCodec(VideoCodecType codec_type) {
+    return codec_type == VIDEO_CODEC_H264 || codec_type == VIDEO_CODEC_H265 ||
+           codec_type == VIDEO_CODEC_AV1;
+}
+
+bool FragmentedMp4Writer::open(const std::string& path, VideoCodecType codec_type, int width, int height,
+                               int rotation, const std::vector<std::vector<uint8_t>>& parameter_sets) {
+    close();
+    if (!supportsCodec(codec_type)) {
+        return false;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    codec_type_ = codec_type;
+    failed_ = false;
+    sequence_number_ = 0;
+    decode_time_ = 0;
+    pending_duration_ = 0;
+    samples_.clear();
+    mdat_.clear();
+    if (!writeInitSegment(width, height, rotation, parameter_sets)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool FragmentedMp4Writer::appendSample(const uint8_t* data, size_t size, bool sync) {
+    if (!file_ || failed_) {
+        return false;
+    }
+    const size_t before = mdat_.size();
+    if (codec_type_ == VIDEO_CODEC_AV1) {
+        if (!appendObus(data, size, mdat_)) {
+            mdat_.resize(before);
+            return false;
+        }
+    } else {
+        appendLengthPrefixed(codec_type_, data, size, mdat_);
+    }
+    if (mdat_.size() == before) {
+        return false;
+    }
+    samples_.push_back(Sample{static_cast<uint32_t>(mdat_.size() - before), 0, sync});
+    return true;
+}
+
+void FragmentedMp4Writer::setLastSampleDuration(uint32_t duration) {
+    if (samples_.empty()) {
+        return;
+    }
+    pending_duration_ += duration;
+    pending_duration_ -= samples_.back().duration;
+    samples_.back().duration = duration;
+}
+
+bool FragmentedMp4Writer::flushFragment() {
+    if (!file_ || failed_) {
+        return false;
+    }
+    if (samples_.empty()) {
+        return true;
+    }
+    scratch_.clear();
+    BoxWriter w(scratch_);
+    size_t moof = w.beginBox("moof");
+    size_t mfhd = w.beginFullBox("mfhd", 0, 0);
+    w.u32(++sequence_number_);
+    w.endBox(mfhd);
+    size_t traf = w.beginBox("traf");
+    size_t tfhd = w.beginFullBox("tfhd", 0, 0x020000);  // default-base-is-moof
+    w.u32(kTrackId);
+    w.endBox(tfhd);
+    size_t tfdt = w.beginFullBox("tfdt", 1, 0);
+    w.u64(decode_time_);
+    w.endBox(tfdt);
+    // data-offset, sample-duration, sample-size and sample-flags present.
+    size_t trun = w.beginFullBox("trun", 0, 0x000001 | 0x000100 | 0x000200 | 0x000400);
+    w.u32(static_cast<uint32_t>(samples_.size()));
+    size_t data_offset = w.size();
+    w.u32(0);
+    for (const Sample& sample : samples_) {
+        w.u32(sample.duration);
+        w.u32(sample.size);
+        w.u32(sample.sync ? kSyncSampleFlags : kNonSyncSampleFlags);
+        decode_time_ += sample.duration;
+    }
+    w.endBox(trun);
+    w.endBox(traf);
+    w.endBox(moof);
+    w.patch32(data_offset, static_cast<uint32_t>(w.size() - moof + 8));
+    w.u32(static_cast<uint32_t>(mdat_.size() + 8));
+    w.fourcc("mdat");
+
+    bool ok = write(scratch_) && write(mdat_) && std::fflush(file_) == 0;
+    failed_ = failed_ || !ok;
+    samples_.clear();
+    mdat_.clear();
+    pending_duration_ = 0;
+    return ok;
+}
+
+bool FragmentedMp4Writer::close() {
+    if (!file_) {
+        return !failed_;
+    }
+    flushFragment();
+    if (std::fclose(file_) != 0) {
+        failed_ = true;
+    }
+    file_ = nullptr;
+    samples_.clear();
+    mdat_.clear();
+    return !failed_;
+}
+
+bool FragmentedMp4Writer::write(const std::vector<uint8_t>& bytes) {
+    return bytes.empty() || std::fwrite(bytes.data(), 1, bytes.size(), file_) == bytes.size();
+}
+
+bool FragmentedMp4Writer::writeInitSegment(int width, int height, int rotation,
+                                           const std::vector<std::vector<uint8_t>>& parameter_sets) {
+    scratch_.clear();
+    BoxWriter w(scratch_);
+
+    size_t ftyp = w.beginBox("ftyp");
+    w.fourcc("iso6");
+    w.u32(0);
+    w.fourcc("iso6");
+    w.fourcc("iso5");
+    w.fourcc("mp41");
+    if (codec_type_ == VIDEO_CODEC_AV1) {
+        w.fourcc("av01");
+    }
+    w.endBox(ftyp);
+
+    size_t moov = w.beginBox("moov");
+    size_t mvhd = w.beginFullBox("mvhd", 0, 0);
+    w.u32(0);  // creation_time
+    w.u32(0);  // modification_time
+    w.u32(kTimescale);
+    w.u32(0);  // duration, carried by the fragments
+    w.u32(0x00010000);  // rate
+    w.u16(0x0100);      // volume
+    w.zeros(10);
+    writeMatrix(w, 0);
+    w.zeros(24);
+    w.u32(kTrackId + 1);
+    w.endBox(mvhd);
+
+    size_t trak = w.beginBox("trak");
+    size_t tkhd = w.beginFullBox("tkhd", 0, 0x000003);  // enabled, in movie
+    w.u32(0);
+    w.u32(0);
+    w.u32(kTrackId);
+    w.u32(0);
+    w.u32(0);  // duration
+    w.zeros(8);
+    w.u16(0);  // layer
+    w.u16(0);  // alternate_group
+    w.u16(0);  // volume
+    w.u16(0);
+    writeMatrix(w, rotation);
+    w.u32(static_cast<uint32_t>(width) << 16);
+    w.u32(static_cast<uint32_t>(height) << 16);
+    w.endBox(tkhd);
+
+    size_t mdia = w.beginBox("mdia");
+    size_t mdhd = w.beginFullBox("mdhd", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.u32(kTimescale);
+    w.u32(0);
+    w.u16(0x55C4);  // "und"
+    w.u16(0);
+    w.endBox(mdhd);
+    size_t hdlr = w.beginFullBox("hdlr", 0, 0);
+    w.u32(0);
+    w.fourcc("vide");
+    w.zeros(12);
+    static const char kHandlerName[] = "VideoHandler";
+    w.bytes(reinterpret_cast<const uint8_t*>(kHandlerName), sizeof(kHandlerName));
+    w.endBox(hdlr);
+
+    size_t minf = w.beginBox("minf");
+    size_t vmhd = w.beginFullBox("vmhd", 0, 1);
+    w.zeros(8);
+    w.endBox(vmhd);
+    size_t dinf = w.beginBox("dinf");
+    size_t dref = w.beginFullBox("dref", 0, 0);
+    w.u32(1);
+    size_t url = w.beginFullBox("url ", 0, 1);  // media is in this file
+    w.endBox(url);
+    w.endBox(dref);
+    w.endBox(dinf);
+
+    size_t stbl = w.beginBox("stbl");
+    size_t stsd = w.beginFullBox("stsd", 0, 0);
+    w.u32(1);
+    size_t entry = w.beginBox(codec_type_ == VIDEO_CODEC_H264 ? "avc3"
+                            : codec_type_ == VIDEO_CODEC_H265 ? "hev1" : "av01");
+    w.zeros(6);
+    w.u16(1);  // data_reference_index
+    w.zeros(16);
+    w.u16(static_cast<uint32_t>(width));
+    w.u16(static_cast<uint32_t>(height));
+    w.u32(0x00480000);  // 72 dpi
+    w.u32(0x00480000);
+    w.u32(0);
+    w.u16(1);  // frame_count
+    w.zeros(32);  // compressorname
+    w.u16(0x0018);
+    w.u16(0xFFFF);
+    if (codec_type_ == VIDEO_CODEC_H264) {
+        writeAvcC(w, parameter_sets);
+    } else if (codec_type_ == VIDEO_CODEC_H265) {
+        writeHvcC(w, parameter_sets);
+    } else {
+        writeAv1C(w, parameter_sets);
+    }
+    w.endBox(entry);
+    w.endBox(stsd);
+    for (const char* type : {"stts", "stsc", "stco"}) {
+        size_t empty_table = w.beginFullBox(type, 0, 0);
+        w.u32(0);
+        w.endBox(empty_table);
+    }
+    size_t stsz = w.beginFullBox("stsz", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.endBox(stsz);
+    w.endBox(stbl);
+    w.endBox(minf);
+    w.endBox(mdia);
+    w.endBox(trak);
+
+    size_t mvex = w.beginBox("mvex");
+    size_t trex = w.beginFullBox("trex", 0, 0);
+    w.u32(kTrackId);
+    w.u32(1);  // default_sample_description_index
+    w.u32(0);
+    w.u32(0);
+    w.u32(0);
+    w.endBox(trex);
+    w.endBox(mvex);
+    w.endBox(moov);
+
+    failed_ = !write(scratch_) || std::fflush(file_) != 0;
+    return !failed_;
+}
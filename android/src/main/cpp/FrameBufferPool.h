@@ -0,0 +1,66 @@
+#ifndef FRAME_BUFFER_POOL_H
+#define FRAME_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Process-wide cache of MediaFrame payload blocks, shared by every
+// NativeBuffer. Requests are rounded up to a power-of-two size class so
+// blocks freed by one track can be reused by another. A class keeps only
+// the blocks it actually needed during the last trim interval; whatever sat
+// unused for a whole interval is returned to the system. Once no block is in
+// use at all, meaning every stream has stopped, the whole cache is.
+class FrameBufferPool {
+public:
+    static FrameBufferPool& shared();
+
+    // Returns a block of at least size bytes and stores its real capacity in
+    // out_capacity, or nullptr if the allocation fails.
+    uint8_t* allocate(size_t size, size_t* out_capacity);
+    // Returns a block obtained from allocate; capacity must be the value
+    // allocate reported. nullptr is ignored.
+    void release(uint8_t* block, size_t capacity);
+    // Frees every cached block immediately.
+    void trim();
+
+    // Capacity allocate would hand out for a request of size bytes.
+    static size_t capacityFor(size_t size);
+    // True when a block of capacity bytes is at least two size classes larger
+    // than a request of size bytes needs, so swapping it for a smaller block
+    // gives memory back.
+    static bool isOversized(size_t capacity, size_t size);
+
+private:
+    FrameBufferPool();
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    static const int kMinClassShift = 10;   // 1 KB
+    static const int kMaxClassShift = 26;   // 64 MB; larger blocks are not cached
+    static const int kNumClasses = kMaxClassShift - kMinClassShift + 1;
+    static const int64_t kTrimIntervalMs = 2000;
+    static const size_t kMaxCachedBytes = 64u * 1024u * 1024u;
+
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<uint8_t*> free_blocks;
+        // Fewest free blocks seen since the last trim; that many were idle
+        // for the whole interval.
+        size_t low_water = 0;
+    };
+
+    static int classIndex(size_t capacity);
+    void maybeTrimIdle();
+    void trimClass(SizeClass& size_class, size_t block_size, bool idle_only);
+
+    SizeClass classes_[kNumClasses];
+    std::atomic<size_t> cached_bytes_;
+    // Blocks handed out by allocate and not yet released.
+    std::atomic<size_t> blocks_in_use_;
+    std::atomic<int64_t> last_trim_ms_;
+};
+
+#endif // FRAME_BUFFER_POOL_H
@@ -6,49 +6,39 @@
 extern "C" {
 
 JNIEXPORT jint JNICALL
-Java_org_webrtc_video_VideoDecoderBypass_initNativeBuffer(JNIEnv *env, jclass clazz, jstring jTrackId, jint capacity, jint bufferSize) {
+Java_org_webrtc_video_VideoDecoderBypass_initNativeBuffer(JNIEnv *env, jclass clazz, jstring jTrackId, jint capacity, jint bufferSize,
+                                                            jint mode, jint overflowPolicy) {
     const char* key = env->GetStringUTFChars(jTrackId, NULL);
     if (!key) {
         return 0;
     }
-    int result = initNativeBufferFFI(key, capacity, bufferSize);
+    int32_t handle = initNativeBufferFFI(key, capacity, bufferSize, mode, overflowPolicy);
     env->ReleaseStringUTFChars(jTrackId, key);
-    return static_cast<jint>(result);
+    return static_cast<jint>(handle);
 }
 
 JNIEXPORT jlong JNICALL
-Java_org_webrtc_video_VideoDecoderBypass_pushFrame(JNIEnv *env, jclass clazz, jstring jTrackId, jobject buffer,
+Java_org_webrtc_video_VideoDecoderBypass_pushFrame(JNIEnv *env, jclass clazz, jint handle, jobject buffer,
                                                       jint width, jint height, jlong frameTime,
                                                       jint rotation, jint frameType, jint codecType) {
-    const char* key = env->GetStringUTFChars(jTrackId, NULL);
-    if (!key) {
-        return 0LL;
-    }
     uint8_t* buf = reinterpret_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
     if (!buf) {
-         env->ReleaseStringUTFChars(jTrackId, key);
          return 0LL;
     }
     jlong capacity = env->GetDirectBufferCapacity(buffer);
     if (capacity <= 0) {
-        env->ReleaseStringUTFChars(jTrackId, key);
         return 0LL;
     }
     size_t dataSize = static_cast<size_t>(capacity);
-    int ffi_result = pushVideoNativeBufferFFI(key, buf, dataSize,
-                                             width, height, static_cast<uint64_t>(frameTime),
-                                             rotation, frameType, static_cast<int>(codecType));
-    env->ReleaseStringUTFChars(jTrackId, key);
+    int ffi_result = pushVideoNativeBufferByHandleFFI(handle, buf, dataSize,
+                                                      width, height, static_cast<uint64_t>(frameTime),
+                                                      rotation, frameType, static_cast<int>(codecType));
     return static_cast<jlong>(ffi_result);
 }
 
 JNIEXPORT void JNICALL
-Java_org_webrtc_video_VideoDecoderBypass_freeNativeBuffer(JNIEnv *env, jclass clazz, jstring jTrackId) {
-    const char* key = env->GetStringUTFChars(jTrackId, NULL);
-    if (key) {
-        freeNativeBufferFFI(key);
-        env->ReleaseStringUTFChars(jTrackId, key);
-    }
+Java_org_webrtc_video_VideoDecoderBypass_freeNativeBuffer(JNIEnv *env, jclass clazz, jint handle) {
+    freeNativeBufferByHandleFFI(handle);
 }
 
 } // extern "C"
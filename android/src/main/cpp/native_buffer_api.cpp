@@ -1,136 +1,534 @@
 #include "native_buffer_api.h"
 #include "dart_api_dl.h"
 #include "NativeBuffer.h"
+#include "NativeRecorder.h"
 #include <string>
 #include <unordered_map>
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <algorithm>
+#include <vector>
 
-static std::unordered_map<std::string, std::unique_ptr<NativeBuffer>> g_nativeBuffers;
-static std::mutex g_nativeBuffersMutex;
+// A handle packs a slot index into its low bits and the slot's generation
+// above it. The generation is bumped whenever a slot is freed, so a stale
+// handle never resolves to a buffer registered later in the same slot.
+static const uint32_t kSlotIndexBits = 8;
+static const uint32_t kMaxNativeBuffers = 1u << kSlotIndexBits;
+static const uint32_t kSlotIndexMask = kMaxNativeBuffers - 1;
+static const uint32_t kGenerationMask = 0x7fffffffu >> kSlotIndexBits;
 
-static std::unordered_map<std::string, int64_t> g_dartPorts;
-static std::mutex g_portsMutex;
+struct NativeBufferSlot {
+    // Taken only to register and free a buffer. Pushes and pops resolve
+    // their handle without it (see resolveHandle).
+    std::mutex mutex;
+    // Guarded by mutex. Owns the registered buffer, and buffers freed while
+    // a call was still using them until that call has returned.
+    std::shared_ptr<NativeBuffer> buffer;
+    std::vector<std::shared_ptr<NativeBuffer>> retired;
+    // Set while retired is not empty, so the last call out of the slot
+    // knows to reclaim it.
+    std::atomic<bool> has_retired{false};
+    // Written under mutex, read lock-free by resolveHandle.
+    std::atomic<NativeBuffer*> raw_buffer{nullptr};
+    std::atomic<uint32_t> generation{0};
+    // Calls between resolveHandle and the end of their use of raw_buffer.
+    std::atomic<uint32_t> active_calls{0};
+    // Guarded by g_registryMutex.
+    std::string key;
+
+    std::atomic<int64_t> port{0};
+    std::atomic<int> notify_mode{NOTIFY_MODE_PER_FRAME};
+    // Set once a coalesced wakeup is in flight; cleared by popBatch.
+    std::atomic<bool> wakeup_pending{false};
+};
+
+static void endCall(NativeBufferSlot& slot);
+
+// A buffer resolved from a handle. Holding it keeps the slot's buffer from
+// being reclaimed, so keep it only for the duration of one call.
+class BufferRef {
+public:
+    BufferRef() = default;
+    BufferRef(NativeBufferSlot* slot, NativeBuffer* buffer) : slot_(slot), buffer_(buffer) {}
+    BufferRef(BufferRef&& other) noexcept : slot_(other.slot_), buffer_(other.buffer_) {
+        other.slot_ = nullptr;
+        other.buffer_ = nullptr;
+    }
+    BufferRef(const BufferRef&) = delete;
+    BufferRef& operator=(const BufferRef&) = delete;
+    BufferRef& operator=(BufferRef&&) = delete;
+    ~BufferRef() {
+        if (slot_) {
+            endCall(*slot_);
+        }
+    }
+
+    explicit operator bool() const { return buffer_ != nullptr; }
+    NativeBuffer* operator->() const { return buffer_; }
+
+private:
+    NativeBufferSlot* slot_ = nullptr;
+    NativeBuffer* buffer_ = nullptr;
+};
+
+struct DartPortRegistration {
+    int64_t port;
+    NotifyMode notify_mode;
+};
+
+static NativeBufferSlot g_slots[kMaxNativeBuffers];
+
+// Guards the key-based tables below. Only registration, lookup and the
+// key-based entry points take it.
+static std::mutex g_registryMutex;
+static std::unordered_map<std::string, int32_t> g_handlesByKey;
+static std::unordered_map<std::string, DartPortRegistration> g_dartPorts;
+// Recorders outlive the buffer for their key, so a buffer recreated by the
+// decoder is attached to the running recording again.
+static std::unordered_map<std::string, std::shared_ptr<NativeRecorder>> g_recorders;
 
 static std::atomic<bool> g_dartApiInitialized{false};
 
-static void notifyDartFrameReady(const std::string& key) {
+static int32_t makeHandle(uint32_t index, uint32_t generation) {
+    return static_cast<int32_t>((generation << kSlotIndexBits) | index);
+}
+
+static NativeBufferSlot* slotForHandle(int32_t handle) {
+    if (handle <= 0) {
+        return nullptr;
+    }
+    return &g_slots[static_cast<uint32_t>(handle) & kSlotIndexMask];
+}
+
+// Lock-free: announces the call in active_calls, then reads the buffer and
+// checks that the handle's generation is still current. freeNativeBuffer
+// retires the generation before it looks at active_calls, so either this
+// sees the new generation and backs out, or the free sees this call and
+// defers reclaiming the buffer.
+static BufferRef resolveHandle(int32_t handle, NativeBufferSlot** out_slot = nullptr) {
+    NativeBufferSlot* slot = slotForHandle(handle);
+    if (!slot) {
+        return BufferRef();
+    }
+    slot->active_calls.fetch_add(1, std::memory_order_seq_cst);
+    NativeBuffer* buffer = slot->raw_buffer.load(std::memory_order_seq_cst);
+    if (!buffer ||
+        slot->generation.load(std::memory_order_seq_cst) != (static_cast<uint32_t>(handle) >> kSlotIndexBits)) {
+        endCall(*slot);
+        return BufferRef();
+    }
+    if (out_slot) {
+        *out_slot = slot;
+    }
+    return BufferRef(slot, buffer);
+}
+
+// Moves out the retired buffers of slot that no call can still be using.
+// Callers hold slot.mutex and destroy the result after dropping it.
+static std::vector<std::shared_ptr<NativeBuffer>> takeReclaimable(NativeBufferSlot& slot) {
+    std::vector<std::shared_ptr<NativeBuffer>> reclaimable;
+    if (slot.active_calls.load(std::memory_order_seq_cst) == 0) {
+        reclaimable.swap(slot.retired);
+        slot.has_retired.store(false, std::memory_order_seq_cst);
+    }
+    return reclaimable;
+}
+
+// Ends a call announced by resolveHandle. A free that found calls in flight
+// left its buffer in retired, so the last call out reclaims it. Either the
+// free sees no calls, or the call sees has_retired: both are seq_cst.
+static void endCall(NativeBufferSlot& slot) {
+    if (slot.active_calls.fetch_sub(1, std::memory_order_seq_cst) != 1 ||
+        !slot.has_retired.load(std::memory_order_seq_cst)) {
+        return;
+    }
+    std::vector<std::shared_ptr<NativeBuffer>> reclaimed;
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    reclaimed = takeReclaimable(slot);
+    // A call that started meanwhile leaves the buffers for its own exit.
+}
+
+static int32_t lookupHandle(const char* key) {
+    std::string skey(key);
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_handlesByKey.find(skey);
+    return it == g_handlesByKey.end() ? 0 : it->second;
+}
+
+static void applyPortRegistration(NativeBufferSlot& slot, const DartPortRegistration& registration) {
+    slot.notify_mode.store(registration.notify_mode, std::memory_order_relaxed);
+    slot.wakeup_pending.store(false, std::memory_order_relaxed);
+    slot.port.store(registration.port, std::memory_order_release);
+}
+
+static void notifyDartFrameReady(NativeBufferSlot& slot) {
     if (!g_dartApiInitialized.load(std::memory_order_acquire)) {
         return;
     }
-    int64_t port_id = 0;
-    {
-        std::lock_guard<std::mutex> lock(g_portsMutex);
-        auto port_it = g_dartPorts.find(key);
-        if (port_it != g_dartPorts.end()) {
-            port_id = port_it->second;
-        }
+    int64_t port_id = slot.port.load(std::memory_order_acquire);
+    if (port_id <= 0) {
+        return;
     }
-    if (port_id > 0) {
-        Dart_CObject message;
-        message.type = Dart_CObject_kInt64;
-        message.value.as_int64 = 1;
-        Dart_PostCObject_DL(port_id, &message);
+    if (slot.notify_mode.load(std::memory_order_relaxed) == NOTIFY_MODE_COALESCED &&
+        slot.wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+        return;
     }
+    Dart_CObject message;
+    message.type = Dart_CObject_kInt64;
+    message.value.as_int64 = 1;
+    Dart_PostCObject_DL(port_id, &message);
 }
 
-static int handlePushResult(int internal_push_result, const std::string& key) {
-    if (internal_push_result == 0) {
-        notifyDartFrameReady(key);
+static int handlePushResult(int internal_push_result, NativeBufferSlot& slot) {
+    if (internal_push_result == PUSH_RESULT_OK) {
+        notifyDartFrameReady(slot);
+        return 1;
+    } else if (internal_push_result == PUSH_RESULT_DROPPED) {
         return 1;
     } else {
         return 0;
     }
 }
 
-FFI_PLUGIN_EXPORT int initNativeBufferFFI(const char* key, int capacity, int maxBufferSize) {
+FFI_PLUGIN_EXPORT int32_t initNativeBufferFFI(const char* key, int capacity, int maxBufferSize,
+    int mode, int overflowPolicy) {
     if (!key || capacity <= 0 || maxBufferSize <= 0) {
          return 0;
     }
     std::string skey(key);
-    std::lock_guard<std::mutex> lock(g_nativeBuffersMutex);
-    if (g_nativeBuffers.find(skey) == g_nativeBuffers.end()) {
+    // Destroyed after the locks below are released.
+    std::vector<std::shared_ptr<NativeBuffer>> reclaimed;
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto existing = g_handlesByKey.find(skey);
+    if (existing != g_handlesByKey.end()) {
+        return existing->second;
+    }
+    for (uint32_t index = 0; index < kMaxNativeBuffers; ++index) {
+        NativeBufferSlot& slot = g_slots[index];
+        std::lock_guard<std::mutex> slot_lock(slot.mutex);
+        if (slot.buffer) {
+            continue;
+        }
+        reclaimed = takeReclaimable(slot);
         try {
-            g_nativeBuffers[skey] = std::make_unique<NativeBuffer>(capacity, maxBufferSize);
+            slot.buffer = std::make_shared<NativeBuffer>(capacity, maxBufferSize,
+                static_cast<BufferMode>(mode), static_cast<OverflowPolicy>(overflowPolicy));
         } catch (const std::exception& e) {
             return 0;
         }
+        uint32_t generation = (slot.generation.load(std::memory_order_relaxed) + 1) & kGenerationMask;
+        if (generation == 0) {
+            generation = 1;
+        }
+        // Publish the buffer before the generation that makes it reachable.
+        slot.raw_buffer.store(slot.buffer.get(), std::memory_order_seq_cst);
+        slot.generation.store(generation, std::memory_order_seq_cst);
+        slot.key = skey;
+        auto recorder_it = g_recorders.find(skey);
+        if (recorder_it != g_recorders.end()) {
+            slot.buffer->setFrameSink(recorder_it->second);
+        }
+        auto port_it = g_dartPorts.find(skey);
+        applyPortRegistration(slot, port_it != g_dartPorts.end()
+                                        ? port_it->second
+                                        : DartPortRegistration{0, NOTIFY_MODE_PER_FRAME});
+        int32_t handle = makeHandle(index, generation);
+        g_handlesByKey[skey] = handle;
+        return handle;
     }
-    return 1;
+    return 0;
 }
 
-FFI_PLUGIN_EXPORT int pushVideoNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
+FFI_PLUGIN_EXPORT int32_t lookupNativeBufferFFI(const char* key) {
+    if (!key) {
+        return 0;
+    }
+    return lookupHandle(key);
+}
+
+FFI_PLUGIN_EXPORT int pushVideoNativeBufferByHandleFFI(int32_t handle, const uint8_t* buffer, size_t dataSize,
     int width, int height, uint64_t frameTime, int rotation, int frameType, int codecType) {
-    if (!key || !buffer || dataSize == 0) {
+    if (!buffer || dataSize == 0) {
         return 0;
     }
-    std::string skey(key);
-    NativeBuffer* buffer_ptr = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_nativeBuffersMutex);
-        auto it = g_nativeBuffers.find(skey);
-        if (it == g_nativeBuffers.end()) {
-            return 0;
-        }
-        buffer_ptr = it->second.get();
+    NativeBufferSlot* slot = nullptr;
+    BufferRef buffer_ptr = resolveHandle(handle, &slot);
+    if (!buffer_ptr) {
+        return 0;
     }
     int result = buffer_ptr->pushVideoFrame(buffer, dataSize, width, height, frameTime,
                                             rotation, frameType, static_cast<VideoCodecType>(codecType));
-    return handlePushResult(result, skey);
+    return handlePushResult(result, *slot);
 }
 
-FFI_PLUGIN_EXPORT int pushAudioNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
-  int sampleRate, int channels, uint64_t frameTime) {
-     if (!key || !buffer || dataSize == 0) {
+FFI_PLUGIN_EXPORT int pushAudioNativeBufferByHandleFFI(int32_t handle, const uint8_t* buffer, size_t dataSize,
+    int sampleRate, int channels, uint64_t frameTime) {
+    if (!buffer || dataSize == 0) {
         return 0;
-     }
-    std::string skey(key);
-    NativeBuffer* buffer_ptr = nullptr;
+    }
+    NativeBufferSlot* slot = nullptr;
+    BufferRef buffer_ptr = resolveHandle(handle, &slot);
+    if (!buffer_ptr) {
+        return 0;
+    }
+    int result = buffer_ptr->pushAudioFrame(buffer, dataSize, sampleRate, channels, frameTime);
+    return handlePushResult(result, *slot);
+}
+
+FFI_PLUGIN_EXPORT int pushAudioNativeBufferFilledByHandleFFI(int32_t handle, NativeBufferFill fill, void* context,
+    size_t dataSize, int sampleRate, int channels, uint64_t frameTime) {
+    if (!fill || dataSize == 0) {
+        return 0;
+    }
+    NativeBufferSlot* slot = nullptr;
+    BufferRef buffer_ptr = resolveHandle(handle, &slot);
+    if (!buffer_ptr) {
+        return 0;
+    }
+    int result = buffer_ptr->pushAudioFrameFilled(fill, context, dataSize, sampleRate, channels, frameTime);
+    return handlePushResult(result, *slot);
+}
+
+FFI_PLUGIN_EXPORT uintptr_t popNativeBufferByHandleFFI(int32_t handle) {
+    BufferRef buffer_ptr = resolveHandle(handle);
+    if (!buffer_ptr) {
+        return 0;
+    }
+    MediaFrame* frame = buffer_ptr->popFrame();
+    return reinterpret_cast<uintptr_t>(frame);
+}
+
+FFI_PLUGIN_EXPORT uintptr_t acquireNativeBufferByHandleFFI(int32_t handle) {
+    BufferRef buffer_ptr = resolveHandle(handle);
+    if (!buffer_ptr) {
+        return 0;
+    }
+    MediaFrame* frame = buffer_ptr->acquireFrame();
+    return reinterpret_cast<uintptr_t>(frame);
+}
+
+FFI_PLUGIN_EXPORT uintptr_t acquirePrimingFrameByHandleFFI(int32_t handle) {
+    BufferRef buffer_ptr = resolveHandle(handle);
+    if (!buffer_ptr) {
+        return 0;
+    }
+    return reinterpret_cast<uintptr_t>(buffer_ptr->acquirePrimingFrame());
+}
+
+FFI_PLUGIN_EXPORT void releaseNativeBufferFrameFFI(void* frame) {
+    NativeBuffer::releaseFrame(static_cast<MediaFrame*>(frame));
+}
+
+FFI_PLUGIN_EXPORT int popBatchNativeBufferByHandleFFI(int32_t handle, uintptr_t* outFrames, int maxFrames) {
+    if (!outFrames || maxFrames <= 0) {
+        return 0;
+    }
+    NativeBufferSlot* slot = nullptr;
+    BufferRef buffer_ptr = resolveHandle(handle, &slot);
+    if (!buffer_ptr) {
+        return -1;
+    }
+    // Re-arm before draining so a frame pushed mid-drain posts a new wakeup.
+    slot->wakeup_pending.store(false, std::memory_order_release);
+
+    const size_t max_frames = static_cast<size_t>(maxFrames);
+    size_t total = 0;
+    MediaFrame* chunk[32];
+    while (total < max_frames) {
+        size_t wanted = std::min(max_frames - total, sizeof(chunk) / sizeof(chunk[0]));
+        size_t acquired = buffer_ptr->acquireFrames(chunk, wanted);
+        for (size_t i = 0; i < acquired; ++i) {
+            outFrames[total++] = reinterpret_cast<uintptr_t>(chunk[i]);
+        }
+        if (acquired < wanted) {
+            break;
+        }
+    }
+    return static_cast<int>(total);
+}
+
+FFI_PLUGIN_EXPORT void freeNativeBufferByHandleFFI(int32_t handle) {
+    NativeBufferSlot* slot = slotForHandle(handle);
+    if (!slot) {
+        return;
+    }
+    std::vector<std::shared_ptr<NativeBuffer>> released;
     {
-        std::lock_guard<std::mutex> lock(g_nativeBuffersMutex);
-        auto it = g_nativeBuffers.find(skey);
-        if (it == g_nativeBuffers.end()) {
-            return 0;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        {
+            std::lock_guard<std::mutex> slot_lock(slot->mutex);
+            uint32_t generation = slot->generation.load(std::memory_order_relaxed);
+            if (generation != (static_cast<uint32_t>(handle) >> kSlotIndexBits) || !slot->buffer) {
+                return;
+            }
+            // Retire the handle first so in-flight lookups fail instead of
+            // reaching the next buffer placed in this slot.
+            slot->generation.store((generation + 1) & kGenerationMask, std::memory_order_seq_cst);
+            slot->raw_buffer.store(nullptr, std::memory_order_seq_cst);
+            slot->port.store(0, std::memory_order_release);
+            // A call that resolved the handle before it was retired may still
+            // be using the buffer; then the last such call reclaims it.
+            slot->retired.push_back(std::move(slot->buffer));
+            slot->has_retired.store(true, std::memory_order_seq_cst);
+            released = takeReclaimable(*slot);
         }
-        buffer_ptr = it->second.get();
+        g_handlesByKey.erase(slot->key);
+        g_dartPorts.erase(slot->key);
+        slot->key.clear();
     }
-    int result = buffer_ptr->pushAudioFrame(buffer, dataSize, sampleRate, channels, frameTime);
-    return handlePushResult(result, skey);
+    // Outstanding frame leases keep the buffer alive past this point.
 }
 
+FFI_PLUGIN_EXPORT int pushVideoNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
+    int width, int height, uint64_t frameTime, int rotation, int frameType, int codecType) {
+    if (!key) {
+        return 0;
+    }
+    return pushVideoNativeBufferByHandleFFI(lookupHandle(key), buffer, dataSize, width, height,
+                                            frameTime, rotation, frameType, codecType);
+}
+
+FFI_PLUGIN_EXPORT int pushAudioNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
+  int sampleRate, int channels, uint64_t frameTime) {
+    if (!key) {
+        return 0;
+    }
+    return pushAudioNativeBufferByHandleFFI(lookupHandle(key), buffer, dataSize,
+                                            sampleRate, channels, frameTime);
+}
 
 FFI_PLUGIN_EXPORT uintptr_t popNativeBufferFFI(const char* key) {
     if (!key) {
         return 0;
     }
-    std::string skey(key);
-    NativeBuffer* buffer_ptr = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_nativeBuffersMutex);
-        auto it = g_nativeBuffers.find(skey);
-        if (it == g_nativeBuffers.end()) {
-            return 0;
-        }
-         buffer_ptr = it->second.get();
+    return popNativeBufferByHandleFFI(lookupHandle(key));
+}
+
+FFI_PLUGIN_EXPORT uintptr_t acquireNativeBufferFFI(const char* key) {
+    if (!key) {
+        return 0;
     }
-    MediaFrame* frame = buffer_ptr->popFrame();
-    return reinterpret_cast<uintptr_t>(frame);
+    return acquireNativeBufferByHandleFFI(lookupHandle(key));
+}
+
+FFI_PLUGIN_EXPORT uintptr_t acquirePrimingFrameFFI(const char* key) {
+    if (!key) {
+        return 0;
+    }
+    return acquirePrimingFrameByHandleFFI(lookupHandle(key));
+}
+
+FFI_PLUGIN_EXPORT int popBatchNativeBufferFFI(const char* key, uintptr_t* outFrames, int maxFrames) {
+    if (!key) {
+        return 0;
+    }
+    return std::max(0, popBatchNativeBufferByHandleFFI(lookupHandle(key), outFrames, maxFrames));
 }
 
 FFI_PLUGIN_EXPORT void freeNativeBufferFFI(const char* key) {
     if (!key) {
         return;
     }
+    int32_t handle = lookupHandle(key);
+    if (handle != 0) {
+        freeNativeBufferByHandleFFI(handle);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_dartPorts.erase(std::string(key));
+}
+
+FFI_PLUGIN_EXPORT bool getNativeBufferStatsByHandleFFI(int32_t handle, struct NativeBufferStats* out) {
+    if (!out) {
+        return false;
+    }
+    BufferRef buffer_ptr = resolveHandle(handle);
+    if (!buffer_ptr) {
+        return false;
+    }
+    buffer_ptr->stats(out);
+    return true;
+}
+
+FFI_PLUGIN_EXPORT bool getNativeBufferStatsFFI(const char* key, struct NativeBufferStats* out) {
+    if (!key) {
+        return false;
+    }
+    return getNativeBufferStatsByHandleFFI(lookupHandle(key), out);
+}
+
+// Attaches sink to the buffer currently registered under key, if any.
+// Callers hold g_registryMutex.
+static void setFrameSinkForKey(const std::string& key, std::shared_ptr<FrameSink> sink) {
+    auto handle_it = g_handlesByKey.find(key);
+    if (handle_it == g_handlesByKey.end()) {
+        return;
+    }
+    BufferRef buffer_ptr = resolveHandle(handle_it->second);
+    if (buffer_ptr) {
+        buffer_ptr->setFrameSink(std::move(sink));
+    }
+}
+
+FFI_PLUGIN_EXPORT bool startNativeRecordingFFI(const char* key, const char* path, int fragmentDurationMs) {
+    if (!key || !path || !*path) {
+        return false;
+    }
     std::string skey(key);
-    {
-        std::lock_guard<std::mutex> lock(g_nativeBuffersMutex);
-        size_t erased_count = g_nativeBuffers.erase(skey);
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    if (g_recorders.count(skey)) {
+        return false;
+    }
+    std::shared_ptr<NativeRecorder> recorder;
+    try {
+        recorder = std::make_shared<NativeRecorder>(path, fragmentDurationMs);
+    } catch (const std::exception& e) {
+        return false;
+    }
+    if (!recorder->start()) {
+        return false;
     }
+    g_recorders[skey] = recorder;
+    setFrameSinkForKey(skey, recorder);
+    return true;
+}
+
+FFI_PLUGIN_EXPORT bool rotateNativeRecordingFFI(const char* key, const char* newPath) {
+    if (!key || !newPath || !*newPath) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_recorders.find(std::string(key));
+    if (it == g_recorders.end()) {
+        return false;
+    }
+    it->second->rotate(newPath);
+    return true;
+}
+
+FFI_PLUGIN_EXPORT bool stopNativeRecordingFFI(const char* key) {
+    if (!key) {
+        return false;
+    }
+    std::string skey(key);
+    std::shared_ptr<NativeRecorder> recorder;
     {
-        std::lock_guard<std::mutex> port_lock(g_portsMutex);
-        g_dartPorts.erase(skey);
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        auto it = g_recorders.find(skey);
+        if (it == g_recorders.end()) {
+            return false;
+        }
+        recorder = std::move(it->second);
+        g_recorders.erase(it);
+        setFrameSinkForKey(skey, nullptr);
     }
+    // Joins the writer thread, so keep it outside the registry lock.
+    return recorder->stop();
+}
+
+FFI_PLUGIN_EXPORT void trimNativeBufferPoolFFI(void) {
+    FrameBufferPool::shared().trim();
 }
 
 FFI_PLUGIN_EXPORT bool initializeDartApiDL(void* data) {
@@ -148,13 +546,25 @@ FFI_PLUGIN_EXPORT bool initializeDartApiDL(void* data) {
 }
 
 FFI_PLUGIN_EXPORT bool registerDartPort(const char* channel_name, int64_t port) {
+    return registerDartPortWithMode(channel_name, port, NOTIFY_MODE_PER_FRAME);
+}
+
+FFI_PLUGIN_EXPORT bool registerDartPortWithMode(const char* channel_name, int64_t port, int notifyMode) {
     if (!channel_name || port <= 0) {
         return false;
     }
+    if (notifyMode != NOTIFY_MODE_PER_FRAME && notifyMode != NOTIFY_MODE_COALESCED) {
+        return false;
+    }
     std::string channel(channel_name);
+    DartPortRegistration registration{port, static_cast<NotifyMode>(notifyMode)};
     {
-        std::lock_guard<std::mutex> lock(g_portsMutex);
-        g_dartPorts[channel] = port;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_dartPorts[channel] = registration;
+        auto it = g_handlesByKey.find(channel);
+        if (it != g_handlesByKey.end()) {
+            applyPortRegistration(*slotForHandle(it->second), registration);
+        }
     }
     return true;
 }
@@ -227,8 +227,9 @@ public class MethodCallHandlerImpl implements MethodCallHandler, StateProvider {
             Log.e(TAG, "Failed to initialize native audio buffer");
             return;
         }
-        
-        long framePtr = AudioBufferUtil.pushAudioSamples(
+
+        // The samples are copied once, straight into the native ring slot.
+        AudioBufferUtil.pushAudioSamples(
             audioSamples.getData(),
             audioSamples.getSampleRate(),
             audioSamples.getChannelCount()
@@ -6,19 +6,26 @@ public class AudioBufferUtil {
     private static final String TAG = "AudioBufferUtil";
     private static final String AUDIO_BUFFER_KEY = "webrtc_audio_output";
     private static boolean initialized = false;
+    private static int nativeBufferHandle = 0;
+
+    // Mirrors BufferMode / OverflowPolicy in NativeBuffer.h.
+    private static final int BUFFER_MODE_SPSC = 1;
+    private static final int OVERFLOW_POLICY_DROP_OLDEST = 1;
 
     static {
         System.loadLibrary("native_lib");
     }
 
-    private static native int initNativeBuffer(String key, int capacity, int bufferSize);
-    private static native long pushAudioData(String key, byte[] samples, int sampleRate, int channels, long frameTime);
-    private static native void freeNativeBuffer(String key);
+    private static native int initNativeBuffer(String key, int capacity, int bufferSize,
+                                               int mode, int overflowPolicy);
+    private static native long pushAudioData(int handle, byte[] samples, int sampleRate, int channels, long frameTime);
+    private static native void freeNativeBuffer(int handle);
 
     public static boolean ensureInitialized(int capacity, int maxBufferSize) {
         if (!initialized) {
-            int result = initNativeBuffer(AUDIO_BUFFER_KEY, capacity, maxBufferSize);
-            initialized = (result != 0);
+            nativeBufferHandle = initNativeBuffer(AUDIO_BUFFER_KEY, capacity, maxBufferSize,
+                    BUFFER_MODE_SPSC, OVERFLOW_POLICY_DROP_OLDEST);
+            initialized = (nativeBufferHandle != 0);
         }
         return initialized;
     }
@@ -27,12 +34,13 @@ public class AudioBufferUtil {
         if (!initialized) {
             return 0;
         }
-        return pushAudioData(AUDIO_BUFFER_KEY, samples, sampleRate, channels, System.currentTimeMillis());
+        return pushAudioData(nativeBufferHandle, samples, sampleRate, channels, System.currentTimeMillis());
     }
 
     public static void dispose() {
         if (initialized) {
-            freeNativeBuffer(AUDIO_BUFFER_KEY);
+            freeNativeBuffer(nativeBufferHandle);
+            nativeBufferHandle = 0;
             initialized = false;
         }
     }
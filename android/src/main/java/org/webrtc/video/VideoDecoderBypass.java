@@ -16,11 +16,20 @@ public class VideoDecoderBypass implements VideoDecoder {
     private String trackId;
     private int codecType;
     private boolean isRingBufferInitialized = false;
+    private int nativeBufferHandle = 0;
 
-    public static native int initNativeBuffer(String trackId, int capacity, int bufferSize);
-    public static native long pushFrame(String trackId, ByteBuffer buffer, int width, int height,
+    // Mirrors BufferMode / OverflowPolicy in NativeBuffer.h.
+    public static final int BUFFER_MODE_LOCKED = 0;
+    public static final int BUFFER_MODE_SPSC = 1;
+    public static final int OVERFLOW_POLICY_BLOCK = 0;
+    public static final int OVERFLOW_POLICY_DROP_OLDEST = 1;
+    public static final int OVERFLOW_POLICY_DROP_NEWEST = 2;
+
+    public static native int initNativeBuffer(String trackId, int capacity, int bufferSize,
+                                              int mode, int overflowPolicy);
+    public static native long pushFrame(int handle, ByteBuffer buffer, int width, int height,
                                         long frameTime, int rotation, int frameType, int codecType);
-    public static native void freeNativeBuffer(String trackId);
+    public static native void freeNativeBuffer(int handle);
 
     public VideoDecoderBypass(String trackId, VideoCodecInfo codecInfo) {
         this.trackId = trackId;
@@ -48,7 +57,11 @@ public class VideoDecoderBypass implements VideoDecoder {
     @Override
     public final VideoCodecStatus release() {
         Log.d(TAG, "Releasing decoder for trackId: " + trackId);
-        freeNativeBuffer(trackId);
+        if (isRingBufferInitialized) {
+            freeNativeBuffer(nativeBufferHandle);
+            nativeBufferHandle = 0;
+            isRingBufferInitialized = false;
+        }
         return VideoCodecStatus.OK;
     }
 
@@ -64,8 +77,12 @@ public class VideoDecoderBypass implements VideoDecoder {
             int bufferSize = buffer.capacity() + 256;
             int capacity = 10;
             Log.d(TAG, "Initialize native buffer: " + trackId + " with capacity: " + capacity + " and buffer size: " + bufferSize);
-            int res = initNativeBuffer(trackId, capacity, bufferSize);
-            if (res == 0) {
+            // decode() is the only producer and the Dart isolate the only consumer,
+            // so the lock-free ring applies; dropping the oldest frame keeps the
+            // decoder thread from ever waiting on a stalled consumer.
+            nativeBufferHandle = initNativeBuffer(trackId, capacity, bufferSize,
+                    BUFFER_MODE_SPSC, OVERFLOW_POLICY_DROP_OLDEST);
+            if (nativeBufferHandle == 0) {
                 Log.e(TAG, "Failed to initialize native buffer.");
                 return VideoCodecStatus.ERROR;
             }
@@ -73,7 +90,7 @@ public class VideoDecoderBypass implements VideoDecoder {
             Log.d(TAG, "Native buffer initialized with slot size: " + bufferSize);
         }
 
-        long storedAddress = pushFrame(trackId, buffer, frame.encodedWidth, frame.encodedHeight,
+        long storedAddress = pushFrame(nativeBufferHandle, buffer, frame.encodedWidth, frame.encodedHeight,
                 frame.captureTimeMs, frame.rotation, frame.frameType.ordinal(), codecType);
         if (storedAddress == 0) {
             Log.e(TAG, "Failed to store frame in native buffer.");
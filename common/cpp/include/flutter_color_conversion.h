@@ -0,0 +1,63 @@
+#ifndef FLUTTER_WEBRTC_COLOR_CONVERSION_HXX
+#define FLUTTER_WEBRTC_COLOR_CONVERSION_HXX
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_webrtc_plugin {
+
+// Read-only view of an I420 frame, as exposed by RTCVideoFrame::DataY/U/V
+// and the matching strides.
+struct I420Planes {
+  const uint8_t* y;
+  const uint8_t* u;
+  const uint8_t* v;
+  int stride_y;
+  int stride_u;
+  int stride_v;
+  int width;
+  int height;
+};
+
+// Byte order of each output pixel in memory. kRGBA is what
+// FlutterDesktopPixelBuffer expects (libyuv and RTCVideoFrame call it ABGR).
+enum class PixelOrder { kRGBA, kBGRA };
+
+// Row kernel implementations, fastest first. kScalar is the reference the
+// SIMD kernels must match bit for bit.
+enum class ColorKernel { kAVX2, kSSE2, kNEON, kScalar };
+
+// The kernel ConvertI420 uses on this CPU, chosen once on first use.
+ColorKernel ActiveColorKernel();
+const char* ColorKernelName(ColorKernel kernel);
+
+// Converts src (BT.601, limited range) to dst_width x dst_height pixels of
+// 4 bytes each. rotation is clockwise in degrees (0, 90, 180 or 270) and is
+// applied before scaling, so dst_width/dst_height are the rotated size.
+// Scaling happens in the same pass as rotation and the colour conversion:
+// downscaling averages the source area behind each pixel (a box filter),
+// upscaling and rotation alone sample the nearest pixel, and the unscaled,
+// unrotated case reads the planes directly. dst_stride may be 0 for tightly
+// packed rows. Returns false if the arguments are invalid.
+bool ConvertI420(const I420Planes& src,
+                 int rotation,
+                 PixelOrder order,
+                 uint8_t* dst,
+                 int dst_stride,
+                 int dst_width,
+                 int dst_height);
+
+// Same as ConvertI420 but with an explicit kernel; kernels this CPU or
+// build does not support fall back to kScalar.
+bool ConvertI420WithKernel(ColorKernel kernel,
+                           const I420Planes& src,
+                           int rotation,
+                           PixelOrder order,
+                           uint8_t* dst,
+                           int dst_stride,
+                           int dst_width,
+                           int dst_height);
+
+}  // namespace flutter_webrtc_plugin
+
+#endif  // !FLUTTER_WEBRTC_COLOR_CONVERSION_HXX
@@ -10,10 +10,13 @@
 #include <flutter/standard_method_codec.h>
 #include <flutter/texture_registrar.h>
 
+#include <functional>
 #include <list>
 #include <memory>
 #include <string>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 typedef flutter::EncodableValue EncodableValue;
 typedef flutter::EncodableMap EncodableMap;
@@ -31,95 +34,136 @@ typedef flutter::MethodResult<EncodableValue> MethodResult;
 // foo.IsString() becomes std::holds_alternative<std::string>(foo)
 
 template <typename T>
-inline bool TypeIs(const EncodableValue val) {
+inline bool TypeIs(const EncodableValue& val) {
   return std::holds_alternative<T>(val);
 }
 
+// Returns a reference into val; bind it to a reference only when val
+// outlives the binding. Temporaries get the rvalue overload below, which
+// moves the alternative out instead.
 template <typename T>
-inline const T GetValue(EncodableValue val) {
+inline const T& GetValue(const EncodableValue& val) {
   return std::get<T>(val);
 }
 
-inline EncodableValue findEncodableValue(const EncodableMap& map,
-                                         const std::string& key) {
-  auto it = map.find(EncodableValue(key));
+template <typename T>
+inline T GetValue(EncodableValue&& val) {
+  return std::get<T>(std::move(val));
+}
+
+// A map key whose EncodableValue is built once. Lookups with a std::string
+// key construct a temporary EncodableValue (and usually a heap string) per
+// call; hot paths use namespace-scope EncodableKey constants instead.
+class EncodableKey {
+ public:
+  explicit EncodableKey(const char* name) : value_(name) {}
+
+  const EncodableValue& value() const { return value_; }
+  const std::string& name() const { return std::get<std::string>(value_); }
+
+ private:
+  EncodableValue value_;
+};
+
+inline EncodableValue KeyValue(const std::string& key) {
+  return EncodableValue(key);
+}
+
+inline const EncodableValue& KeyValue(const EncodableKey& key) {
+  return key.value();
+}
+
+// The find* helpers accept either a std::string or an EncodableKey.
+
+// The alternative of type T stored under key, or nullptr if the key is
+// missing or holds another type. Nothing is copied.
+template <typename T, typename Key>
+inline const T* findValue(const EncodableMap& map, const Key& key) {
+  auto it = map.find(KeyValue(key));
+  if (it == map.end())
+    return nullptr;
+  return std::get_if<T>(&it->second);
+}
+
+// The find* helpers below that return references point into map, or at a
+// shared empty value when the key is missing or of the wrong type.
+template <typename Key>
+inline const EncodableValue& findEncodableValue(const EncodableMap& map,
+                                                const Key& key) {
+  static const EncodableValue kEmpty;
+  auto it = map.find(KeyValue(key));
   if (it != map.end())
     return it->second;
-  return EncodableValue();
+  return kEmpty;
 }
 
-inline EncodableMap findMap(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<EncodableMap>(it->second))
-    return GetValue<EncodableMap>(it->second);
-  return EncodableMap();
+template <typename Key>
+inline const EncodableMap& findMap(const EncodableMap& map, const Key& key) {
+  static const EncodableMap kEmpty;
+  const EncodableMap* value = findValue<EncodableMap>(map, key);
+  return value ? *value : kEmpty;
 }
 
-inline EncodableList findList(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<EncodableList>(it->second))
-    return GetValue<EncodableList>(it->second);
-  return EncodableList();
+template <typename Key>
+inline const EncodableList& findList(const EncodableMap& map, const Key& key) {
+  static const EncodableList kEmpty;
+  const EncodableList* value = findValue<EncodableList>(map, key);
+  return value ? *value : kEmpty;
 }
 
-inline std::string findString(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<std::string>(it->second))
-    return GetValue<std::string>(it->second);
-  return std::string();
+template <typename Key>
+inline std::string findString(const EncodableMap& map, const Key& key) {
+  const std::string* value = findValue<std::string>(map, key);
+  return value ? *value : std::string();
 }
 
-inline int findInt(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<int>(it->second))
-    return GetValue<int>(it->second);
-  return -1;
+template <typename Key>
+inline int findInt(const EncodableMap& map, const Key& key) {
+  const int* value = findValue<int>(map, key);
+  return value ? *value : -1;
 }
 
-inline bool findBoolean(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<bool>(it->second))
-    return GetValue<bool>(it->second);
-  return false;
+template <typename Key>
+inline bool findBoolean(const EncodableMap& map, const Key& key) {
+  const bool* value = findValue<bool>(map, key);
+  return value ? *value : false;
 }
 
-inline double findDouble(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<double>(it->second))
-    return GetValue<double>(it->second);
-  return 0.0;
+template <typename Key>
+inline double findDouble(const EncodableMap& map, const Key& key) {
+  const double* value = findValue<double>(map, key);
+  return value ? *value : 0.0;
 }
 
-inline std::optional<double> maybeFindDouble(const EncodableMap& map, const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<double>(it->second))
-    return GetValue<double>(it->second);
+template <typename Key>
+inline std::optional<double> maybeFindDouble(const EncodableMap& map,
+                                             const Key& key) {
+  const double* value = findValue<double>(map, key);
+  if (value)
+    return *value;
   return std::nullopt;
 }
 
-inline std::vector<uint8_t> findVector(const EncodableMap& map,
-                                       const std::string& key) {
-  auto it = map.find(EncodableValue(key));
-  if (it != map.end() && TypeIs<std::vector<uint8_t>>(it->second))
-    return GetValue<std::vector<uint8_t>>(it->second);
-  return std::vector<uint8_t>();
+template <typename Key>
+inline const std::vector<uint8_t>& findVector(const EncodableMap& map,
+                                              const Key& key) {
+  static const std::vector<uint8_t> kEmpty;
+  const std::vector<uint8_t>* value = findValue<std::vector<uint8_t>>(map, key);
+  return value ? *value : kEmpty;
 }
 
-inline int64_t findLongInt(const EncodableMap& map, const std::string& key) {
-  for (auto it : map) {
-    if (key == GetValue<std::string>(it.first)) {
-      if (TypeIs<int64_t>(it.second)) {
-        return GetValue<int64_t>(it.second);
-      } else if (TypeIs<int32_t>(it.second)) {
-        return GetValue<int32_t>(it.second);
-      }
-    }
+template <typename Key>
+inline int64_t findLongInt(const EncodableMap& map, const Key& key) {
+  const EncodableValue& value = findEncodableValue(map, key);
+  if (TypeIs<int64_t>(value)) {
+    return GetValue<int64_t>(value);
+  } else if (TypeIs<int32_t>(value)) {
+    return GetValue<int32_t>(value);
   }
-
   return -1;
 }
 
-inline int toInt(flutter::EncodableValue inputVal, int defaultVal) {
+inline int toInt(const EncodableValue& inputVal, int defaultVal) {
   int intValue = defaultVal;
   if (TypeIs<int>(inputVal)) {
     intValue = GetValue<int>(inputVal);
@@ -167,16 +211,118 @@ class MethodResultProxy {
   virtual void NotImplemented() = 0;
 };
 
+typedef std::function<void(const MethodCallProxy& method_call,
+                           std::unique_ptr<MethodResultProxy> result)>
+    MethodHandler;
+
+// Where a method's handler may run. kWorker is for handlers that block
+// (device enumeration, starting a capturer, window thumbnails) and do not
+// touch platform-thread-only APIs such as texture or channel registration.
+enum class MethodThread { kPlatform, kWorker };
+
+// Maps method names to their handlers. Filled once at startup, then only
+// read.
+class MethodHandlerTable {
+ public:
+  void Register(const std::string& method_name,
+                MethodHandler handler,
+                MethodThread thread = MethodThread::kPlatform) {
+    handlers_[method_name] = Entry{std::move(handler), thread};
+  }
+
+  template <typename T>
+  void Register(const std::string& method_name,
+                T* receiver,
+                void (T::*method)(const MethodCallProxy& method_call,
+                                  std::unique_ptr<MethodResultProxy> result),
+                MethodThread thread = MethodThread::kPlatform) {
+    Register(
+        method_name,
+        [receiver, method](const MethodCallProxy& method_call,
+                           std::unique_ptr<MethodResultProxy> result) {
+          (receiver->*method)(method_call, std::move(result));
+        },
+        thread);
+  }
+
+  // The thread policy of method_name; unknown methods run on the platform
+  // thread, where they are answered with NotImplemented.
+  MethodThread ThreadFor(const std::string& method_name) const {
+    auto it = handlers_.find(method_name);
+    return it == handlers_.end() ? MethodThread::kPlatform : it->second.thread;
+  }
+
+  // Runs the handler for method_call and takes *result. Returns false, and
+  // leaves *result alone, when no handler is registered.
+  bool Dispatch(const MethodCallProxy& method_call,
+                std::unique_ptr<MethodResultProxy>* result) const {
+    auto it = handlers_.find(method_call.method_name());
+    if (it == handlers_.end()) {
+      return false;
+    }
+    it->second.handler(method_call, std::move(*result));
+    return true;
+  }
+
+ private:
+  struct Entry {
+    MethodHandler handler;
+    MethodThread thread;
+  };
+
+  std::unordered_map<std::string, Entry> handlers_;
+};
+
 class EventChannelProxy {
  public:
   static std::unique_ptr<EventChannelProxy> Create(
       BinaryMessenger* messenger,
       const std::string& channelName);
 
+  // What a batching channel does with an event that finds its queue full.
+  enum class Overflow {
+    // Drop it and count it in dropped_events().
+    kDrop,
+    // Keep it, and every event after it, in an unbounded list that the
+    // next flush sends after the queue, so nothing is lost or reordered.
+    // For channels whose events Dart cannot do without.
+    kKeep,
+  };
+
+  // Batching variant: Success() only moves the event into a bounded
+  // lock-free queue, and a shared dispatcher thread sends everything queued
+  // every batch_interval_ms as one EncodableList (a lone event is sent as
+  // is). Listeners on the Dart side must accept both forms. A full queue is
+  // handled according to overflow and asks for an immediate flush; the
+  // caller never waits.
+  static std::unique_ptr<EventChannelProxy> Create(
+      BinaryMessenger* messenger,
+      const std::string& channelName,
+      int batch_interval_ms,
+      Overflow overflow = Overflow::kDrop);
+
+  // Posts a task to the platform thread. Embedders that can do so install
+  // one at registration, before any channel is created; events are then
+  // sent from the platform thread. Without one they are sent from the
+  // calling thread, serialised by the proxy.
+  typedef std::function<void(std::function<void()>)> PlatformTaskRunner;
+  static void SetPlatformTaskRunner(PlatformTaskRunner runner);
+
+  // The runner installed above, or an empty function. Also used to return
+  // the results of method calls that run off the platform thread.
+  static const PlatformTaskRunner& platform_task_runner();
+
   virtual ~EventChannelProxy() = default;
 
+  // Safe to call from any thread. Before Dart listens, events with
+  // cache_event set are kept (up to a bound) and replayed on listen.
   virtual void Success(const EncodableValue& event,
                        bool cache_event = true) = 0;
+
+  // Events dropped because the pre-listen queue (cached events) or, with
+  // Overflow::kDrop, the batching queue was full. Logged when the channel
+  // is destroyed if non-zero.
+  virtual uint64_t dropped_events() const = 0;
 };
 
 #endif  // FLUTTER_WEBRTC_COMMON_HXX
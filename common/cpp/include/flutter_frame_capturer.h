@@ -7,6 +7,7 @@
 #include "rtc_video_frame.h"
 #include "rtc_video_renderer.h"
 
+#include <condition_variable>
 #include <mutex>
 
 namespace flutter_webrtc_plugin {
@@ -25,9 +26,10 @@ class FlutterFrameCapturer
  private:
   RTCVideoTrack* track_;
   std::string path_;
+  // Guards frame_, which the track's thread sets from OnFrame.
   std::mutex mutex_;
+  std::condition_variable frame_received_;
   scoped_refptr<RTCVideoFrame> frame_;
-  volatile bool catch_frame_;
 
   bool SaveFrame();
 };
@@ -0,0 +1,74 @@
+#ifndef FLUTTER_WEBRTC_FRAME_CONVERSION_HXX
+#define FLUTTER_WEBRTC_FRAME_CONVERSION_HXX
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace flutter_webrtc_plugin {
+
+// A small fixed set of worker threads shared by every video renderer. Frames
+// are converted to RGBA here as they arrive, so the WebRTC decode thread only
+// queues work and the Flutter raster thread only picks up finished buffers.
+class FrameConversionPool {
+ public:
+  static FrameConversionPool& Shared();
+
+  // Runs the tasks still queued, then joins the workers.
+  ~FrameConversionPool();
+
+  // Tasks posted once the pool is shutting down are dropped.
+  void Post(std::function<void()> task);
+
+ private:
+  FrameConversionPool();
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+// Process-wide cache of 64-byte aligned pixel buffers, bucketed by size in
+// quarter-power-of-two steps so a buffer fits any size within 25% below its
+// capacity. Renderers switching between simulcast layers take buffers back
+// out of the cache instead of going to the allocator for every switch.
+class PixelBufferPool {
+ public:
+  static const size_t kAlignment = 64;
+
+  static PixelBufferPool& Shared();
+
+  // Returns a buffer of at least size bytes and stores its real size in
+  // capacity, which must be passed back to Release.
+  uint8_t* Acquire(size_t size, size_t* capacity);
+  void Release(uint8_t* data, size_t capacity);
+
+  // Frees every cached buffer.
+  void Trim();
+
+ private:
+  PixelBufferPool() = default;
+
+  uint8_t* Allocate(size_t capacity);
+  void Free(uint8_t* data, size_t capacity);
+
+  std::mutex mutex_;
+  std::map<size_t, std::vector<uint8_t*>> free_;
+  // Buffers backed by their own page mapping rather than the heap.
+  std::set<uint8_t*> mapped_;
+  size_t cached_bytes_ = 0;
+};
+
+}  // namespace flutter_webrtc_plugin
+
+#endif  // !FLUTTER_WEBRTC_FRAME_CONVERSION_HXX
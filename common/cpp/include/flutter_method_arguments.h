@@ -0,0 +1,193 @@
+#ifndef FLUTTER_WEBRTC_METHOD_ARGUMENTS_HXX
+#define FLUTTER_WEBRTC_METHOD_ARGUMENTS_HXX
+
+#include "flutter_common.h"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flutter_webrtc_plugin {
+
+// Argument keys used on the signalling paths.
+inline const EncodableKey kPeerConnectionIdKey("peerConnectionId");
+inline const EncodableKey kDataChannelIdKey("dataChannelId");
+inline const EncodableKey kTrackIdKey("trackId");
+inline const EncodableKey kConstraintsKey("constraints");
+inline const EncodableKey kDescriptionKey("description");
+inline const EncodableKey kCandidateKey("candidate");
+inline const EncodableKey kSdpMidKey("sdpMid");
+inline const EncodableKey kSdpMLineIndexKey("sdpMLineIndex");
+inline const EncodableKey kSdpKey("sdp");
+inline const EncodableKey kTypeKey("type");
+inline const EncodableKey kDataKey("data");
+
+// How a field of type T is read from an EncodableValue. Value types are
+// copied out; const T* fields point into the decoded arguments, which
+// outlive the handler call, so maps, lists and byte buffers are not copied.
+template <typename T>
+struct ArgumentField {
+  static bool Assign(const EncodableValue& value, T* field) {
+    const T* typed = std::get_if<T>(&value);
+    if (!typed)
+      return false;
+    *field = *typed;
+    return true;
+  }
+};
+
+template <typename T>
+struct ArgumentField<const T*> {
+  static bool Assign(const EncodableValue& value, const T** field) {
+    const T* typed = std::get_if<T>(&value);
+    if (!typed)
+      return false;
+    *field = typed;
+    return true;
+  }
+};
+
+template <>
+struct ArgumentField<const EncodableValue*> {
+  static bool Assign(const EncodableValue& value,
+                     const EncodableValue** field) {
+    *field = &value;
+    return true;
+  }
+};
+
+// The standard codec sends integers that fit in 32 bits as int32.
+template <>
+struct ArgumentField<int64_t> {
+  static bool Assign(const EncodableValue& value, int64_t* field) {
+    if (const int32_t* small = std::get_if<int32_t>(&value)) {
+      *field = *small;
+      return true;
+    }
+    if (const int64_t* large = std::get_if<int64_t>(&value)) {
+      *field = *large;
+      return true;
+    }
+    return false;
+  }
+};
+
+// Dart sends whole doubles as integers when the caller passed an int.
+template <>
+struct ArgumentField<double> {
+  static bool Assign(const EncodableValue& value, double* field) {
+    if (const double* real = std::get_if<double>(&value)) {
+      *field = *real;
+      return true;
+    }
+    int64_t integer = 0;
+    if (!ArgumentField<int64_t>::Assign(value, &integer))
+      return false;
+    *field = static_cast<double>(integer);
+    return true;
+  }
+};
+
+// Decodes an argument map into the plain struct Args in one pass over the
+// map. Fields are declared once, typically as a function-local static:
+//
+//   struct GetStatsArguments {
+//     std::string peer_connection_id;
+//     std::string track_id;
+//   };
+//   static const ArgumentSchema<GetStatsArguments> schema =
+//       ArgumentSchema<GetStatsArguments>()
+//           .Required(kPeerConnectionIdKey,
+//                     &GetStatsArguments::peer_connection_id)
+//           .Optional(kTrackIdKey, &GetStatsArguments::track_id);
+//
+// Optional fields keep their initial value when the key is missing or null.
+// A missing required field, or any field of the wrong type, fails the
+// decode with a message naming the key. Unknown keys are ignored.
+template <typename Args>
+class ArgumentSchema {
+ public:
+  template <typename T>
+  ArgumentSchema& Required(const EncodableKey& key, T Args::*member) {
+    return Add(key, member, true);
+  }
+
+  template <typename T>
+  ArgumentSchema& Optional(const EncodableKey& key, T Args::*member) {
+    return Add(key, member, false);
+  }
+
+  bool Decode(const EncodableMap& map,
+              Args* args,
+              std::string* error) const {
+    uint64_t seen = 0;
+    for (const auto& entry : map) {
+      const std::string* name = std::get_if<std::string>(&entry.first);
+      if (!name)
+        continue;
+      auto it = index_.find(*name);
+      if (it == index_.end() || entry.second.IsNull())
+        continue;
+      const Field& field = fields_[it->second];
+      if (!field.assign(entry.second, args)) {
+        *error = "argument " + *name + " has the wrong type";
+        return false;
+      }
+      seen |= uint64_t{1} << it->second;
+    }
+    for (size_t i = 0; i < fields_.size(); i++) {
+      if (fields_[i].required && !(seen & (uint64_t{1} << i))) {
+        *error = "missing argument " + fields_[i].name;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Decodes the arguments of method_call. On failure reports a
+  // "Bad Arguments" error on result and returns false.
+  bool Decode(const MethodCallProxy& method_call,
+              Args* args,
+              MethodResultProxy* result) const {
+    const EncodableValue* arguments = method_call.arguments();
+    const EncodableMap* map =
+        arguments ? std::get_if<EncodableMap>(arguments) : nullptr;
+    std::string error = "arguments are not a map";
+    if (map && Decode(*map, args, &error))
+      return true;
+    result->Error("Bad Arguments", method_call.method_name() + "() " + error);
+    return false;
+  }
+
+ private:
+  struct Field {
+    std::string name;
+    bool required;
+    std::function<bool(const EncodableValue&, Args*)> assign;
+  };
+
+  template <typename T>
+  ArgumentSchema& Add(const EncodableKey& key, T Args::*member, bool required) {
+    // Presence is tracked in a 64-bit mask.
+    assert(fields_.size() < 64);
+    Field field;
+    field.name = key.name();
+    field.required = required;
+    field.assign = [member](const EncodableValue& value, Args* args) {
+      return ArgumentField<T>::Assign(value, &(args->*member));
+    };
+    index_[field.name] = fields_.size();
+    fields_.push_back(std::move(field));
+    return *this;
+  }
+
+  std::vector<Field> fields_;
+  std::unordered_map<std::string, size_t> index_;
+};
+
+}  // namespace flutter_webrtc_plugin
+
+#endif  // !FLUTTER_WEBRTC_METHOD_ARGUMENTS_HXX
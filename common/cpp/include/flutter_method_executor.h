@@ -0,0 +1,43 @@
+#ifndef FLUTTER_WEBRTC_METHOD_EXECUTOR_HXX
+#define FLUTTER_WEBRTC_METHOD_EXECUTOR_HXX
+
+#include "flutter_common.h"
+
+#include <memory>
+
+namespace flutter_webrtc_plugin {
+
+// Runs method calls in arrival order, each on the thread its handler was
+// registered for (see MethodThread). Calls never overlap, so handlers keep
+// seeing the plugin state from one thread at a time: while a kWorker call
+// runs, later calls wait in a queue instead of blocking the platform
+// thread. Results are answered on the platform thread.
+//
+// This needs a platform task runner (EventChannelProxy::
+// SetPlatformTaskRunner), which the Linux and Windows plugins install.
+// flutter-elinux has no way to post to its platform thread, so there every
+// call runs inline on the calling thread and kWorker calls still block it.
+class MethodCallExecutor {
+ public:
+  // methods must outlive the executor.
+  explicit MethodCallExecutor(const MethodHandlerTable* methods);
+  // Waits for a worker call in progress and joins the worker. Calls still
+  // queued are answered with a "disposed" error.
+  ~MethodCallExecutor();
+
+  MethodCallExecutor(const MethodCallExecutor&) = delete;
+  MethodCallExecutor& operator=(const MethodCallExecutor&) = delete;
+
+  // Must be called on the platform thread. Unknown methods are answered
+  // with NotImplemented.
+  void Dispatch(const MethodCallProxy& method_call,
+                std::unique_ptr<MethodResultProxy> result);
+
+ private:
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace flutter_webrtc_plugin
+
+#endif  // !FLUTTER_WEBRTC_METHOD_EXECUTOR_HXX
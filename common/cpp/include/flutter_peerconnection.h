@@ -120,7 +120,7 @@ class FlutterPeerConnection {
                              std::unique_ptr<MethodResultProxy> result);
 
   scoped_refptr<RTCRtpParameters> updateRtpParameters(
-      EncodableMap newParameters,
+      const EncodableMap& newParameters,
       scoped_refptr<RTCRtpParameters> parameters);
 
   void RtpSenderSetParameters(RTCPeerConnection* pc,
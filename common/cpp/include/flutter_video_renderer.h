@@ -2,11 +2,15 @@
 #define FLUTTER_WEBRTC_RTC_VIDEO_RENDERER_HXX
 
 #include "flutter_common.h"
+#include "flutter_frame_conversion.h"
 #include "flutter_webrtc_base.h"
 
 #include "rtc_video_frame.h"
 #include "rtc_video_renderer.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 
 namespace flutter_webrtc_plugin {
@@ -23,8 +27,13 @@ class FlutterVideoRenderer
   void initialize(TextureRegistrar* registrar,
                   BinaryMessenger* messenger,
                   std::unique_ptr<flutter::TextureVariant> texture,
-                  int64_t texture_id);
+                  int64_t texture_id,
+                  PixelBufferPool* buffer_pool);
 
+  // Called on the raster thread. Only publishes the newest converted buffer;
+  // the conversion itself already happened on FrameConversionPool. width and
+  // height are the size the texture is drawn at and become the conversion
+  // target for the following frames.
   virtual const FlutterDesktopPixelBuffer* CopyPixelBuffer(size_t width,
                                                            size_t height) const;
 
@@ -32,8 +41,40 @@ class FlutterVideoRenderer
 
   void SetVideoTrack(scoped_refptr<RTCVideoTrack> track);
 
+  // Stops converting frames: drops the pending one and waits for a
+  // conversion in flight, so no worker touches the texture once this
+  // returns. Called before the texture is unregistered.
+  void StopConversions();
+
+  // Caps the rate at which frames are converted and shown. Frames arriving
+  // sooner than 1 / max_fps after the last accepted one are dropped in
+  // OnFrame before any conversion or event. 0 (the default) disables it.
+  void SetMaxFps(double max_fps);
+
+  // When enabled, frame->rotation() is applied while converting, so the
+  // texture is always upright: didTextureChangeVideoSize reports the rotated
+  // size and the rotation reported to Dart stays at 0. Off by default.
+  void SetNativeRotation(bool enabled);
+
   int64_t texture_id() { return texture_id_; }
 
+  // Conversions that were not needed: repaints served from the buffer that
+  // was already converted, and frames replaced by a newer one before the
+  // worker got to them.
+  uint64_t skipped_conversions() const {
+    return skipped_conversions_.load(std::memory_order_relaxed);
+  }
+
+  // Frames dropped by the SetMaxFps governor.
+  uint64_t decimated_frames() const {
+    return decimated_frames_.load(std::memory_order_relaxed);
+  }
+
+  // Events the renderer's batching event channel had to drop.
+  uint64_t dropped_events() const {
+    return event_channel_ ? event_channel_->dropped_events() : 0;
+  }
+
   bool CheckMediaStream(std::string mediaId);
 
   bool CheckVideoTrack(std::string mediaId);
@@ -45,17 +86,66 @@ class FlutterVideoRenderer
     size_t width;
     size_t height;
   };
+  // One of three ABGR buffers: the front one is what the raster thread last
+  // took, the ready one holds the newest finished conversion and the back
+  // one is written by the conversion worker. Roles rotate by swapping
+  // indices under mutex_, so no pixels are ever copied between them.
+  struct PixelSlot {
+    uint8_t* data = nullptr;  // From buffer_pool_.
+    size_t capacity = 0;
+    size_t width = 0;
+    size_t height = 0;
+    // frame_generation_ of the frame converted into this slot; 0 when empty.
+    uint64_t generation = 0;
+  };
+
+  // Runs on FrameConversionPool; converts pending_frame_ until none is left.
+  void ConvertPendingFrames();
+
+  // Size to convert a frame_width x frame_height frame to when it is drawn at
+  // target_width x target_height: the smallest size that keeps the frame's
+  // aspect ratio and still covers the target, rounded up so small layout
+  // animations do not change it, and never larger than the frame itself.
+  static FrameSize OutputSizeFor(size_t frame_width,
+                                 size_t frame_height,
+                                 size_t target_width,
+                                 size_t target_height);
+
   FrameSize last_frame_size_ = {0, 0};
   bool first_frame_rendered = false;
   TextureRegistrar* registrar_ = nullptr;
   std::unique_ptr<EventChannelProxy> event_channel_;
   int64_t texture_id_ = -1;
   scoped_refptr<RTCVideoTrack> track_ = nullptr;
-  scoped_refptr<RTCVideoFrame> frame_;
   std::unique_ptr<flutter::TextureVariant> texture_;
-  std::shared_ptr<FlutterDesktopPixelBuffer> pixel_buffer_;
-  mutable std::shared_ptr<uint8_t> rgb_buffer_;
+  std::unique_ptr<FlutterDesktopPixelBuffer> pixel_buffer_;
+  PixelBufferPool* buffer_pool_ = nullptr;
+  // Guards pending_frame_, the conversion flags and the slot indices. Held
+  // only for pointer swaps, never across a conversion.
   mutable std::mutex mutex_;
+  scoped_refptr<RTCVideoFrame> pending_frame_;
+  // Bumped for every frame OnFrame receives; pending_generation_ is the value
+  // that belongs to pending_frame_.
+  uint64_t frame_generation_ = 0;
+  uint64_t pending_generation_ = 0;
+  // Rotation to apply to pending_frame_ during conversion, in degrees.
+  int pending_rotation_ = 0;
+  bool conversion_scheduled_ = false;
+  bool conversions_stopped_ = false;
+  // Signalled when conversion_scheduled_ goes back to false.
+  std::condition_variable conversion_done_;
+  mutable PixelSlot slots_[3];
+  mutable int front_slot_ = 0;
+  mutable int ready_slot_ = 1;
+  int back_slot_ = 2;
+  mutable FrameSize target_size_ = {0, 0};
+  mutable std::atomic<uint64_t> skipped_conversions_{0};
+  // Governor state. The interval is written from the platform thread; the
+  // due time is only touched by OnFrame, which runs on one thread at a time.
+  std::atomic<int64_t> min_frame_interval_us_{0};
+  int64_t next_frame_due_us_ = 0;
+  std::atomic<uint64_t> decimated_frames_{0};
+  std::atomic<bool> native_rotation_{false};
   RTCVideoFrame::VideoRotation rotation_ = RTCVideoFrame::kVideoRotation_0;
 };
 
@@ -73,7 +163,22 @@ class FlutterVideoRendererManager {
   void VideoRendererDispose(int64_t texture_id,
                             std::unique_ptr<MethodResultProxy> result);
 
+  void VideoRendererSetMaxFps(int64_t texture_id,
+                              double max_fps,
+                              std::unique_ptr<MethodResultProxy> result);
+
+  void VideoRendererSetNativeRotation(
+      int64_t texture_id,
+      bool enabled,
+      std::unique_ptr<MethodResultProxy> result);
+
+  // Replies with the renderer's counters as a map, for diagnostics.
+  void VideoRendererGetStats(int64_t texture_id,
+                             std::unique_ptr<MethodResultProxy> result);
+
  private:
+  void TrimPixelBuffersIfIdle();
+
   FlutterWebRTCBase* base_;
   std::map<int64_t, scoped_refptr<FlutterVideoRenderer>> renderers_;
 };
@@ -0,0 +1,678 @@
+#include "flutter_color_conversion.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define FLUTTER_WEBRTC_COLOR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define FLUTTER_WEBRTC_COLOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(FLUTTER_WEBRTC_COLOR_X86) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define FLUTTER_WEBRTC_TARGET(x) __attribute__((target(x)))
+#else
+#define FLUTTER_WEBRTC_TARGET(x)
+#endif
+
+namespace flutter_webrtc_plugin {
+
+namespace {
+
+// BT.601 limited range in 6-bit fixed point, small enough that every product
+// fits in int16 so the SIMD kernels can stay at 16-bit lanes:
+//   R = 1.164 (Y - 16) + 1.596 (V - 128)
+//   G = 1.164 (Y - 16) - 0.391 (U - 128) - 0.813 (V - 128)
+//   B = 1.164 (Y - 16) + 2.018 (U - 128)
+// Luma needs more precision than 6 bits give, so it is scaled as
+// (Y * 0x0101 * kYGain) >> 16, which is a single high-half multiply in SIMD.
+// Only sums that end up above 255 anyway can saturate an int16, so the
+// scalar version computing in int gives identical output.
+const int kYGain = 18997;  // 1.164 * 64 * 65536 / 257
+const int kYBias = 1192;   // 16 * 1.164 * 64
+const int kVToR = 102;
+const int kUToG = 25;
+const int kVToG = 52;
+const int kUToB = 129;
+const int kRound = 32;
+const int kShift = 6;
+
+// Converts one row of samples: y holds width luma samples, u and v hold
+// (width + 1) / 2 chroma samples each, one per horizontal pixel pair.
+typedef void (*RowFunction)(const uint8_t* y,
+                            const uint8_t* u,
+                            const uint8_t* v,
+                            uint8_t* dst,
+                            int width,
+                            PixelOrder order);
+
+inline uint8_t Clamp255(int value) {
+  return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+void RowScalarFrom(const uint8_t* y,
+                   const uint8_t* u,
+                   const uint8_t* v,
+                   uint8_t* dst,
+                   int begin,
+                   int width,
+                   PixelOrder order) {
+  const int r_index = order == PixelOrder::kRGBA ? 0 : 2;
+  const int b_index = 2 - r_index;
+  for (int x = begin; x < width; ++x) {
+    const int luma = ((y[x] * 0x0101 * kYGain) >> 16) - kYBias;
+    const int cb = u[x >> 1] - 128;
+    const int cr = v[x >> 1] - 128;
+    uint8_t* pixel = dst + x * 4;
+    pixel[r_index] = Clamp255((luma + kVToR * cr + kRound) >> kShift);
+    pixel[1] = Clamp255((luma - kUToG * cb - kVToG * cr + kRound) >> kShift);
+    pixel[b_index] = Clamp255((luma + kUToB * cb + kRound) >> kShift);
+    pixel[3] = 255;
+  }
+}
+
+void RowScalar(const uint8_t* y,
+               const uint8_t* u,
+               const uint8_t* v,
+               uint8_t* dst,
+               int width,
+               PixelOrder order) {
+  RowScalarFrom(y, u, v, dst, 0, width, order);
+}
+
+#if defined(FLUTTER_WEBRTC_COLOR_X86)
+
+FLUTTER_WEBRTC_TARGET("sse2")
+void RowSSE2(const uint8_t* y,
+             const uint8_t* u,
+             const uint8_t* v,
+             uint8_t* dst,
+             int width,
+             PixelOrder order) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i y_gain = _mm_set1_epi16(kYGain);
+  const __m128i y_bias = _mm_set1_epi16(kYBias);
+  const __m128i chroma_offset = _mm_set1_epi16(128);
+  const __m128i v_to_r = _mm_set1_epi16(kVToR);
+  const __m128i u_to_g = _mm_set1_epi16(kUToG);
+  const __m128i v_to_g = _mm_set1_epi16(kVToG);
+  const __m128i u_to_b = _mm_set1_epi16(kUToB);
+  const __m128i round = _mm_set1_epi16(kRound);
+  const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    int32_t u4;
+    int32_t v4;
+    memcpy(&u4, u + x / 2, sizeof(u4));
+    memcpy(&v4, v + x / 2, sizeof(v4));
+    __m128i uu = _mm_cvtsi32_si128(u4);
+    __m128i vv = _mm_cvtsi32_si128(v4);
+    uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(uu, uu), zero),
+                       chroma_offset);
+    vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(vv, vv), zero),
+                       chroma_offset);
+    __m128i yy = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x));
+    // Interleaving Y with itself gives Y * 0x0101 in each 16-bit lane.
+    yy = _mm_sub_epi16(_mm_mulhi_epu16(_mm_unpacklo_epi8(yy, yy), y_gain),
+                       y_bias);
+
+    __m128i r = _mm_adds_epi16(yy, _mm_mullo_epi16(vv, v_to_r));
+    __m128i g = _mm_subs_epi16(_mm_subs_epi16(yy, _mm_mullo_epi16(uu, u_to_g)),
+                               _mm_mullo_epi16(vv, v_to_g));
+    __m128i b = _mm_adds_epi16(yy, _mm_mullo_epi16(uu, u_to_b));
+    r = _mm_srai_epi16(_mm_adds_epi16(r, round), kShift);
+    g = _mm_srai_epi16(_mm_adds_epi16(g, round), kShift);
+    b = _mm_srai_epi16(_mm_adds_epi16(b, round), kShift);
+    r = _mm_packus_epi16(r, r);
+    g = _mm_packus_epi16(g, g);
+    b = _mm_packus_epi16(b, b);
+
+    const __m128i first = order == PixelOrder::kRGBA ? r : b;
+    const __m128i third = order == PixelOrder::kRGBA ? b : r;
+    const __m128i first_second = _mm_unpacklo_epi8(first, g);
+    const __m128i third_alpha = _mm_unpacklo_epi8(third, alpha);
+    __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(first_second, third_alpha));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(first_second, third_alpha));
+  }
+  RowScalarFrom(y, u, v, dst, x, width, order);
+}
+
+FLUTTER_WEBRTC_TARGET("avx2")
+void RowAVX2(const uint8_t* y,
+             const uint8_t* u,
+             const uint8_t* v,
+             uint8_t* dst,
+             int width,
+             PixelOrder order) {
+  const __m256i y_gain = _mm256_set1_epi16(kYGain);
+  const __m256i y_bias = _mm256_set1_epi16(kYBias);
+  const __m256i chroma_offset = _mm256_set1_epi16(128);
+  const __m256i v_to_r = _mm256_set1_epi16(kVToR);
+  const __m256i u_to_g = _mm256_set1_epi16(kUToG);
+  const __m256i v_to_g = _mm256_set1_epi16(kVToG);
+  const __m256i u_to_b = _mm256_set1_epi16(kUToB);
+  const __m256i round = _mm256_set1_epi16(kRound);
+  const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+    __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+    __m256i uu = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), chroma_offset);
+    __m256i vv = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), chroma_offset);
+    __m256i yy = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+    yy = _mm256_or_si256(_mm256_slli_epi16(yy, 8), yy);
+    yy = _mm256_sub_epi16(_mm256_mulhi_epu16(yy, y_gain), y_bias);
+
+    __m256i r = _mm256_adds_epi16(yy, _mm256_mullo_epi16(vv, v_to_r));
+    __m256i g = _mm256_subs_epi16(
+        _mm256_subs_epi16(yy, _mm256_mullo_epi16(uu, u_to_g)),
+        _mm256_mullo_epi16(vv, v_to_g));
+    __m256i b = _mm256_adds_epi16(yy, _mm256_mullo_epi16(uu, u_to_b));
+    r = _mm256_srai_epi16(_mm256_adds_epi16(r, round), kShift);
+    g = _mm256_srai_epi16(_mm256_adds_epi16(g, round), kShift);
+    b = _mm256_srai_epi16(_mm256_adds_epi16(b, round), kShift);
+    // _mm256_packus_epi16 works per 128-bit lane, so narrow the two halves
+    // with the SSE form to keep the pixels in order.
+    const __m128i r8 = _mm_packus_epi16(_mm256_castsi256_si128(r),
+                                        _mm256_extracti128_si256(r, 1));
+    const __m128i g8 = _mm_packus_epi16(_mm256_castsi256_si128(g),
+                                        _mm256_extracti128_si256(g, 1));
+    const __m128i b8 = _mm_packus_epi16(_mm256_castsi256_si128(b),
+                                        _mm256_extracti128_si256(b, 1));
+
+    const __m128i first = order == PixelOrder::kRGBA ? r8 : b8;
+    const __m128i third = order == PixelOrder::kRGBA ? b8 : r8;
+    const __m128i first_second_lo = _mm_unpacklo_epi8(first, g8);
+    const __m128i first_second_hi = _mm_unpackhi_epi8(first, g8);
+    const __m128i third_alpha_lo = _mm_unpacklo_epi8(third, alpha);
+    const __m128i third_alpha_hi = _mm_unpackhi_epi8(third, alpha);
+    __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(first_second_lo, third_alpha_lo));
+    _mm_storeu_si128(out + 1,
+                     _mm_unpackhi_epi16(first_second_lo, third_alpha_lo));
+    _mm_storeu_si128(out + 2,
+                     _mm_unpacklo_epi16(first_second_hi, third_alpha_hi));
+    _mm_storeu_si128(out + 3,
+                     _mm_unpackhi_epi16(first_second_hi, third_alpha_hi));
+  }
+  RowScalarFrom(y, u, v, dst, x, width, order);
+}
+
+bool CpuHasSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool CpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  // The OS must also save the YMM registers across context switches.
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // FLUTTER_WEBRTC_COLOR_X86
+
+#if defined(FLUTTER_WEBRTC_COLOR_NEON)
+
+void RowNEON(const uint8_t* y,
+             const uint8_t* u,
+             const uint8_t* v,
+             uint8_t* dst,
+             int width,
+             PixelOrder order) {
+  const uint16x4_t y_gain = vdup_n_u16(kYGain);
+  const int16x8_t y_bias = vdupq_n_s16(kYBias);
+  const int16x8_t chroma_offset = vdupq_n_s16(128);
+  const uint8x16_t alpha = vdupq_n_u8(0xff);
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const uint8x8_t u8 = vld1_u8(u + x / 2);
+    const uint8x8_t v8 = vld1_u8(v + x / 2);
+    const uint8x8x2_t u_pairs = vzip_u8(u8, u8);
+    const uint8x8x2_t v_pairs = vzip_u8(v8, v8);
+    const uint8x16_t y16 = vld1q_u8(y + x);
+
+    uint8x8_t r_half[2];
+    uint8x8_t g_half[2];
+    uint8x8_t b_half[2];
+    for (int half = 0; half < 2; ++half) {
+      const uint8x8_t y8 = half == 0 ? vget_low_u8(y16) : vget_high_u8(y16);
+      const uint16x8_t y16 = vmovl_u8(y8);
+      const uint16x8_t y257 = vorrq_u16(vshlq_n_u16(y16, 8), y16);
+      const uint16x8_t luma =
+          vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(y257), y_gain), 16),
+                       vshrn_n_u32(vmull_u16(vget_high_u16(y257), y_gain), 16));
+      const int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(luma), y_bias);
+      const int16x8_t uu = vsubq_s16(
+          vreinterpretq_s16_u16(vmovl_u8(u_pairs.val[half])), chroma_offset);
+      const int16x8_t vv = vsubq_s16(
+          vreinterpretq_s16_u16(vmovl_u8(v_pairs.val[half])), chroma_offset);
+      const int16x8_t r = vqaddq_s16(yy, vmulq_n_s16(vv, kVToR));
+      const int16x8_t g = vqsubq_s16(vqsubq_s16(yy, vmulq_n_s16(uu, kUToG)),
+                                     vmulq_n_s16(vv, kVToG));
+      const int16x8_t b = vqaddq_s16(yy, vmulq_n_s16(uu, kUToB));
+      // Rounding narrow: (value + 32) >> 6, saturated to 0..255.
+      r_half[half] = vqrshrun_n_s16(r, kShift);
+      g_half[half] = vqrshrun_n_s16(g, kShift);
+      b_half[half] = vqrshrun_n_s16(b, kShift);
+    }
+    const uint8x16_t r = vcombine_u8(r_half[0], r_half[1]);
+    const uint8x16_t b = vcombine_u8(b_half[0], b_half[1]);
+    uint8x16x4_t pixels;
+    pixels.val[0] = order == PixelOrder::kRGBA ? r : b;
+    pixels.val[1] = vcombine_u8(g_half[0], g_half[1]);
+    pixels.val[2] = order == PixelOrder::kRGBA ? b : r;
+    pixels.val[3] = alpha;
+    vst4q_u8(dst + x * 4, pixels);
+  }
+  RowScalarFrom(y, u, v, dst, x, width, order);
+}
+
+#endif  // FLUTTER_WEBRTC_COLOR_NEON
+
+bool KernelSupported(ColorKernel kernel) {
+  switch (kernel) {
+#if defined(FLUTTER_WEBRTC_COLOR_X86)
+    case ColorKernel::kAVX2:
+      return CpuHasAVX2();
+    case ColorKernel::kSSE2:
+      return CpuHasSSE2();
+#endif
+#if defined(FLUTTER_WEBRTC_COLOR_NEON)
+    case ColorKernel::kNEON:
+      return true;
+#endif
+    case ColorKernel::kScalar:
+      return true;
+    default:
+      return false;
+  }
+}
+
+RowFunction RowFunctionFor(ColorKernel kernel) {
+  switch (kernel) {
+#if defined(FLUTTER_WEBRTC_COLOR_X86)
+    case ColorKernel::kAVX2:
+      return RowAVX2;
+    case ColorKernel::kSSE2:
+      return RowSSE2;
+#endif
+#if defined(FLUTTER_WEBRTC_COLOR_NEON)
+    case ColorKernel::kNEON:
+      return RowNEON;
+#endif
+    default:
+      return RowScalar;
+  }
+}
+
+ColorKernel DetectKernel() {
+  const ColorKernel candidates[] = {ColorKernel::kAVX2, ColorKernel::kSSE2,
+                                    ColorKernel::kNEON};
+  for (ColorKernel kernel : candidates) {
+    if (KernelSupported(kernel)) {
+      return kernel;
+    }
+  }
+  return ColorKernel::kScalar;
+}
+
+// Per-thread scratch for the sampled rows, the column maps and the box
+// filter's line sums, reused across frames so the scaled paths do not
+// allocate once warmed up.
+struct ConversionScratch {
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+  std::vector<int> columns;
+  std::vector<int> column_ends;
+  std::vector<int> chroma_columns;
+  std::vector<int> chroma_column_ends;
+  std::vector<uint32_t> y_line;
+  std::vector<uint32_t> u_line;
+  std::vector<uint32_t> v_line;
+};
+
+ConversionScratch& Scratch() {
+  static thread_local ConversionScratch scratch;
+  return scratch;
+}
+
+// Maps destination index i of count onto the centre of the matching source
+// range of size extent.
+inline int NearestSample(int i, int count, int extent) {
+  return static_cast<int>((static_cast<int64_t>(2 * i + 1) * extent) /
+                          (2 * static_cast<int64_t>(count)));
+}
+
+// Start of the source range destination index i of count covers in a
+// source of size extent. Consecutive ranges tile the source exactly.
+inline int BoxBegin(int i, int count, int extent) {
+  return static_cast<int>(static_cast<int64_t>(i) * extent / count);
+}
+
+// End of that range; never empty, so upscaled axes repeat samples.
+inline int BoxEnd(int i, int count, int extent) {
+  const int begin = BoxBegin(i, count, extent);
+  const int end = BoxBegin(i + 1, count, extent);
+  return end > begin ? end : begin + 1;
+}
+
+// Sums plane over rotated rows [r0, r1) for every rotated column, as prefix
+// sums: line[c + 1] - line[c] is the sum at rotated column c. Every case
+// reads the plane row by row.
+void BoxLine(const uint8_t* plane,
+             int stride,
+             int width,
+             int height,
+             int rotation,
+             int r0,
+             int r1,
+             std::vector<uint32_t>* line) {
+  const bool transposed = rotation == 90 || rotation == 270;
+  const int columns = transposed ? height : width;
+  line->assign(columns + 1, 0);
+  uint32_t* sums = line->data() + 1;
+  switch (rotation) {
+    case 0:
+    case 180:
+      for (int r = r0; r < r1; ++r) {
+        const int sy = rotation == 0 ? r : height - 1 - r;
+        const uint8_t* src = plane + static_cast<ptrdiff_t>(sy) * stride;
+        if (rotation == 0) {
+          for (int c = 0; c < columns; ++c) {
+            sums[c] += src[c];
+          }
+        } else {
+          for (int c = 0; c < columns; ++c) {
+            sums[c] += src[width - 1 - c];
+          }
+        }
+      }
+      break;
+    case 90:
+    case 270: {
+      // Rotated row r is source column r (90) or width - 1 - r (270).
+      const int sx0 = rotation == 90 ? r0 : width - r1;
+      const int sx1 = rotation == 90 ? r1 : width - r0;
+      for (int c = 0; c < columns; ++c) {
+        const int sy = rotation == 90 ? height - 1 - c : c;
+        const uint8_t* src = plane + static_cast<ptrdiff_t>(sy) * stride;
+        uint32_t sum = 0;
+        for (int sx = sx0; sx < sx1; ++sx) {
+          sum += src[sx];
+        }
+        sums[c] = sum;
+      }
+      break;
+    }
+  }
+  for (int c = 0; c < columns; ++c) {
+    sums[c] += sums[c - 1];
+  }
+}
+
+inline uint8_t BoxAverage(const std::vector<uint32_t>& line,
+                          int c0,
+                          int c1,
+                          uint32_t rows) {
+  const uint32_t area = static_cast<uint32_t>(c1 - c0) * rows;
+  return static_cast<uint8_t>((line[c1] - line[c0] + area / 2) / area);
+}
+
+// Downscaling path: every destination pixel averages the luma of the source
+// area it covers, and every pixel pair the chroma of its combined area, so
+// thumbnails of large frames do not alias the way point sampling would.
+// Sums stay below 2^32 for any frame under 16M pixels per destination pixel.
+void ConvertBox(RowFunction row,
+                const I420Planes& src,
+                int rotation,
+                PixelOrder order,
+                uint8_t* dst,
+                int dst_stride,
+                int dst_width,
+                int dst_height) {
+  const bool transposed = rotation == 90 || rotation == 270;
+  const int rotated_width = transposed ? src.height : src.width;
+  const int rotated_height = transposed ? src.width : src.height;
+  const int chroma_width = (src.width + 1) / 2;
+  const int chroma_height = (src.height + 1) / 2;
+  const int rotated_chroma_width = transposed ? chroma_height : chroma_width;
+  const int rotated_chroma_height = transposed ? chroma_width : chroma_height;
+
+  ConversionScratch& scratch = Scratch();
+  const int pairs = (dst_width + 1) / 2;
+  scratch.y.resize(dst_width);
+  scratch.u.resize(pairs);
+  scratch.v.resize(pairs);
+  scratch.columns.resize(dst_width);
+  scratch.column_ends.resize(dst_width);
+  scratch.chroma_columns.resize(pairs);
+  scratch.chroma_column_ends.resize(pairs);
+  for (int dx = 0; dx < dst_width; ++dx) {
+    scratch.columns[dx] = BoxBegin(dx, dst_width, rotated_width);
+    scratch.column_ends[dx] = BoxEnd(dx, dst_width, rotated_width);
+  }
+  for (int pair = 0; pair < pairs; ++pair) {
+    const int c0 = scratch.columns[pair * 2];
+    const int c1 = scratch.column_ends[std::min(pair * 2 + 1, dst_width - 1)];
+    scratch.chroma_columns[pair] = c0 >> 1;
+    scratch.chroma_column_ends[pair] =
+        std::min((c1 + 1) >> 1, rotated_chroma_width);
+  }
+
+  int last_cr0 = -1;
+  int last_cr1 = -1;
+  for (int dy = 0; dy < dst_height; ++dy) {
+    const int r0 = BoxBegin(dy, dst_height, rotated_height);
+    const int r1 = BoxEnd(dy, dst_height, rotated_height);
+    BoxLine(src.y, src.stride_y, src.width, src.height, rotation, r0, r1,
+            &scratch.y_line);
+    const uint32_t rows = static_cast<uint32_t>(r1 - r0);
+    for (int dx = 0; dx < dst_width; ++dx) {
+      scratch.y[dx] = BoxAverage(scratch.y_line, scratch.columns[dx],
+                                 scratch.column_ends[dx], rows);
+    }
+
+    // The luma rows of a destination row pair share chroma rows, so the
+    // chroma sums are only recomputed when the chroma range moves.
+    const int cr0 = r0 >> 1;
+    const int cr1 = std::min((r1 + 1) >> 1, rotated_chroma_height);
+    if (cr0 != last_cr0 || cr1 != last_cr1) {
+      BoxLine(src.u, src.stride_u, chroma_width, chroma_height, rotation, cr0,
+              cr1, &scratch.u_line);
+      BoxLine(src.v, src.stride_v, chroma_width, chroma_height, rotation, cr0,
+              cr1, &scratch.v_line);
+      const uint32_t chroma_rows = static_cast<uint32_t>(cr1 - cr0);
+      for (int pair = 0; pair < pairs; ++pair) {
+        scratch.u[pair] =
+            BoxAverage(scratch.u_line, scratch.chroma_columns[pair],
+                       scratch.chroma_column_ends[pair], chroma_rows);
+        scratch.v[pair] =
+            BoxAverage(scratch.v_line, scratch.chroma_columns[pair],
+                       scratch.chroma_column_ends[pair], chroma_rows);
+      }
+      last_cr0 = cr0;
+      last_cr1 = cr1;
+    }
+    row(scratch.y.data(), scratch.u.data(), scratch.v.data(),
+        dst + static_cast<ptrdiff_t>(dy) * dst_stride, dst_width, order);
+  }
+}
+
+bool Convert(RowFunction row,
+             const I420Planes& src,
+             int rotation,
+             PixelOrder order,
+             uint8_t* dst,
+             int dst_stride,
+             int dst_width,
+             int dst_height) {
+  if (!src.y || !src.u || !src.v || src.width <= 0 || src.height <= 0 ||
+      !dst || dst_width <= 0 || dst_height <= 0) {
+    return false;
+  }
+  if (rotation != 0 && rotation != 90 && rotation != 180 && rotation != 270) {
+    return false;
+  }
+  if (dst_stride == 0) {
+    dst_stride = dst_width * 4;
+  }
+  if (dst_stride < dst_width * 4) {
+    return false;
+  }
+
+  if (rotation == 0 && dst_width == src.width && dst_height == src.height) {
+    for (int dy = 0; dy < dst_height; ++dy) {
+      row(src.y + static_cast<ptrdiff_t>(dy) * src.stride_y,
+          src.u + static_cast<ptrdiff_t>(dy >> 1) * src.stride_u,
+          src.v + static_cast<ptrdiff_t>(dy >> 1) * src.stride_v,
+          dst + static_cast<ptrdiff_t>(dy) * dst_stride, dst_width, order);
+    }
+    return true;
+  }
+
+  // Size of the source once rotated; destination pixels sample this space.
+  const bool transposed = rotation == 90 || rotation == 270;
+  const int rotated_width = transposed ? src.height : src.width;
+  const int rotated_height = transposed ? src.width : src.height;
+  if (dst_width < rotated_width || dst_height < rotated_height) {
+    ConvertBox(row, src, rotation, order, dst, dst_stride, dst_width,
+               dst_height);
+    return true;
+  }
+
+  ConversionScratch& scratch = Scratch();
+  const size_t chroma_width = static_cast<size_t>(dst_width + 1) / 2;
+  scratch.y.resize(dst_width);
+  scratch.u.resize(chroma_width);
+  scratch.v.resize(chroma_width);
+  scratch.columns.resize(dst_width);
+  for (int dx = 0; dx < dst_width; ++dx) {
+    scratch.columns[dx] = NearestSample(dx, dst_width, rotated_width);
+  }
+
+  for (int dy = 0; dy < dst_height; ++dy) {
+    const int ry = NearestSample(dy, dst_height, rotated_height);
+    // Source position of rotated column c is (x0 + dx * c, y0 + dy * c).
+    int x0 = 0, step_x = 0, y0 = 0, step_y = 0;
+    switch (rotation) {
+      case 0:
+        step_x = 1;
+        y0 = ry;
+        break;
+      case 90:
+        x0 = ry;
+        y0 = src.height - 1;
+        step_y = -1;
+        break;
+      case 180:
+        x0 = src.width - 1;
+        step_x = -1;
+        y0 = src.height - 1 - ry;
+        break;
+      case 270:
+        x0 = src.width - 1 - ry;
+        step_y = 1;
+        break;
+    }
+    for (int dx = 0; dx < dst_width; ++dx) {
+      const int c = scratch.columns[dx];
+      const int sx = x0 + step_x * c;
+      const int sy = y0 + step_y * c;
+      scratch.y[dx] = src.y[static_cast<ptrdiff_t>(sy) * src.stride_y + sx];
+      if ((dx & 1) == 0) {
+        scratch.u[dx >> 1] =
+            src.u[static_cast<ptrdiff_t>(sy >> 1) * src.stride_u + (sx >> 1)];
+        scratch.v[dx >> 1] =
+            src.v[static_cast<ptrdiff_t>(sy >> 1) * src.stride_v + (sx >> 1)];
+      }
+    }
+    row(scratch.y.data(), scratch.u.data(), scratch.v.data(),
+        dst + static_cast<ptrdiff_t>(dy) * dst_stride, dst_width, order);
+  }
+  return true;
+}
+
+}  // namespace
+
+ColorKernel ActiveColorKernel() {
+  static const ColorKernel kernel = DetectKernel();
+  return kernel;
+}
+
+const char* ColorKernelName(ColorKernel kernel) {
+  switch (kernel) {
+    case ColorKernel::kAVX2:
+      return "avx2";
+    case ColorKernel::kSSE2:
+      return "sse2";
+    case ColorKernel::kNEON:
+      return "neon";
+    case ColorKernel::kScalar:
+      return "scalar";
+  }
+  return "unknown";
+}
+
+bool ConvertI420(const I420Planes& src,
+                 int rotation,
+                 PixelOrder order,
+                 uint8_t* dst,
+                 int dst_stride,
+                 int dst_width,
+                 int dst_height) {
+  static const RowFunction row = RowFunctionFor(ActiveColorKernel());
+  return Convert(row, src, rotation, order, dst, dst_stride, dst_width,
+                 dst_height);
+}
+
+bool ConvertI420WithKernel(ColorKernel kernel,
+                           const I420Planes& src,
+                           int rotation,
+                           PixelOrder order,
+                           uint8_t* dst,
+                           int dst_stride,
+                           int dst_width,
+                           int dst_height) {
+  const RowFunction row = KernelSupported(kernel)
+                              ? RowFunctionFor(kernel)
+                              : RowFunctionFor(ColorKernel::kScalar);
+  return Convert(row, src, rotation, order, dst, dst_stride, dst_width,
+                 dst_height);
+}
+
+}  // namespace flutter_webrtc_plugin
@@ -1,5 +1,15 @@
 #include "flutter_common.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class MethodCallProxyImpl : public MethodCallProxy {
  public:
   explicit MethodCallProxyImpl(const MethodCall& method_call)
@@ -65,57 +75,366 @@ std::unique_ptr<MethodResultProxy> MethodResultProxy::Create(
   return std::make_unique<MethodResultProxyImpl>(std::move(method_result));
 }
 
+namespace {
+
+struct PendingEvent {
+  EncodableValue value;
+  bool cache_event = true;
+};
+
+// Bounded multi-producer queue (Vyukov's sequence-numbered ring). Producers
+// are WebRTC threads and never take a lock; the dispatcher thread is the
+// only consumer.
+class EventRing {
+ public:
+  explicit EventRing(size_t capacity)
+      : cells_(capacity), mask_(capacity - 1) {
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool TryPush(PendingEvent&& event) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          cell.event = std::move(event);
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool TryPop(PendingEvent* event) {
+    Cell& cell = cells_[dequeue_pos_ & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+      return false;
+    }
+    *event = std::move(cell.event);
+    cell.event.value = EncodableValue();
+    cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    ++dequeue_pos_;
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    PendingEvent event;
+  };
+
+  std::vector<Cell> cells_;
+  const size_t mask_;
+  std::atomic<size_t> enqueue_pos_{0};
+  size_t dequeue_pos_ = 0;
+};
+
+// Holds events that arrive before Dart listens. Channels Dart never listens
+// to (per data channel ones, for instance) would otherwise grow forever, so
+// the oldest events are dropped past this.
+const size_t kMaxPreListenEvents = 256;
+
+EventChannelProxy::PlatformTaskRunner& PlatformRunner() {
+  static EventChannelProxy::PlatformTaskRunner runner;
+  return runner;
+}
+
+// Events queued for delivery, plus the sink they go to. Shared between the
+// proxy, the stream handler, the dispatcher and platform-thread tasks, so
+// work that is already scheduled can still run after the proxy is gone.
+struct EventChannelState
+    : public std::enable_shared_from_this<EventChannelState> {
+  // Guards sink and event_queue. The sink is used from the platform thread
+  // (listen/cancel) and from whichever thread delivers events.
+  std::mutex mutex;
+  std::unique_ptr<EventSink> sink;
+  std::deque<PendingEvent> event_queue;
+  std::atomic<bool> on_listen_called{false};
+  std::atomic<uint64_t> dropped_events{0};
+
+  // Batching only.
+  std::unique_ptr<EventRing> ring;
+  std::chrono::milliseconds batch_interval{0};
+  std::atomic<bool> flush_scheduled{false};
+  // An immediate drain was requested because the ring was full.
+  std::atomic<bool> drain_requested{false};
+  // Overflow::kKeep only: events that found the ring full, in order. While
+  // any are waiting, later events queue behind them rather than in the ring.
+  bool keep_overflow = false;
+  std::mutex overflow_mutex;
+  std::deque<PendingEvent> overflow;
+  std::atomic<bool> overflowing{false};
+
+  void Deliver(std::vector<PendingEvent> events) {
+    const EventChannelProxy::PlatformTaskRunner& runner = PlatformRunner();
+    if (!runner) {
+      DeliverNow(std::move(events));
+      return;
+    }
+    auto self = shared_from_this();
+    auto shared_events =
+        std::make_shared<std::vector<PendingEvent>>(std::move(events));
+    runner([self, shared_events] {
+      self->DeliverNow(std::move(*shared_events));
+    });
+  }
+
+  void DeliverNow(std::vector<PendingEvent> events) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (on_listen_called.load(std::memory_order_acquire)) {
+      if (events.size() == 1) {
+        sink->Success(events.front().value);
+        return;
+      }
+      EncodableList batch;
+      batch.reserve(events.size());
+      for (auto& event : events) {
+        batch.push_back(std::move(event.value));
+      }
+      sink->Success(EncodableValue(std::move(batch)));
+      return;
+    }
+    for (auto& event : events) {
+      if (!event.cache_event) {
+        continue;
+      }
+      if (event_queue.size() >= kMaxPreListenEvents) {
+        event_queue.pop_front();
+        dropped_events.fetch_add(1, std::memory_order_relaxed);
+      }
+      event_queue.push_back(std::move(event));
+    }
+  }
+
+  // Platform thread, from the stream handler.
+  void Listen(std::unique_ptr<EventSink> events) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sink = std::move(events);
+    for (auto& event : event_queue) {
+      sink->Success(event.value);
+    }
+    event_queue.clear();
+    on_listen_called.store(true, std::memory_order_release);
+  }
+
+  void Cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    on_listen_called.store(false, std::memory_order_release);
+  }
+
+  // Producer side of Overflow::kKeep, once the ring was found full or
+  // events are already waiting in overflow.
+  void KeepOverflow(PendingEvent&& event) {
+    std::lock_guard<std::mutex> lock(overflow_mutex);
+    // A flush may have emptied both since the caller looked.
+    if (overflow.empty() && ring->TryPush(std::move(event))) {
+      return;
+    }
+    overflow.push_back(std::move(event));
+    overflowing.store(true, std::memory_order_release);
+  }
+
+  // Dispatcher thread only.
+  void Flush() {
+    // Cleared first so an event pushed while draining schedules another
+    // flush instead of waiting for one that already ran.
+    flush_scheduled.store(false, std::memory_order_release);
+    drain_requested.store(false, std::memory_order_release);
+    std::vector<PendingEvent> events;
+    PendingEvent event;
+    while (ring->TryPop(&event)) {
+      events.push_back(std::move(event));
+    }
+    if (overflowing.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(overflow_mutex);
+      // Anything that reached the ring before its thread's later events
+      // were kept is visible now, and must go first.
+      while (ring->TryPop(&event)) {
+        events.push_back(std::move(event));
+      }
+      for (auto& kept : overflow) {
+        events.push_back(std::move(kept));
+      }
+      overflow.clear();
+      overflowing.store(false, std::memory_order_release);
+    }
+    if (!events.empty()) {
+      Deliver(std::move(events));
+    }
+  }
+};
+
+// One thread that flushes every batching channel when its interval is due.
+// Never destroyed, like the channels' own lifetime in the plugin.
+class EventBatchDispatcher {
+ public:
+  static EventBatchDispatcher& Shared() {
+    static EventBatchDispatcher* dispatcher = new EventBatchDispatcher();
+    return *dispatcher;
+  }
+
+  void Schedule(std::weak_ptr<EventChannelState> state,
+                std::chrono::steady_clock::time_point due) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.emplace(due, std::move(state));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  EventBatchDispatcher() {
+    std::thread(&EventBatchDispatcher::Run, this).detach();
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      if (pending_.empty()) {
+        cv_.wait(lock);
+        continue;
+      }
+      auto next = pending_.begin();
+      if (cv_.wait_until(lock, next->first) != std::cv_status::timeout &&
+          std::chrono::steady_clock::now() < pending_.begin()->first) {
+        continue;
+      }
+      next = pending_.begin();
+      std::shared_ptr<EventChannelState> state = next->second.lock();
+      pending_.erase(next);
+      lock.unlock();
+      if (state) {
+        state->Flush();
+      }
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::multimap<std::chrono::steady_clock::time_point,
+                std::weak_ptr<EventChannelState>>
+      pending_;
+};
+
+const size_t kEventRingCapacity = 1024;
+
+}  // namespace
+
 class EventChannelProxyImpl : public EventChannelProxy {
  public:
   EventChannelProxyImpl(BinaryMessenger* messenger,
-                        const std::string& channelName)
+                        const std::string& channelName,
+                        int batch_interval_ms,
+                        Overflow overflow)
       : channel_(std::make_unique<EventChannel>(
             messenger,
             channelName,
-            &flutter::StandardMethodCodec::GetInstance())) {
+            &flutter::StandardMethodCodec::GetInstance())),
+        channel_name_(channelName),
+        state_(std::make_shared<EventChannelState>()) {
+    if (batch_interval_ms > 0) {
+      state_->ring = std::make_unique<EventRing>(kEventRingCapacity);
+      state_->batch_interval = std::chrono::milliseconds(batch_interval_ms);
+      state_->keep_overflow = overflow == Overflow::kKeep;
+    }
+    std::shared_ptr<EventChannelState> state = state_;
     auto handler = std::make_unique<
         flutter::StreamHandlerFunctions<EncodableValue>>(
-        [&](const EncodableValue* arguments,
-            std::unique_ptr<flutter::EventSink<EncodableValue>>&& events)
+        [state](const EncodableValue* arguments,
+                std::unique_ptr<flutter::EventSink<EncodableValue>>&& events)
             -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
-          sink_ = std::move(events);
-          for (auto& event : event_queue_) {
-            sink_->Success(event);
-          }
-          event_queue_.clear();
-          on_listen_called_ = true;
+          state->Listen(std::move(events));
           return nullptr;
         },
-        [&](const EncodableValue* arguments)
+        [state](const EncodableValue* arguments)
             -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
-          on_listen_called_ = false;
+          state->Cancel();
           return nullptr;
         });
 
     channel_->SetStreamHandler(std::move(handler));
   }
 
-  virtual ~EventChannelProxyImpl() {}
+  virtual ~EventChannelProxyImpl() {
+    const uint64_t dropped = dropped_events();
+    if (dropped > 0) {
+      std::cout << "EventChannel " << channel_name_ << " dropped " << dropped
+                << " events" << std::endl;
+    }
+  }
 
   void Success(const EncodableValue& event, bool cache_event = true) override {
-    if (on_listen_called_) {
-      sink_->Success(event);
-    } else {
-      if (cache_event) {
-        event_queue_.push_back(event);
+    if (!state_->ring) {
+      std::vector<PendingEvent> events;
+      events.push_back(PendingEvent{event, cache_event});
+      state_->Deliver(std::move(events));
+      return;
+    }
+    PendingEvent pending{event, cache_event};
+    if (state_->overflowing.load(std::memory_order_acquire) ||
+        !state_->ring->TryPush(std::move(pending))) {
+      // Full: the dispatcher has stalled. Keep or drop the event rather than
+      // hold up the WebRTC thread, and ask once for an immediate drain.
+      if (state_->keep_overflow) {
+        state_->KeepOverflow(std::move(pending));
+      } else {
+        state_->dropped_events.fetch_add(1, std::memory_order_relaxed);
       }
+      if (!state_->drain_requested.exchange(true,
+                                            std::memory_order_acq_rel)) {
+        EventBatchDispatcher::Shared().Schedule(
+            state_, std::chrono::steady_clock::now());
+      }
+      return;
+    }
+    if (!state_->flush_scheduled.exchange(true, std::memory_order_acq_rel)) {
+      EventBatchDispatcher::Shared().Schedule(
+          state_, std::chrono::steady_clock::now() + state_->batch_interval);
     }
   }
 
+  uint64_t dropped_events() const override {
+    return state_->dropped_events.load(std::memory_order_relaxed);
+  }
+
  private:
   std::unique_ptr<EventChannel> channel_;
-  std::unique_ptr<EventSink> sink_;
-  std::list<EncodableValue> event_queue_;
-  bool on_listen_called_ = false;
+  std::string channel_name_;
+  std::shared_ptr<EventChannelState> state_;
 };
 
+void EventChannelProxy::SetPlatformTaskRunner(PlatformTaskRunner runner) {
+  PlatformRunner() = std::move(runner);
+}
+
+const EventChannelProxy::PlatformTaskRunner&
+EventChannelProxy::platform_task_runner() {
+  return PlatformRunner();
+}
+
 std::unique_ptr<EventChannelProxy> EventChannelProxy::Create(
     BinaryMessenger* messenger,
     const std::string& channelName) {
-  return std::make_unique<EventChannelProxyImpl>(messenger, channelName);
+  return std::make_unique<EventChannelProxyImpl>(messenger, channelName, 0,
+                                                 Overflow::kDrop);
+}
+
+std::unique_ptr<EventChannelProxy> EventChannelProxy::Create(
+    BinaryMessenger* messenger,
+    const std::string& channelName,
+    int batch_interval_ms,
+    Overflow overflow) {
+  return std::make_unique<EventChannelProxyImpl>(messenger, channelName,
+                                                 batch_interval_ms, overflow);
 }
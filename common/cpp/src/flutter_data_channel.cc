@@ -73,13 +73,15 @@ void FlutterDataChannel::DataChannelSend(
     const std::string& type,
     const EncodableValue& data,
     std::unique_ptr<MethodResultProxy> result) {
+  // Send from the decoded argument in place; payloads can be megabytes.
   bool is_binary = type == "binary";
-  if (is_binary && TypeIs<std::vector<uint8_t>>(data)) {
-    std::vector<uint8_t> buffer = GetValue<std::vector<uint8_t>>(data);
-    data_channel->Send(buffer.data(), static_cast<uint32_t>(buffer.size()),
+  const std::vector<uint8_t>* buffer =
+      is_binary ? std::get_if<std::vector<uint8_t>>(&data) : nullptr;
+  if (buffer) {
+    data_channel->Send(buffer->data(), static_cast<uint32_t>(buffer->size()),
                        true);
   } else {
-    std::string str = GetValue<std::string>(data);
+    const std::string& str = GetValue<std::string>(data);
     data_channel->Send(reinterpret_cast<const uint8_t*>(str.c_str()),
                        static_cast<uint32_t>(str.length()), false);
   }
@@ -5,6 +5,9 @@
 #include "flutter_frame_capturer.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "flutter_color_conversion.h"
 #include "svpng.hpp"
 
 namespace flutter_webrtc_plugin {
@@ -15,35 +18,36 @@ FlutterFrameCapturer::FlutterFrameCapturer(RTCVideoTrack* track,
   path_ = path;
 }
 
+// How long CaptureFrame waits for the track to deliver a frame.
+const std::chrono::seconds kFrameTimeout(5);
+
 void FlutterFrameCapturer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (frame_ != nullptr) {
     return;
   }
 
   frame_ = frame.get()->Copy();
-  catch_frame_ = true;
+  frame_received_.notify_all();
 }
 
 void FlutterFrameCapturer::CaptureFrame(
     std::unique_ptr<MethodResultProxy> result) {
-  mutex_.lock();
-  // Here init catch_frame_ flag
-  catch_frame_ = false;
-
   track_->AddRenderer(this);
-  // Here waiting for catch_frame_ is set to true
-  while(!catch_frame_){}
-  // Here unlock the mutex
-  mutex_.unlock();
-
-  mutex_.lock();
+  bool received;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    received = frame_received_.wait_for(
+        lock, kFrameTimeout, [this] { return frame_ != nullptr; });
+  }
   track_->RemoveRenderer(this);
 
-  bool success = SaveFrame();
-  mutex_.unlock();
-
   std::shared_ptr<MethodResultProxy> result_ptr(result.release());
-  if (success) {
+  if (!received) {
+    result_ptr->Error("1", "No frame received from the track");
+    return;
+  }
+  if (SaveFrame()) {
     result_ptr->Success();
   } else {
     result_ptr->Error("1", "Cannot save the frame as .png file");
@@ -58,17 +62,24 @@ bool FlutterFrameCapturer::SaveFrame() {
   int width = frame_.get()->width();
   int height = frame_.get()->height();
   int bytes_per_pixel = 4;
-  uint8_t* pixels = new uint8_t[width * height * bytes_per_pixel];
-
-  frame_.get()->ConvertToARGB(RTCVideoFrame::Type::kABGR, pixels,
-                              /* unused */ -1, width, height);
+  std::vector<uint8_t> pixels(size_t(width) * size_t(height) *
+                              bytes_per_pixel);
+
+  const I420Planes planes = {frame_->DataY(),   frame_->DataU(),
+                             frame_->DataV(),   frame_->StrideY(),
+                             frame_->StrideU(), frame_->StrideV(),
+                             width,             height};
+  if (!ConvertI420(planes, 0, PixelOrder::kRGBA, pixels.data(), 0, width,
+                   height)) {
+    return false;
+  }
 
   FILE* file = fopen(path_.c_str(), "wb");
   if (!file) {
     return false;
   }
 
-  svpng(file, width, height, pixels, 1);
+  svpng(file, width, height, pixels.data(), 1);
   fclose(file);
   return true;
 }
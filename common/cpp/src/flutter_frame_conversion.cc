@@ -0,0 +1,200 @@
+#include "flutter_frame_conversion.h"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace flutter_webrtc_plugin {
+
+FrameConversionPool& FrameConversionPool::Shared() {
+  static FrameConversionPool pool;
+  return pool;
+}
+
+FrameConversionPool::FrameConversionPool() {
+  unsigned int cores = std::thread::hardware_concurrency();
+  unsigned int count = std::min(4u, std::max(1u, cores / 2));
+  for (unsigned int i = 0; i < count; ++i) {
+    workers_.emplace_back(&FrameConversionPool::Run, this);
+  }
+}
+
+FrameConversionPool::~FrameConversionPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void FrameConversionPool::Post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      return;
+    }
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void FrameConversionPool::Run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+namespace {
+
+// A few buffers per size cover the three slots of a renderer plus a layer
+// switch in flight; the byte cap keeps idle memory bounded.
+const size_t kMaxCachedPerBucket = 4;
+const size_t kMaxCachedBytes = 96 * 1024 * 1024;
+const size_t kMinBucket = 64 * 1024;
+
+size_t BucketCapacity(size_t size) {
+  if (size <= kMinBucket) {
+    return kMinBucket;
+  }
+  size_t power = kMinBucket;
+  while (power * 2 < size) {
+    power *= 2;
+  }
+  // Quarter steps between power and 2 * power.
+  const size_t step = power / 4;
+  return power + ((size - power + step - 1) / step) * step;
+}
+
+#if defined(__linux__)
+// Frames from 720p up get their own page mapping with transparent huge pages
+// requested: converting and uploading a 4K frame then walks 16 TLB entries
+// instead of 8000. Smaller buffers stay on the heap.
+const size_t kMappedThreshold = 2 * 1024 * 1024;
+// Huge pages only back 2 MiB aligned ranges, so mappings start on that
+// boundary and cover whole huge pages.
+const size_t kHugePageSize = 2 * 1024 * 1024;
+
+size_t MappedLength(size_t capacity) {
+  return (capacity + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+#endif
+
+}  // namespace
+
+uint8_t* PixelBufferPool::Allocate(size_t capacity) {
+#if defined(__linux__)
+  if (capacity >= kMappedThreshold) {
+    // mmap only guarantees page alignment: map a huge page more than needed
+    // and unmap the slack on both sides of the aligned range.
+    const size_t length = MappedLength(capacity);
+    void* mapping = mmap(nullptr, length + kHugePageSize,
+                         PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+    if (mapping != MAP_FAILED) {
+      uint8_t* start = static_cast<uint8_t*>(mapping);
+      uint8_t* data = reinterpret_cast<uint8_t*>(
+          (reinterpret_cast<uintptr_t>(start) + kHugePageSize - 1) &
+          ~static_cast<uintptr_t>(kHugePageSize - 1));
+      if (data > start) {
+        munmap(start, data - start);
+      }
+      const size_t tail = (start + length + kHugePageSize) - (data + length);
+      if (tail > 0) {
+        munmap(data + length, tail);
+      }
+#if defined(MADV_HUGEPAGE)
+      madvise(data, length, MADV_HUGEPAGE);
+#endif
+      std::lock_guard<std::mutex> lock(mutex_);
+      mapped_.insert(data);
+      return data;
+    }
+    // Fall back to the heap, e.g. when the mapping count limit is reached.
+  }
+#endif
+  return static_cast<uint8_t*>(
+      ::operator new(capacity, std::align_val_t(kAlignment)));
+}
+
+void PixelBufferPool::Free(uint8_t* data, size_t capacity) {
+#if defined(__linux__)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (mapped_.erase(data) != 0) {
+      munmap(data, MappedLength(capacity));
+      return;
+    }
+  }
+#endif
+  ::operator delete(data, std::align_val_t(kAlignment));
+}
+
+PixelBufferPool& PixelBufferPool::Shared() {
+  static PixelBufferPool* pool = new PixelBufferPool();
+  return *pool;
+}
+
+uint8_t* PixelBufferPool::Acquire(size_t size, size_t* capacity) {
+  const size_t bucket = BucketCapacity(size);
+  *capacity = bucket;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_.find(bucket);
+    if (it != free_.end() && !it->second.empty()) {
+      uint8_t* data = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= bucket;
+      return data;
+    }
+  }
+  return Allocate(bucket);
+}
+
+void PixelBufferPool::Release(uint8_t* data, size_t capacity) {
+  if (!data) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint8_t*>& bucket = free_[capacity];
+    if (bucket.size() < kMaxCachedPerBucket &&
+        cached_bytes_ + capacity <= kMaxCachedBytes) {
+      bucket.push_back(data);
+      cached_bytes_ += capacity;
+      return;
+    }
+  }
+  Free(data, capacity);
+}
+
+void PixelBufferPool::Trim() {
+  std::map<size_t, std::vector<uint8_t*>> free;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free.swap(free_);
+    cached_bytes_ = 0;
+  }
+  for (auto& bucket : free) {
+    for (uint8_t* data : bucket.second) {
+      Free(data, bucket.first);
+    }
+  }
+}
+
+}  // namespace flutter_webrtc_plugin
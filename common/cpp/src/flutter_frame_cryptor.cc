@@ -46,66 +46,45 @@ void FlutterFrameCryptorObserver::OnFrameCryptionStateChanged(
   event_channel_->Success(EncodableValue(params));
 }
 
-bool FlutterFrameCryptor::HandleFrameCryptorMethodCall(
-    const MethodCallProxy& method_call,
-    std::unique_ptr<MethodResultProxy> result,
-    std::unique_ptr<MethodResultProxy> *outResult) {
-  const std::string& method_name = method_call.method_name();
-  if (!method_call.arguments()) {
-    result->Error("Bad Arguments", "Null arguments received");
-    return true;
-  }
-  const EncodableMap params = GetValue<EncodableMap>(*method_call.arguments());
-
-  if (method_name == "frameCryptorFactoryCreateFrameCryptor") {
-    FrameCryptorFactoryCreateFrameCryptor(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorSetKeyIndex") {
-    FrameCryptorSetKeyIndex(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorGetKeyIndex") {
-    FrameCryptorGetKeyIndex(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorSetEnabled") {
-    FrameCryptorSetEnabled(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorGetEnabled") {
-    FrameCryptorGetEnabled(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorDispose") {
-    FrameCryptorDispose(params, std::move(result));
-    return true;
-  } else if (method_name == "frameCryptorFactoryCreateKeyProvider") {
-    FrameCryptorFactoryCreateKeyProvider(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderSetSharedKey") {
-    KeyProviderSetSharedKey(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderRatchetSharedKey") {
-    KeyProviderRatchetSharedKey(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderExportSharedKey") {
-    KeyProviderExportSharedKey(params, std::move(result));
-    return true;
-  }else if (method_name == "keyProviderSetKey") {
-    KeyProviderSetKey(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderRatchetKey") {
-    KeyProviderRatchetKey(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderExportKey") {
-    KeyProviderExportKey(params, std::move(result));
-    return true;
-  }  else if (method_name == "keyProviderSetSifTrailer") {
-    KeyProviderSetSifTrailer(params, std::move(result));
-    return true;
-  } else if (method_name == "keyProviderDispose") {
-    KeyProviderDispose(params, std::move(result));
-    return true;
-  }
-  
-  *outResult = std::move(result);
-  return false;
+void FlutterFrameCryptor::RegisterFrameCryptorMethods(
+    MethodHandlerTable* table) {
+  typedef void (FlutterFrameCryptor::*Handler)(
+      const EncodableMap& constraints,
+      std::unique_ptr<MethodResultProxy> result);
+  // Every frame cryptor method takes a map of arguments.
+  auto add = [this, table](const char* name, Handler handler) {
+    table->Register(name, [this, handler](
+                              const MethodCallProxy& method_call,
+                              std::unique_ptr<MethodResultProxy> result) {
+      if (!method_call.arguments()) {
+        result->Error("Bad Arguments", "Null arguments received");
+        return;
+      }
+      const EncodableMap& params =
+          GetValue<EncodableMap>(*method_call.arguments());
+      (this->*handler)(params, std::move(result));
+    });
+  };
+  add("frameCryptorFactoryCreateFrameCryptor",
+      &FlutterFrameCryptor::FrameCryptorFactoryCreateFrameCryptor);
+  add("frameCryptorSetKeyIndex", &FlutterFrameCryptor::FrameCryptorSetKeyIndex);
+  add("frameCryptorGetKeyIndex", &FlutterFrameCryptor::FrameCryptorGetKeyIndex);
+  add("frameCryptorSetEnabled", &FlutterFrameCryptor::FrameCryptorSetEnabled);
+  add("frameCryptorGetEnabled", &FlutterFrameCryptor::FrameCryptorGetEnabled);
+  add("frameCryptorDispose", &FlutterFrameCryptor::FrameCryptorDispose);
+  add("frameCryptorFactoryCreateKeyProvider",
+      &FlutterFrameCryptor::FrameCryptorFactoryCreateKeyProvider);
+  add("keyProviderSetSharedKey", &FlutterFrameCryptor::KeyProviderSetSharedKey);
+  add("keyProviderRatchetSharedKey",
+      &FlutterFrameCryptor::KeyProviderRatchetSharedKey);
+  add("keyProviderExportSharedKey",
+      &FlutterFrameCryptor::KeyProviderExportSharedKey);
+  add("keyProviderSetKey", &FlutterFrameCryptor::KeyProviderSetKey);
+  add("keyProviderRatchetKey", &FlutterFrameCryptor::KeyProviderRatchetKey);
+  add("keyProviderExportKey", &FlutterFrameCryptor::KeyProviderExportKey);
+  add("keyProviderSetSifTrailer",
+      &FlutterFrameCryptor::KeyProviderSetSifTrailer);
+  add("keyProviderDispose", &FlutterFrameCryptor::KeyProviderDispose);
 }
 
 void FlutterFrameCryptor::FrameCryptorFactoryCreateFrameCryptor(
@@ -311,7 +290,7 @@ void FlutterFrameCryptor::FrameCryptorFactoryCreateKeyProvider(
   libwebrtc::KeyProviderOptions options;
   
 
-  auto keyProviderOptions = findMap(constraints, "keyProviderOptions");
+  const auto& keyProviderOptions = findMap(constraints, "keyProviderOptions");
   if (keyProviderOptions == EncodableMap()) {
     result->Error("FrameCryptorFactoryCreateKeyProviderFailed", "keyProviderOptions is null");
     return;
@@ -321,12 +300,12 @@ void FlutterFrameCryptor::FrameCryptorFactoryCreateKeyProvider(
   options.shared_key = sharedKey;
 
 
-  auto uncryptedMagicBytes = findVector(keyProviderOptions, "uncryptedMagicBytes");
+  const auto& uncryptedMagicBytes = findVector(keyProviderOptions, "uncryptedMagicBytes");
   if (uncryptedMagicBytes.size() != 0) {
     options.uncrypted_magic_bytes = uncryptedMagicBytes;
   }
 
-  auto ratchetSalt = findVector(keyProviderOptions, "ratchetSalt");
+  const auto& ratchetSalt = findVector(keyProviderOptions, "ratchetSalt");
   if (ratchetSalt.size() == 0) {
     result->Error("FrameCryptorFactoryCreateKeyProviderFailed",
                   "ratchetSalt is null");
@@ -380,7 +359,7 @@ void FlutterFrameCryptor::KeyProviderSetSharedKey(const EncodableMap& constraint
     return;
   }
 
-  auto key = findVector(constraints, "key");
+  const auto& key = findVector(constraints, "key");
   if (key.size() == 0) {
     result->Error("KeyProviderSetSharedKeyFailed", "key is null");
     return;
@@ -500,7 +479,7 @@ void FlutterFrameCryptor::KeyProviderSetSifTrailer(const EncodableMap& constrain
     return;
   }
 
-  auto sifTrailer = findVector(constraints, "sifTrailer");
+  const auto& sifTrailer = findVector(constraints, "sifTrailer");
   if (sifTrailer.size() == 0) {
     result->Error("KeyProviderSetSifTrailerFailed", "sifTrailer is null");
     return;
@@ -527,7 +506,7 @@ void FlutterFrameCryptor::KeyProviderSetKey(
     return;
   }
 
-  auto key = findVector(constraints, "key");
+  const auto& key = findVector(constraints, "key");
   if (key.size() == 0) {
     result->Error("KeyProviderSetKeyFailed", "key is null");
     return;
@@ -69,10 +69,10 @@ void addDefaultAudioConstraints(
 std::string getSourceIdConstraint(const EncodableMap& mediaConstraints) {
   auto it = mediaConstraints.find(EncodableValue("optional"));
   if (it != mediaConstraints.end() && TypeIs<EncodableList>(it->second)) {
-    EncodableList optional = GetValue<EncodableList>(it->second);
+    const EncodableList& optional = GetValue<EncodableList>(it->second);
     for (size_t i = 0, size = optional.size(); i < size; i++) {
       if (TypeIs<EncodableMap>(optional[i])) {
-        EncodableMap option = GetValue<EncodableMap>(optional[i]);
+        const EncodableMap& option = GetValue<EncodableMap>(optional[i]);
         auto it2 = option.find(EncodableValue("sourceId"));
         if (it2 != option.end() && TypeIs<std::string>(it2->second)) {
           return GetValue<std::string>(it2->second);
@@ -109,7 +109,7 @@ void FlutterMediaStream::GetUserAudio(const EncodableMap& constraints,
       deviceId = "";
     }
     if (TypeIs<EncodableMap>(audio)) {
-      EncodableMap localMap = GetValue<EncodableMap>(audio);
+      const EncodableMap& localMap = GetValue<EncodableMap>(audio);
       sourceId = getSourceIdConstraint(localMap);
       deviceId = getDeviceIdConstraint(localMap);
       audioConstraints = base_->ParseMediaConstraints(localMap);
@@ -203,7 +203,7 @@ EncodableValue getConstrainInt(const EncodableMap& constraints,
     }
 
     if (TypeIs<EncodableMap>(it->second)) {
-      EncodableMap innerMap = GetValue<EncodableMap>(it->second);
+      const EncodableMap& innerMap = GetValue<EncodableMap>(it->second);
       auto it2 = innerMap.find(EncodableValue("ideal"));
       if (it2 != innerMap.end() && TypeIs<int>(it2->second)) {
         return it2->second;
@@ -0,0 +1,249 @@
+#include "flutter_method_executor.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace flutter_webrtc_plugin {
+
+namespace {
+
+// Keeps a method call alive after the engine's MethodCall is gone.
+class OwnedMethodCallProxy : public MethodCallProxy {
+ public:
+  explicit OwnedMethodCallProxy(const MethodCallProxy& method_call)
+      : method_name_(method_call.method_name()) {
+    if (method_call.arguments()) {
+      arguments_ = std::make_unique<EncodableValue>(*method_call.arguments());
+    }
+  }
+
+  const std::string& method_name() const override { return method_name_; }
+
+  const EncodableValue* arguments() const override { return arguments_.get(); }
+
+ private:
+  std::string method_name_;
+  std::unique_ptr<EncodableValue> arguments_;
+};
+
+// Answers directly when called on the platform thread and posts the answer
+// there otherwise. Handlers often answer from WebRTC threads, so this also
+// covers calls that themselves ran on the platform thread.
+class PlatformThreadMethodResult : public MethodResultProxy {
+ public:
+  PlatformThreadMethodResult(std::unique_ptr<MethodResultProxy> result,
+                             EventChannelProxy::PlatformTaskRunner runner,
+                             std::thread::id platform_thread)
+      : result_(std::move(result)),
+        runner_(std::move(runner)),
+        platform_thread_(platform_thread) {}
+
+  void Success() override {
+    if (OnPlatformThread()) {
+      result_->Success();
+      return;
+    }
+    Post([](MethodResultProxy* result) { result->Success(); });
+  }
+
+  void Success(const EncodableValue& value) override {
+    if (OnPlatformThread()) {
+      result_->Success(value);
+      return;
+    }
+    Post([value](MethodResultProxy* result) { result->Success(value); });
+  }
+
+  void Error(const std::string& error_code,
+             const std::string& error_message,
+             const EncodableValue& error_details) override {
+    if (OnPlatformThread()) {
+      result_->Error(error_code, error_message, error_details);
+      return;
+    }
+    Post([error_code, error_message, error_details](MethodResultProxy* result) {
+      result->Error(error_code, error_message, error_details);
+    });
+  }
+
+  void Error(const std::string& error_code,
+             const std::string& error_message) override {
+    if (OnPlatformThread()) {
+      result_->Error(error_code, error_message);
+      return;
+    }
+    Post([error_code, error_message](MethodResultProxy* result) {
+      result->Error(error_code, error_message);
+    });
+  }
+
+  void NotImplemented() override {
+    if (OnPlatformThread()) {
+      result_->NotImplemented();
+      return;
+    }
+    Post([](MethodResultProxy* result) { result->NotImplemented(); });
+  }
+
+ private:
+  bool OnPlatformThread() const {
+    return std::this_thread::get_id() == platform_thread_;
+  }
+
+  void Post(std::function<void(MethodResultProxy*)> reply) {
+    std::shared_ptr<MethodResultProxy> result = result_;
+    runner_([result, reply] { reply(result.get()); });
+  }
+
+  std::shared_ptr<MethodResultProxy> result_;
+  EventChannelProxy::PlatformTaskRunner runner_;
+  std::thread::id platform_thread_;
+};
+
+struct PendingCall {
+  std::unique_ptr<MethodCallProxy> method_call;
+  std::unique_ptr<MethodResultProxy> result;
+  MethodThread thread;
+};
+
+void RunNow(const MethodHandlerTable& methods,
+            const MethodCallProxy& method_call,
+            std::unique_ptr<MethodResultProxy> result) {
+  if (!methods.Dispatch(method_call, &result)) {
+    result->NotImplemented();
+  }
+}
+
+// Answers a call that was still queued when the executor stopped.
+void ReplyDisposed(PendingCall* call) {
+  call->result->Error("disposed", call->method_call->method_name() +
+                                      "() was not run: the plugin is gone");
+}
+
+}  // namespace
+
+struct MethodCallExecutor::State
+    : public std::enable_shared_from_this<MethodCallExecutor::State> {
+  const MethodHandlerTable* methods;
+  // Copied at construction; the runner is installed at registration.
+  EventChannelProxy::PlatformTaskRunner runner;
+
+  // Platform thread only.
+  std::deque<PendingCall> queue;
+  // A kWorker call has been handed to the worker and not finished yet.
+  bool busy = false;
+
+  // Guards the handoff to the worker thread.
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::unique_ptr<PendingCall> worker_call;
+  bool stopped = false;
+  std::thread worker;
+
+  bool IsStopped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stopped;
+  }
+
+  // Answers every queued call with a "disposed" error. Platform thread only.
+  void DrainQueue() {
+    while (!queue.empty()) {
+      PendingCall call = std::move(queue.front());
+      queue.pop_front();
+      ReplyDisposed(&call);
+    }
+  }
+
+  // Runs queued calls until the queue is empty or a kWorker call is handed
+  // off; the worker calls back here when that one is done.
+  void Pump() {
+    if (IsStopped()) {
+      DrainQueue();
+      return;
+    }
+    while (!busy && !queue.empty()) {
+      PendingCall next = std::move(queue.front());
+      queue.pop_front();
+      if (next.thread == MethodThread::kPlatform) {
+        RunNow(*methods, *next.method_call, std::move(next.result));
+        continue;
+      }
+      busy = true;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        worker_call = std::make_unique<PendingCall>(std::move(next));
+        if (!worker.joinable()) {
+          worker = std::thread(&State::RunWorker, this);
+        }
+      }
+      cv.notify_one();
+    }
+  }
+
+  void RunWorker() {
+    for (;;) {
+      std::unique_ptr<PendingCall> call;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return stopped || worker_call; });
+        if (!worker_call) {
+          return;
+        }
+        call = std::move(worker_call);
+      }
+      RunNow(*methods, *call->method_call, std::move(call->result));
+      call.reset();
+      auto self = shared_from_this();
+      runner([self] {
+        self->busy = false;
+        self->Pump();
+      });
+    }
+  }
+};
+
+MethodCallExecutor::MethodCallExecutor(const MethodHandlerTable* methods)
+    : state_(std::make_shared<State>()) {
+  state_->methods = methods;
+  state_->runner = EventChannelProxy::platform_task_runner();
+}
+
+MethodCallExecutor::~MethodCallExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+  }
+  state_->cv.notify_one();
+  // A call already handed to the worker still runs and is answered.
+  if (state_->worker.joinable()) {
+    state_->worker.join();
+  }
+  state_->DrainQueue();
+}
+
+void MethodCallExecutor::Dispatch(const MethodCallProxy& method_call,
+                                  std::unique_ptr<MethodResultProxy> result) {
+  if (!state_->runner) {
+    RunNow(*state_->methods, method_call, std::move(result));
+    return;
+  }
+
+  std::unique_ptr<MethodResultProxy> platform_result =
+      std::make_unique<PlatformThreadMethodResult>(
+          std::move(result), state_->runner, std::this_thread::get_id());
+  MethodThread thread = state_->methods->ThreadFor(method_call.method_name());
+  // The common case runs without copying the call.
+  if (thread == MethodThread::kPlatform && !state_->busy &&
+      state_->queue.empty()) {
+    RunNow(*state_->methods, method_call, std::move(platform_result));
+    return;
+  }
+  state_->queue.push_back(
+      PendingCall{std::make_unique<OwnedMethodCallProxy>(method_call),
+                  std::move(platform_result), thread});
+  state_->Pump();
+}
+
+}  // namespace flutter_webrtc_plugin
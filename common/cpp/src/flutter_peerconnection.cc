@@ -8,6 +8,11 @@
 
 namespace flutter_webrtc_plugin {
 
+// ICE candidates and state changes arrive in bursts during negotiation;
+// batching sends each burst to Dart as one message. None of them may be
+// lost, so a full batching queue keeps events instead of dropping them.
+static const int kPeerConnectionEventBatchMs = 10;
+
 std::string RTCMediaTypeToString(RTCMediaType type) {
   switch (type) {
     case libwebrtc::RTCMediaType::AUDIO:
@@ -469,10 +474,10 @@ void FlutterPeerConnection::GetRemoteDescription(
 
 scoped_refptr<RTCRtpTransceiverInit>
 FlutterPeerConnection::mapToRtpTransceiverInit(const EncodableMap& params) {
-  EncodableList streamIds = findList(params, "streamIds");
+  const EncodableList& streamIds = findList(params, "streamIds");
 
   std::vector<string> stream_ids;
-  for (auto item : streamIds) {
+  for (const EncodableValue& item : streamIds) {
     std::string id = GetValue<std::string>(item);
     stream_ids.push_back(id.c_str());
   }
@@ -481,9 +486,9 @@ FlutterPeerConnection::mapToRtpTransceiverInit(const EncodableMap& params) {
   if (!direction.IsNull()) {
     dir = stringToTransceiverDirection(GetValue<std::string>(direction));
   }
-  EncodableList sendEncodings = findList(params, "sendEncodings");
+  const EncodableList& sendEncodings = findList(params, "sendEncodings");
   std::vector<scoped_refptr<RTCRtpEncodingParameters>> encodings;
-  for (EncodableValue value : sendEncodings) {
+  for (const EncodableValue& value : sendEncodings) {
     encodings.push_back(mapToEncoding(GetValue<EncodableMap>(value)));
   }
   scoped_refptr<RTCRtpTransceiverInit> init =
@@ -687,14 +692,14 @@ void FlutterPeerConnection::RtpSenderReplaceTrack(
 }
 
 scoped_refptr<RTCRtpParameters> FlutterPeerConnection::updateRtpParameters(
-    EncodableMap newParameters,
+    const EncodableMap& newParameters,
     scoped_refptr<RTCRtpParameters> parameters) {
-  EncodableList encodings = findList(newParameters, "encodings");
+  const EncodableList& encodings = findList(newParameters, "encodings");
   auto encoding = encodings.begin();
   auto params = parameters->encodings();
   for (auto param : params.std_vector()) {
     if (encoding != encodings.end()) {
-      EncodableMap map = GetValue<EncodableMap>(*encoding);
+      const EncodableMap& map = GetValue<EncodableMap>(*encoding);
       EncodableValue value = findEncodableValue(map, "active");
       if (!value.IsNull()) {
         param->set_active(GetValue<bool>(value));
@@ -881,8 +886,8 @@ void FlutterPeerConnection::RtpTransceiverSetCodecPreferences(
     return;
   }
   std::vector<scoped_refptr<RTCRtpCodecCapability>> codecList;
-  for (auto codec : codecs) {
-    auto codecMap = GetValue<EncodableMap>(codec);
+  for (const EncodableValue& codec : codecs) {
+    const EncodableMap& codecMap = GetValue<EncodableMap>(codec);
     auto codecMimeType = findString(codecMap, "mimeType");
     auto codecClockRate = findInt(codecMap, "clockRate");
     auto codecNumChannels = findInt(codecMap, "channels");
@@ -1120,7 +1125,11 @@ FlutterPeerConnectionObserver::FlutterPeerConnectionObserver(
     BinaryMessenger* messenger,
     const std::string& channel_name,
     std::string& peerConnectionId)
-    : event_channel_(EventChannelProxy::Create(messenger, channel_name)),
+    : event_channel_(
+          EventChannelProxy::Create(messenger,
+                                    channel_name,
+                                    kPeerConnectionEventBatchMs,
+                                    EventChannelProxy::Overflow::kKeep)),
       peerconnection_(peerconnection),
       base_(base),
       id_(peerConnectionId) {
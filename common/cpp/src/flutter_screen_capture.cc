@@ -183,9 +183,9 @@ void FlutterScreenCapture::GetDisplayMedia(
   // DesktopType source_type = kScreen;
   double fps = 30.0;
 
-  const EncodableMap video = findMap(constraints, "video");
+  const EncodableMap& video = findMap(constraints, "video");
   if (video != EncodableMap()) {
-    const EncodableMap deviceId = findMap(video, "deviceId");
+    const EncodableMap& deviceId = findMap(video, "deviceId");
     if (deviceId != EncodableMap()) {
       source_id = findString(deviceId, "exact");
       if (source_id.empty()) {
@@ -196,7 +196,7 @@ void FlutterScreenCapture::GetDisplayMedia(
         // source_type = DesktopType::kWindow;
       }
     }
-    const EncodableMap mandatory = findMap(video, "mandatory");
+    const EncodableMap& mandatory = findMap(video, "mandatory");
     if (mandatory != EncodableMap()) {
       double frameRate = findDouble(mandatory, "frameRate");
       if (frameRate != 0.0) {
@@ -1,83 +1,234 @@
 #include "flutter_video_renderer.h"
 
+#include <algorithm>
+#include <chrono>
+
+#include "flutter_color_conversion.h"
+
 namespace flutter_webrtc_plugin {
 
-FlutterVideoRenderer::~FlutterVideoRenderer() {}
+// Renderer events (first frame, size, rotation) are rare; batching them just
+// keeps the channel send off the decode thread.
+static const int kRendererEventBatchMs = 16;
+
+FlutterVideoRenderer::~FlutterVideoRenderer() {
+  // The conversion worker holds a reference while it runs, so nothing can
+  // still be writing to the slots here.
+  for (PixelSlot& slot : slots_) {
+    if (buffer_pool_) {
+      buffer_pool_->Release(slot.data, slot.capacity);
+    }
+  }
+}
 
 void FlutterVideoRenderer::initialize(
     TextureRegistrar* registrar,
     BinaryMessenger* messenger,
     std::unique_ptr<flutter::TextureVariant> texture,
-    int64_t trxture_id) {
+    int64_t trxture_id,
+    PixelBufferPool* buffer_pool) {
   registrar_ = registrar;
+  buffer_pool_ = buffer_pool;
   texture_ = std::move(texture);
   texture_id_ = trxture_id;
+  pixel_buffer_.reset(new FlutterDesktopPixelBuffer());
+  pixel_buffer_->buffer = nullptr;
+  pixel_buffer_->width = 0;
+  pixel_buffer_->height = 0;
   std::string channel_name =
       "FlutterWebRTC/Texture" + std::to_string(texture_id_);
-  event_channel_ = EventChannelProxy::Create(messenger, channel_name);
+  event_channel_ = EventChannelProxy::Create(messenger, channel_name,
+                                             kRendererEventBatchMs);
 }
 
 const FlutterDesktopPixelBuffer* FlutterVideoRenderer::CopyPixelBuffer(
     size_t width,
     size_t height) const {
-  mutex_.lock();
-  if (pixel_buffer_.get() && frame_.get()) {
-    if (pixel_buffer_->width != frame_->width() ||
-        pixel_buffer_->height != frame_->height()) {
-      size_t buffer_size =
-          (size_t(frame_->width()) * size_t(frame_->height())) * (32 >> 3);
-      rgb_buffer_.reset(new uint8_t[buffer_size]);
-      pixel_buffer_->width = frame_->width();
-      pixel_buffer_->height = frame_->height();
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Takes effect from the next converted frame; the current one is scaled by
+  // the engine until then.
+  target_size_ = {width, height};
+  if (slots_[ready_slot_].generation > slots_[front_slot_].generation) {
+    std::swap(front_slot_, ready_slot_);
+  } else if (slots_[front_slot_].data) {
+    // Nothing new since the last call, typically a repaint caused by other
+    // widgets; hand back the buffer that is already converted.
+    skipped_conversions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  const PixelSlot& front = slots_[front_slot_];
+  if (!pixel_buffer_ || !front.data) {
+    return nullptr;
+  }
+  // The engine reads the front buffer before calling back in, and the worker
+  // never writes to it, so it stays valid until the next call.
+  pixel_buffer_->buffer = front.data;
+  pixel_buffer_->width = front.width;
+  pixel_buffer_->height = front.height;
+  return pixel_buffer_.get();
+}
+
+void FlutterVideoRenderer::ConvertPendingFrames() {
+  for (;;) {
+    scoped_refptr<RTCVideoFrame> frame;
+    PixelSlot* back;
+    FrameSize target;
+    uint64_t generation;
+    int rotation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!pending_frame_) {
+        conversion_scheduled_ = false;
+        conversion_done_.notify_all();
+        return;
+      }
+      frame = pending_frame_;
+      generation = pending_generation_;
+      rotation = pending_rotation_;
+      pending_frame_ = nullptr;
+      back = &slots_[back_slot_];
+      target = target_size_;
     }
 
-    frame_->ConvertToARGB(RTCVideoFrame::Type::kABGR, rgb_buffer_.get(), 0,
-                          static_cast<int>(pixel_buffer_->width),
-                          static_cast<int>(pixel_buffer_->height));
+    // Scaling and rotation happen in the same pass as the colour conversion,
+    // so a thumbnail never pays for a full-size conversion.
+    const bool transposed = rotation == 90 || rotation == 270;
+    const size_t upright_width =
+        static_cast<size_t>(transposed ? frame->height() : frame->width());
+    const size_t upright_height =
+        static_cast<size_t>(transposed ? frame->width() : frame->height());
+    const FrameSize output = OutputSizeFor(upright_width, upright_height,
+                                           target.width, target.height);
+    const size_t width = output.width;
+    const size_t height = output.height;
+    const size_t buffer_size = width * height * (32 >> 3);
+    if (back->capacity < buffer_size) {
+      buffer_pool_->Release(back->data, back->capacity);
+      back->data = buffer_pool_->Acquire(buffer_size, &back->capacity);
+    }
+    const I420Planes planes = {frame->DataY(),   frame->DataU(),
+                               frame->DataV(),   frame->StrideY(),
+                               frame->StrideU(), frame->StrideV(),
+                               frame->width(),   frame->height()};
+    ConvertI420(planes, rotation, PixelOrder::kRGBA, back->data, 0,
+                static_cast<int>(width), static_cast<int>(height));
+    back->width = width;
+    back->height = height;
+    back->generation = generation;
 
-    pixel_buffer_->buffer = rgb_buffer_.get();
-    mutex_.unlock();
-    return pixel_buffer_.get();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // A ready buffer the raster thread never took is simply overwritten
+      // next time round; only the newest frame is worth showing.
+      std::swap(back_slot_, ready_slot_);
+    }
+    registrar_->MarkTextureFrameAvailable(texture_id_);
   }
-  mutex_.unlock();
-  return nullptr;
+}
+
+FlutterVideoRenderer::FrameSize FlutterVideoRenderer::OutputSizeFor(
+    size_t frame_width,
+    size_t frame_height,
+    size_t target_width,
+    size_t target_height) {
+  const FrameSize full = {frame_width, frame_height};
+  if (target_width == 0 || target_height == 0 || frame_width == 0 ||
+      frame_height == 0 || target_width >= frame_width ||
+      target_height >= frame_height) {
+    return full;
+  }
+  // Scale by the larger of the two ratios so neither axis is undersampled
+  // when the texture is stretched to a different aspect ratio.
+  const double scale =
+      std::max(static_cast<double>(target_width) / frame_width,
+               static_cast<double>(target_height) / frame_height);
+  size_t width = static_cast<size_t>(frame_width * scale + 0.5);
+  size_t height = static_cast<size_t>(frame_height * scale + 0.5);
+  // Rows a multiple of 16 pixels keep the scaler on its fast paths and stop
+  // the size from following every pixel of a resize animation.
+  width = std::min(frame_width, (width + 15) & ~static_cast<size_t>(15));
+  height = std::min(frame_height, (height + 1) & ~static_cast<size_t>(1));
+  if (width == 0 || height == 0) {
+    return full;
+  }
+  return {width, height};
 }
 
 void FlutterVideoRenderer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
+  const int64_t interval_us =
+      min_frame_interval_us_.load(std::memory_order_relaxed);
+  if (interval_us > 0) {
+    const int64_t now_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    // Accept frames up to a quarter interval early so capture jitter on a
+    // source running right at the cap does not halve its rate.
+    if (now_us < next_frame_due_us_ - interval_us / 4) {
+      decimated_frames_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // Advance from the previous due time to keep the long-run rate at the
+    // cap, but do not bank credit across a stall.
+    next_frame_due_us_ = now_us - next_frame_due_us_ > interval_us
+                             ? now_us + interval_us
+                             : next_frame_due_us_ + interval_us;
+  }
   if (!first_frame_rendered) {
     EncodableMap params;
     params[EncodableValue("event")] = "didFirstFrameRendered";
     params[EncodableValue("id")] = EncodableValue(texture_id_);
     event_channel_->Success(EncodableValue(params));
-    pixel_buffer_.reset(new FlutterDesktopPixelBuffer());
-    pixel_buffer_->width = 0;
-    pixel_buffer_->height = 0;
     first_frame_rendered = true;
   }
-  if (rotation_ != frame->rotation()) {
+  // With native rotation the texture is already upright, so Dart is told
+  // rotation 0 and the rotated size instead of rotating the widget itself.
+  const bool native_rotation = native_rotation_.load(std::memory_order_relaxed);
+  const RTCVideoFrame::VideoRotation rotation =
+      native_rotation ? RTCVideoFrame::kVideoRotation_0 : frame->rotation();
+  const bool transposed =
+      native_rotation &&
+      (frame->rotation() == RTCVideoFrame::kVideoRotation_90 ||
+       frame->rotation() == RTCVideoFrame::kVideoRotation_270);
+  const size_t width = transposed ? frame->height() : frame->width();
+  const size_t height = transposed ? frame->width() : frame->height();
+  if (rotation_ != rotation) {
     EncodableMap params;
     params[EncodableValue("event")] = "didTextureChangeRotation";
     params[EncodableValue("id")] = EncodableValue(texture_id_);
-    params[EncodableValue("rotation")] =
-        EncodableValue((int32_t)frame->rotation());
+    params[EncodableValue("rotation")] = EncodableValue((int32_t)rotation);
     event_channel_->Success(EncodableValue(params));
-    rotation_ = frame->rotation();
+    rotation_ = rotation;
   }
-  if (last_frame_size_.width != frame->width() ||
-      last_frame_size_.height != frame->height()) {
+  if (last_frame_size_.width != width || last_frame_size_.height != height) {
     EncodableMap params;
     params[EncodableValue("event")] = "didTextureChangeVideoSize";
     params[EncodableValue("id")] = EncodableValue(texture_id_);
-    params[EncodableValue("width")] = EncodableValue((int32_t)frame->width());
-    params[EncodableValue("height")] = EncodableValue((int32_t)frame->height());
+    params[EncodableValue("width")] = EncodableValue((int32_t)width);
+    params[EncodableValue("height")] = EncodableValue((int32_t)height);
     event_channel_->Success(EncodableValue(params));
 
-    last_frame_size_ = {(size_t)frame->width(), (size_t)frame->height()};
+    last_frame_size_ = {width, height};
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conversions_stopped_) {
+      return;
+    }
+    // Frames arriving while a conversion is in flight replace each other; the
+    // running worker picks up the latest one when it finishes.
+    if (pending_frame_) {
+      skipped_conversions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pending_frame_ = frame;
+    pending_generation_ = ++frame_generation_;
+    pending_rotation_ = native_rotation ? (int)frame->rotation() : 0;
+    if (conversion_scheduled_) {
+      return;
+    }
+    conversion_scheduled_ = true;
   }
-  mutex_.lock();
-  frame_ = frame;
-  mutex_.unlock();
-  registrar_->MarkTextureFrameAvailable(texture_id_);
+  scoped_refptr<FlutterVideoRenderer> self(this);
+  FrameConversionPool::Shared().Post([self] { self->ConvertPendingFrames(); });
 }
 
 void FlutterVideoRenderer::SetVideoTrack(scoped_refptr<RTCVideoTrack> track) {
@@ -92,6 +243,23 @@ void FlutterVideoRenderer::SetVideoTrack(scoped_refptr<RTCVideoTrack> track) {
   }
 }
 
+void FlutterVideoRenderer::StopConversions() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  conversions_stopped_ = true;
+  pending_frame_ = nullptr;
+  conversion_done_.wait(lock, [this] { return !conversion_scheduled_; });
+}
+
+void FlutterVideoRenderer::SetMaxFps(double max_fps) {
+  const int64_t interval_us =
+      max_fps > 0 ? static_cast<int64_t>(1000000.0 / max_fps) : 0;
+  min_frame_interval_us_.store(interval_us, std::memory_order_relaxed);
+}
+
+void FlutterVideoRenderer::SetNativeRotation(bool enabled) {
+  native_rotation_.store(enabled, std::memory_order_relaxed);
+}
+
 bool FlutterVideoRenderer::CheckMediaStream(std::string mediaId) {
   if (0 == mediaId.size() || 0 == media_stream_id.size()) {
     return false;
@@ -122,7 +290,8 @@ void FlutterVideoRendererManager::CreateVideoRendererTexture(
 
   auto texture_id = base_->textures_->RegisterTexture(textureVariant.get());
   texture->initialize(base_->textures_, base_->messenger_,
-                      std::move(textureVariant), texture_id);
+                      std::move(textureVariant), texture_id,
+                      &PixelBufferPool::Shared());
   renderers_[texture_id] = texture;
   EncodableMap params;
   params[EncodableValue("textureId")] = EncodableValue(texture_id);
@@ -167,12 +336,16 @@ void FlutterVideoRendererManager::VideoRendererDispose(
   auto it = renderers_.find(texture_id);
   if (it != renderers_.end()) {
     it->second->SetVideoTrack(nullptr);
+    it->second->StopConversions();
 #if defined(_WINDOWS)
-    base_->textures_->UnregisterTexture(texture_id,
-                                        [&, it] { renderers_.erase(it); });
+    base_->textures_->UnregisterTexture(texture_id, [&, it] {
+      renderers_.erase(it);
+      TrimPixelBuffersIfIdle();
+    });
 #else
     base_->textures_->UnregisterTexture(texture_id);
     renderers_.erase(it);
+    TrimPixelBuffersIfIdle();
 #endif
     result->Success();
     return;
@@ -181,4 +354,60 @@ void FlutterVideoRendererManager::VideoRendererDispose(
                 "VideoRendererDispose() texture not found!");
 }
 
+void FlutterVideoRendererManager::TrimPixelBuffersIfIdle() {
+  // Keep cached buffers while any renderer may still switch sizes; once the
+  // last one is gone they are only holding memory.
+  if (renderers_.empty()) {
+    PixelBufferPool::Shared().Trim();
+  }
+}
+
+void FlutterVideoRendererManager::VideoRendererSetMaxFps(
+    int64_t texture_id,
+    double max_fps,
+    std::unique_ptr<MethodResultProxy> result) {
+  auto it = renderers_.find(texture_id);
+  if (it != renderers_.end()) {
+    it->second->SetMaxFps(max_fps);
+    result->Success();
+    return;
+  }
+  result->Error("VideoRendererSetMaxFpsFailed",
+                "VideoRendererSetMaxFps() texture not found!");
+}
+
+void FlutterVideoRendererManager::VideoRendererSetNativeRotation(
+    int64_t texture_id,
+    bool enabled,
+    std::unique_ptr<MethodResultProxy> result) {
+  auto it = renderers_.find(texture_id);
+  if (it != renderers_.end()) {
+    it->second->SetNativeRotation(enabled);
+    result->Success();
+    return;
+  }
+  result->Error("VideoRendererSetNativeRotationFailed",
+                "VideoRendererSetNativeRotation() texture not found!");
+}
+
+void FlutterVideoRendererManager::VideoRendererGetStats(
+    int64_t texture_id,
+    std::unique_ptr<MethodResultProxy> result) {
+  auto it = renderers_.find(texture_id);
+  if (it != renderers_.end()) {
+    const FlutterVideoRenderer& renderer = *it->second;
+    EncodableMap stats;
+    stats[EncodableValue("skippedConversions")] =
+        EncodableValue(static_cast<int64_t>(renderer.skipped_conversions()));
+    stats[EncodableValue("decimatedFrames")] =
+        EncodableValue(static_cast<int64_t>(renderer.decimated_frames()));
+    stats[EncodableValue("droppedEvents")] =
+        EncodableValue(static_cast<int64_t>(renderer.dropped_events()));
+    result->Success(EncodableValue(stats));
+    return;
+  }
+  result->Error("VideoRendererGetStatsFailed",
+                "VideoRendererGetStats() texture not found!");
+}
+
 }  // namespace flutter_webrtc_plugin
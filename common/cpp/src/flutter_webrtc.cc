@@ -1,9 +1,94 @@
 #include "flutter_webrtc.h"
 
 #include "flutter_webrtc/flutter_web_r_t_c_plugin.h"
+#include "flutter_method_arguments.h"
 
 namespace flutter_webrtc_plugin {
 
+namespace {
+
+// Typed arguments of the signalling methods, which run per offer/answer
+// and per ICE candidate. Decoded by ArgumentSchema in the handlers.
+
+struct OfferAnswerArguments {
+  std::string peer_connection_id;
+  const EncodableMap* constraints = nullptr;
+};
+
+struct SetDescriptionArguments {
+  std::string peer_connection_id;
+  const EncodableMap* description = nullptr;
+};
+
+struct SessionDescriptionArguments {
+  std::string type;
+  std::string sdp;
+};
+
+struct AddCandidateArguments {
+  std::string peer_connection_id;
+  const EncodableMap* candidate = nullptr;
+};
+
+struct IceCandidateArguments {
+  std::string candidate;
+  std::string sdp_mid;
+  int sdp_mline_index = 0;
+};
+
+struct GetStatsArguments {
+  std::string peer_connection_id;
+  std::string track_id;
+};
+
+struct DataChannelSendArguments {
+  std::string peer_connection_id;
+  std::string data_channel_id;
+  std::string type;
+  const EncodableValue* data = nullptr;
+};
+
+const ArgumentSchema<OfferAnswerArguments>& OfferAnswerSchema() {
+  static const ArgumentSchema<OfferAnswerArguments> schema =
+      ArgumentSchema<OfferAnswerArguments>()
+          .Required(kPeerConnectionIdKey,
+                    &OfferAnswerArguments::peer_connection_id)
+          .Optional(kConstraintsKey, &OfferAnswerArguments::constraints);
+  return schema;
+}
+
+const ArgumentSchema<SetDescriptionArguments>& SetDescriptionSchema() {
+  static const ArgumentSchema<SetDescriptionArguments> schema =
+      ArgumentSchema<SetDescriptionArguments>()
+          .Required(kPeerConnectionIdKey,
+                    &SetDescriptionArguments::peer_connection_id)
+          .Required(kDescriptionKey, &SetDescriptionArguments::description);
+  return schema;
+}
+
+const ArgumentSchema<SessionDescriptionArguments>& SessionDescriptionSchema() {
+  static const ArgumentSchema<SessionDescriptionArguments> schema =
+      ArgumentSchema<SessionDescriptionArguments>()
+          .Required(kTypeKey, &SessionDescriptionArguments::type)
+          .Required(kSdpKey, &SessionDescriptionArguments::sdp);
+  return schema;
+}
+
+// Reads a description map as RTCSessionDescription::Create expects it.
+// Reports a "Bad Arguments" error and returns false if it is malformed.
+bool DecodeSessionDescription(const std::string& method_name,
+                              const EncodableMap& map,
+                              SessionDescriptionArguments* description,
+                              MethodResultProxy* result) {
+  std::string error;
+  if (SessionDescriptionSchema().Decode(map, description, &error))
+    return true;
+  result->Error("Bad Arguments", method_name + "() description " + error);
+  return false;
+}
+
+}  // namespace
+
 FlutterWebRTC::FlutterWebRTC(FlutterWebRTCPlugin* plugin)
     : FlutterWebRTCBase::FlutterWebRTCBase(plugin->messenger(),
                                            plugin->textures()),
@@ -12,1242 +97,1661 @@ FlutterWebRTC::FlutterWebRTC(FlutterWebRTCPlugin* plugin)
       FlutterPeerConnection::FlutterPeerConnection(this),
       FlutterScreenCapture::FlutterScreenCapture(this),
       FlutterDataChannel::FlutterDataChannel(this),
-      FlutterFrameCryptor::FlutterFrameCryptor(this) {}
+      FlutterFrameCryptor::FlutterFrameCryptor(this),
+      executor_(&methods_) {
+  RegisterMethods();
+}
 
 FlutterWebRTC::~FlutterWebRTC() {}
 
 void FlutterWebRTC::HandleMethodCall(
     const MethodCallProxy& method_call,
     std::unique_ptr<MethodResultProxy> result) {
-  if (method_call.method_name().compare("initialize") == 0) {
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const EncodableMap options = findMap(params, "options");
-    result->Success();
-  } else if (method_call.method_name().compare("createPeerConnection") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const EncodableMap configuration = findMap(params, "configuration");
-    const EncodableMap constraints = findMap(params, "constraints");
-    CreateRTCPeerConnection(configuration, constraints, std::move(result));
-  } else if (method_call.method_name().compare("getUserMedia") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const EncodableMap constraints = findMap(params, "constraints");
-    GetUserMedia(constraints, std::move(result));
-  } else if (method_call.method_name().compare("getDisplayMedia") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const EncodableMap constraints = findMap(params, "constraints");
-
-    GetDisplayMedia(constraints, std::move(result));
-  } else if (method_call.method_name().compare("getDesktopSources") == 0) {
-    // types: ["screen", "window"]
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Bad arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-
-    const EncodableList types = findList(params, "types");
-    if (types.empty()) {
-      result->Error("Bad Arguments", "Types is required");
-      return;
-    }
-    GetDesktopSources(types, std::move(result));
-  } else if (method_call.method_name().compare("updateDesktopSources") == 0) {
-    // types: ["screen", "window"]
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Bad arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  executor_.Dispatch(method_call, std::move(result));
+}
 
-    const EncodableList types = findList(params, "types");
-    if (types.empty()) {
-      result->Error("Bad Arguments", "Types is required");
-      return;
-    }
-    UpdateDesktopSources(types, std::move(result));
-  } else if (method_call.method_name().compare("getDesktopSourceThumbnail") ==
-             0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Bad arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+void FlutterWebRTC::RegisterMethods() {
+  methods_.Register("initialize", this, &FlutterWebRTC::HandleInitialize);
+  RegisterMediaStreamMethods();
+  RegisterScreenCaptureMethods();
+  RegisterPeerConnectionMethods();
+  RegisterDataChannelMethods();
+  RegisterVideoRendererMethods();
+  RegisterFrameCryptorMethods(&methods_);
+}
 
-    std::string sourceId = findString(params, "sourceId");
-    if (sourceId.empty()) {
-      result->Error("Bad Arguments", "Incorrect sourceId");
-      return;
-    }
-    const EncodableMap thumbnailSize = findMap(params, "thumbnailSize");
-    if (!thumbnailSize.empty()) {
-      int width = 0;
-      int height = 0;
-      GetDesktopSourceThumbnail(sourceId, width, height, std::move(result));
-    } else {
-      result->Error("Bad Arguments", "Bad arguments received");
-    }
-  } else if (method_call.method_name().compare("getSources") == 0) {
-    GetSources(std::move(result));
-  } else if (method_call.method_name().compare("selectAudioInput") == 0) {
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string deviceId = findString(params, "deviceId");
-    SelectAudioInput(deviceId, std::move(result));
-  } else if (method_call.method_name().compare("selectAudioOutput") == 0) {
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string deviceId = findString(params, "deviceId");
-    SelectAudioOutput(deviceId, std::move(result));
-  } else if (method_call.method_name().compare("mediaStreamGetTracks") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string streamId = findString(params, "streamId");
-    MediaStreamGetTracks(streamId, std::move(result));
-  } else if (method_call.method_name().compare("createOffer") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "constraints");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("createOfferFailed",
-                    "createOffer() peerConnection is null");
-      return;
-    }
-    CreateOffer(constraints, pc, std::move(result));
-  } else if (method_call.method_name().compare("createAnswer") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "constraints");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("createAnswerFailed",
-                    "createAnswer() peerConnection is null");
-      return;
-    }
-    CreateAnswer(constraints, pc, std::move(result));
-  } else if (method_call.method_name().compare("addStream") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string streamId = findString(params, "streamId");
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
-    if (!stream) {
-      result->Error("addStreamFailed", "addStream() stream not found!");
-      return;
-    }
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("addStreamFailed", "addStream() peerConnection is null");
-      return;
-    }
-    pc->AddStream(stream);
-    result->Success();
-  } else if (method_call.method_name().compare("removeStream") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string streamId = findString(params, "streamId");
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
-    if (!stream) {
-      result->Error("removeStreamFailed", "removeStream() stream not found!");
-      return;
-    }
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("removeStreamFailed",
-                    "removeStream() peerConnection is null");
-      return;
-    }
-    pc->RemoveStream(stream);
-    result->Success();
-  } else if (method_call.method_name().compare("setLocalDescription") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "description");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("setLocalDescriptionFailed",
-                    "setLocalDescription() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::RegisterMediaStreamMethods() {
+  methods_.Register("getUserMedia", this, &FlutterWebRTC::HandleGetUserMedia,
+                    MethodThread::kWorker);
+  methods_.Register("getSources", this, &FlutterWebRTC::HandleGetSources,
+                    MethodThread::kWorker);
+  methods_.Register("selectAudioInput", this,
+                    &FlutterWebRTC::HandleSelectAudioInput);
+  methods_.Register("selectAudioOutput", this,
+                    &FlutterWebRTC::HandleSelectAudioOutput);
+  methods_.Register("mediaStreamGetTracks", this,
+                    &FlutterWebRTC::HandleMediaStreamGetTracks);
+  methods_.Register("streamDispose", this, &FlutterWebRTC::HandleStreamDispose);
+  methods_.Register("mediaStreamTrackSetEnable", this,
+                    &FlutterWebRTC::HandleMediaStreamTrackSetEnable);
+  methods_.Register("trackDispose", this, &FlutterWebRTC::HandleTrackDispose);
+  methods_.Register("mediaStreamTrackSwitchCamera", this,
+                    &FlutterWebRTC::HandleMediaStreamTrackSwitchCamera,
+                    MethodThread::kWorker);
+  methods_.Register("setVolume", this, &FlutterWebRTC::HandleSetVolume);
+  methods_.Register("mediaStreamAddTrack", this,
+                    &FlutterWebRTC::HandleMediaStreamAddTrack);
+  methods_.Register("mediaStreamRemoveTrack", this,
+                    &FlutterWebRTC::HandleMediaStreamRemoveTrack);
+  methods_.Register("captureFrame", this, &FlutterWebRTC::HandleCaptureFrame,
+                    MethodThread::kWorker);
+  methods_.Register("createLocalMediaStream", this,
+                    &FlutterWebRTC::HandleCreateLocalMediaStream);
+}
 
-    SdpParseError error;
-    scoped_refptr<RTCSessionDescription> description =
-        RTCSessionDescription::Create(findString(constraints, "type").c_str(),
-                                      findString(constraints, "sdp").c_str(),
-                                      &error);
+void FlutterWebRTC::RegisterScreenCaptureMethods() {
+  methods_.Register("getDisplayMedia", this,
+                    &FlutterWebRTC::HandleGetDisplayMedia,
+                    MethodThread::kWorker);
+  methods_.Register("getDesktopSources", this,
+                    &FlutterWebRTC::HandleGetDesktopSources,
+                    MethodThread::kWorker);
+  methods_.Register("updateDesktopSources", this,
+                    &FlutterWebRTC::HandleUpdateDesktopSources,
+                    MethodThread::kWorker);
+  methods_.Register("getDesktopSourceThumbnail", this,
+                    &FlutterWebRTC::HandleGetDesktopSourceThumbnail,
+                    MethodThread::kWorker);
+}
 
-    if (description.get() != nullptr) {
-      SetLocalDescription(description.get(), pc, std::move(result));
-    } else {
-      result->Error("setLocalDescriptionFailed", "Invalid type or sdp");
-    }
-  } else if (method_call.method_name().compare("setRemoteDescription") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "description");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("setRemoteDescriptionFailed",
-                    "setRemoteDescription() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::RegisterPeerConnectionMethods() {
+  methods_.Register("createPeerConnection", this,
+                    &FlutterWebRTC::HandleCreatePeerConnection);
+  methods_.Register("createOffer", this, &FlutterWebRTC::HandleCreateOffer);
+  methods_.Register("createAnswer", this, &FlutterWebRTC::HandleCreateAnswer);
+  methods_.Register("addStream", this, &FlutterWebRTC::HandleAddStream);
+  methods_.Register("removeStream", this, &FlutterWebRTC::HandleRemoveStream);
+  methods_.Register("setLocalDescription", this,
+                    &FlutterWebRTC::HandleSetLocalDescription);
+  methods_.Register("setRemoteDescription", this,
+                    &FlutterWebRTC::HandleSetRemoteDescription);
+  methods_.Register("addCandidate", this, &FlutterWebRTC::HandleAddCandidate);
+  methods_.Register("getStats", this, &FlutterWebRTC::HandleGetStats);
+  methods_.Register("restartIce", this, &FlutterWebRTC::HandleRestartIce);
+  methods_.Register("peerConnectionClose", this,
+                    &FlutterWebRTC::HandlePeerConnectionClose);
+  methods_.Register("peerConnectionDispose", this,
+                    &FlutterWebRTC::HandlePeerConnectionDispose);
+  methods_.Register("getLocalDescription", this,
+                    &FlutterWebRTC::HandleGetLocalDescription);
+  methods_.Register("getRemoteDescription", this,
+                    &FlutterWebRTC::HandleGetRemoteDescription);
+  methods_.Register("addTrack", this, &FlutterWebRTC::HandleAddTrack);
+  methods_.Register("removeTrack", this, &FlutterWebRTC::HandleRemoveTrack);
+  methods_.Register("addTransceiver", this,
+                    &FlutterWebRTC::HandleAddTransceiver);
+  methods_.Register("getTransceivers", this,
+                    &FlutterWebRTC::HandleGetTransceivers);
+  methods_.Register("getReceivers", this, &FlutterWebRTC::HandleGetReceivers);
+  methods_.Register("getSenders", this, &FlutterWebRTC::HandleGetSenders);
+  methods_.Register("rtpSenderSetTrack", this,
+                    &FlutterWebRTC::HandleRtpSenderSetTrack);
+  methods_.Register("rtpSenderSetStreams", this,
+                    &FlutterWebRTC::HandleRtpSenderSetStreams);
+  methods_.Register("rtpSenderReplaceTrack", this,
+                    &FlutterWebRTC::HandleRtpSenderReplaceTrack);
+  methods_.Register("rtpSenderSetParameters", this,
+                    &FlutterWebRTC::HandleRtpSenderSetParameters);
+  methods_.Register("rtpTransceiverStop", this,
+                    &FlutterWebRTC::HandleRtpTransceiverStop);
+  methods_.Register("rtpTransceiverGetCurrentDirection", this,
+                    &FlutterWebRTC::HandleRtpTransceiverGetCurrentDirection);
+  methods_.Register("rtpTransceiverSetDirection", this,
+                    &FlutterWebRTC::HandleRtpTransceiverSetDirection);
+  methods_.Register("setConfiguration", this,
+                    &FlutterWebRTC::HandleSetConfiguration);
+  methods_.Register("canInsertDtmf", this, &FlutterWebRTC::HandleCanInsertDtmf);
+  methods_.Register("sendDtmf", this, &FlutterWebRTC::HandleSendDtmf);
+  methods_.Register("getRtpSenderCapabilities", this,
+                    &FlutterWebRTC::HandleGetRtpSenderCapabilities);
+  methods_.Register("getRtpReceiverCapabilities", this,
+                    &FlutterWebRTC::HandleGetRtpReceiverCapabilities);
+  methods_.Register("setCodecPreferences", this,
+                    &FlutterWebRTC::HandleSetCodecPreferences);
+  methods_.Register("getSignalingState", this,
+                    &FlutterWebRTC::HandleGetSignalingState);
+  methods_.Register("getIceGatheringState", this,
+                    &FlutterWebRTC::HandleGetIceGatheringState);
+  methods_.Register("getIceConnectionState", this,
+                    &FlutterWebRTC::HandleGetIceConnectionState);
+  methods_.Register("getConnectionState", this,
+                    &FlutterWebRTC::HandleGetConnectionState);
+}
 
-    SdpParseError error;
-    scoped_refptr<RTCSessionDescription> description =
-        RTCSessionDescription::Create(findString(constraints, "type").c_str(),
-                                      findString(constraints, "sdp").c_str(),
-                                      &error);
+void FlutterWebRTC::RegisterDataChannelMethods() {
+  methods_.Register("createDataChannel", this,
+                    &FlutterWebRTC::HandleCreateDataChannel);
+  methods_.Register("dataChannelSend", this,
+                    &FlutterWebRTC::HandleDataChannelSend);
+  methods_.Register("dataChannelClose", this,
+                    &FlutterWebRTC::HandleDataChannelClose);
+}
 
-    if (description.get() != nullptr) {
-      SetRemoteDescription(description.get(), pc, std::move(result));
-    } else {
-      result->Error("setRemoteDescriptionFailed", "Invalid type or sdp");
-    }
-  } else if (method_call.method_name().compare("addCandidate") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "candidate");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("addCandidateFailed",
-                    "addCandidate() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::RegisterVideoRendererMethods() {
+  methods_.Register("createVideoRenderer", this,
+                    &FlutterWebRTC::HandleCreateVideoRenderer);
+  methods_.Register("videoRendererDispose", this,
+                    &FlutterWebRTC::HandleVideoRendererDispose);
+  methods_.Register("videoRendererSetSrcObject", this,
+                    &FlutterWebRTC::HandleVideoRendererSetSrcObject);
+  methods_.Register("videoRendererSetMaxFps", this,
+                    &FlutterWebRTC::HandleVideoRendererSetMaxFps);
+  methods_.Register("videoRendererSetNativeRotation", this,
+                    &FlutterWebRTC::HandleVideoRendererSetNativeRotation);
+  methods_.Register("videoRendererGetStats", this,
+                    &FlutterWebRTC::HandleVideoRendererGetStats);
+}
 
-    SdpParseError error;
-    std::string candidate = findString(constraints, "candidate");
-    if (candidate.empty()) {
-      // received the end-of-candidates
-      result->Success();
-      return;
-    }
-    int sdpMLineIndex = findInt(constraints, "sdpMLineIndex");
-    scoped_refptr<RTCIceCandidate> rtc_candidate = RTCIceCandidate::Create(
-        candidate.c_str(), findString(constraints, "sdpMid").c_str(),
-        sdpMLineIndex == -1 ? 0 : sdpMLineIndex, &error);
-
-    if (rtc_candidate.get() != nullptr) {
-      AddIceCandidate(rtc_candidate.get(), pc, std::move(result));
-    } else {
-      result->Error("addCandidateFailed", "Invalid candidate");
-    }
-  } else if (method_call.method_name().compare("getStats") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const std::string track_id = findString(params, "trackId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getStatsFailed", "getStats() peerConnection is null");
-      return;
-    }
-    GetStats(track_id, pc, std::move(result));
-  } else if (method_call.method_name().compare("createDataChannel") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("createDataChannelFailed",
-                    "createDataChannel() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleInitialize(
+    const MethodCallProxy& /*method_call*/,
+    std::unique_ptr<MethodResultProxy> result) {
+  result->Success();
+}
 
-    const std::string label = findString(params, "label");
-    const EncodableMap dataChannelDict = findMap(params, "dataChannelDict");
+void FlutterWebRTC::HandleGetUserMedia(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const EncodableMap& constraints = findMap(params, "constraints");
+  GetUserMedia(constraints, std::move(result));
+}
 
-    CreateDataChannel(peerConnectionId, label, dataChannelDict, pc,
-                      std::move(result));
-  } else if (method_call.method_name().compare("dataChannelSend") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("dataChannelSendFailed",
-                    "dataChannelSend() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleGetSources(
+    const MethodCallProxy& /*method_call*/,
+    std::unique_ptr<MethodResultProxy> result) {
+  GetSources(std::move(result));
+}
 
-    const std::string dataChannelId = findString(params, "dataChannelId");
-    const std::string type = findString(params, "type");
-    const EncodableValue data = findEncodableValue(params, "data");
-    RTCDataChannel* data_channel = DataChannelForId(dataChannelId);
-    if (data_channel == nullptr) {
-      result->Error("dataChannelSendFailed",
-                    "dataChannelSend() data_channel is null");
-      return;
-    }
-    DataChannelSend(data_channel, type, data, std::move(result));
-  } else if (method_call.method_name().compare("dataChannelClose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("dataChannelCloseFailed",
-                    "dataChannelClose() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleSelectAudioInput(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string deviceId = findString(params, "deviceId");
+  SelectAudioInput(deviceId, std::move(result));
+}
 
-    const std::string dataChannelId = findString(params, "dataChannelId");
-    RTCDataChannel* data_channel = DataChannelForId(dataChannelId);
-    if (data_channel == nullptr) {
-      result->Error("dataChannelCloseFailed",
-                    "dataChannelClose() data_channel is null");
-      return;
-    }
-    DataChannelClose(data_channel, dataChannelId, std::move(result));
-  } else if (method_call.method_name().compare("streamDispose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string stream_id = findString(params, "streamId");
-    MediaStreamDispose(stream_id, std::move(result));
-  } else if (method_call.method_name().compare("mediaStreamTrackSetEnable") ==
-             0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string track_id = findString(params, "trackId");
-    const EncodableValue enable = findEncodableValue(params, "enabled");
-    RTCMediaTrack* track = MediaTrackForId(track_id);
-    if (track != nullptr) {
-      track->set_enabled(GetValue<bool>(enable));
-    }
-    result->Success();
-  } else if (method_call.method_name().compare("trackDispose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string track_id = findString(params, "trackId");
-    MediaStreamTrackDispose(track_id, std::move(result));
-  } else if (method_call.method_name().compare("restartIce") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("restartIceFailed", "restartIce() peerConnection is null");
-      return;
-    }
-    pc->RestartIce();
-    result->Success();
-  } else if (method_call.method_name().compare("peerConnectionClose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("peerConnectionCloseFailed",
-                    "peerConnectionClose() peerConnection is null");
-      return;
-    }
-    RTCPeerConnectionClose(pc, peerConnectionId, std::move(result));
-  } else if (method_call.method_name().compare("peerConnectionDispose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Success();
-      return;
-    }
-    RTCPeerConnectionDispose(pc, peerConnectionId, std::move(result));
-  } else if (method_call.method_name().compare("createVideoRenderer") == 0) {
-    CreateVideoRendererTexture(std::move(result));
-  } else if (method_call.method_name().compare("videoRendererDispose") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    int64_t texture_id = findLongInt(params, "textureId");
-    VideoRendererDispose(texture_id, std::move(result));
-  } else if (method_call.method_name().compare("videoRendererSetSrcObject") ==
-             0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string stream_id = findString(params, "streamId");
-    int64_t texture_id = findLongInt(params, "textureId");
-    const std::string owner_tag = findString(params, "ownerTag");
-    const std::string track_id = findString(params, "trackId");
-
-    VideoRendererSetSrcObject(texture_id, stream_id, owner_tag, track_id);
-    result->Success();
-  } else if (method_call.method_name().compare(
-                 "mediaStreamTrackSwitchCamera") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string track_id = findString(params, "trackId");
-    MediaStreamTrackSwitchCamera(track_id, std::move(result));
-  } else if (method_call.method_name().compare("setVolume") == 0) {
-    auto args = method_call.arguments();
-    if (!args) {
-      result->Error("Bad Arguments", "setVolume() Null arguments received");
-      return;
-    }
+void FlutterWebRTC::HandleSelectAudioOutput(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string deviceId = findString(params, "deviceId");
+  SelectAudioOutput(deviceId, std::move(result));
+}
 
-    const EncodableMap params = GetValue<EncodableMap>(*args);
-    const std::string trackId = findString(params, "trackId");
-    const std::optional<double> volume = maybeFindDouble(params, "volume");
+void FlutterWebRTC::HandleMediaStreamGetTracks(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string streamId = findString(params, "streamId");
+  MediaStreamGetTracks(streamId, std::move(result));
+}
 
-    if (trackId.empty()) {
-      result->Error("Bad Arguments", "setVolume() Empty track provided");
-      return;
-    }
+void FlutterWebRTC::HandleStreamDispose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string stream_id = findString(params, "streamId");
+  MediaStreamDispose(stream_id, std::move(result));
+}
 
-    if (!volume.has_value()) {
-      result->Error("Bad Arguments", "setVolume() No volume provided");
-      return;
-    }
+void FlutterWebRTC::HandleMediaStreamTrackSetEnable(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string track_id = findString(params, kTrackIdKey);
+  const EncodableValue& enable = findEncodableValue(params, "enabled");
+  RTCMediaTrack* track = MediaTrackForId(track_id);
+  if (track != nullptr) {
+    track->set_enabled(GetValue<bool>(enable));
+  }
+  result->Success();
+}
 
-    if (volume.value() < 0) {
-      result->Error("Bad Arguments", "setVolume() Volume must be positive");
-      return;
-    }
+void FlutterWebRTC::HandleTrackDispose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string track_id = findString(params, kTrackIdKey);
+  MediaStreamTrackDispose(track_id, std::move(result));
+}
 
-    RTCMediaTrack* track = MediaTrackForId(trackId);
-    if (nullptr == track) {
-      result->Error("setVolume", "setVolume() Unable to find provided track");
-      return;
-    }
+void FlutterWebRTC::HandleMediaStreamTrackSwitchCamera(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string track_id = findString(params, kTrackIdKey);
+  MediaStreamTrackSwitchCamera(track_id, std::move(result));
+}
 
-    std::string kind = track->kind().std_string();
-    if (0 != kind.compare("audio")) {
-      result->Error("setVolume",
-                    "setVolume() Only audio tracks can have volume set");
-      return;
-    }
+void FlutterWebRTC::HandleSetVolume(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  auto args = method_call.arguments();
+  if (!args) {
+    result->Error("Bad Arguments", "setVolume() Null arguments received");
+    return;
+  }
 
-    auto audioTrack = static_cast<RTCAudioTrack*>(track);
-    audioTrack->SetVolume(volume.value());
+  const EncodableMap& params = GetValue<EncodableMap>(*args);
+  const std::string trackId = findString(params, kTrackIdKey);
+  const std::optional<double> volume = maybeFindDouble(params, "volume");
 
-    result->Success();
-  } else if (method_call.method_name().compare("getLocalDescription") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "description");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("GetLocalDescription",
-                    "GetLocalDescription() peerConnection is null");
-      return;
-    }
+  if (trackId.empty()) {
+    result->Error("Bad Arguments", "setVolume() Empty track provided");
+    return;
+  }
 
-    GetLocalDescription(pc, std::move(result));
-  } else if (method_call.method_name().compare("getRemoteDescription") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap constraints = findMap(params, "description");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("GetRemoteDescription",
-                    "GetRemoteDescription() peerConnection is null");
-      return;
-    }
+  if (!volume.has_value()) {
+    result->Error("Bad Arguments", "setVolume() No volume provided");
+    return;
+  }
 
-    GetRemoteDescription(pc, std::move(result));
-  } else if (method_call.method_name().compare("mediaStreamAddTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  if (volume.value() < 0) {
+    result->Error("Bad Arguments", "setVolume() Volume must be positive");
+    return;
+  }
 
-    const std::string streamId = findString(params, "streamId");
-    const std::string trackId = findString(params, "trackId");
+  RTCMediaTrack* track = MediaTrackForId(trackId);
+  if (nullptr == track) {
+    result->Error("setVolume", "setVolume() Unable to find provided track");
+    return;
+  }
 
-    scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
-    if (stream == nullptr) {
-      result->Error("MediaStreamAddTrack",
-                    "MediaStreamAddTrack() stream is null");
-      return;
-    }
+  std::string kind = track->kind().std_string();
+  if (0 != kind.compare("audio")) {
+    result->Error("setVolume",
+                  "setVolume() Only audio tracks can have volume set");
+    return;
+  }
 
-    scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
-    if (track == nullptr) {
-      result->Error("MediaStreamAddTrack",
-                    "MediaStreamAddTrack() track is null");
-      return;
-    }
+  auto audioTrack = static_cast<RTCAudioTrack*>(track);
+  audioTrack->SetVolume(volume.value());
 
-    MediaStreamAddTrack(stream, track, std::move(result));
-    std::string kind = track->kind().std_string();
-    for (int i = 0; i < renders_.size(); i++) {
-      FlutterVideoRenderer* renderer = renders_.at(i).get();
-      if (renderer->CheckMediaStream(streamId) && 0 == kind.compare("video")) {
-        renderer->SetVideoTrack(static_cast<RTCVideoTrack*>(track.get()));
-      }
-    }
-  } else if (method_call.method_name().compare("mediaStreamRemoveTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  result->Success();
+}
 
-    const std::string streamId = findString(params, "streamId");
-    const std::string trackId = findString(params, "trackId");
+void FlutterWebRTC::HandleMediaStreamAddTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
-    if (stream == nullptr) {
-      result->Error("MediaStreamRemoveTrack",
-                    "MediaStreamRemoveTrack() stream is null");
-      return;
-    }
+  const std::string streamId = findString(params, "streamId");
+  const std::string trackId = findString(params, kTrackIdKey);
 
-    scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
-    if (track == nullptr) {
-      result->Error("MediaStreamRemoveTrack",
-                    "MediaStreamRemoveTrack() track is null");
-      return;
-    }
+  scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
+  if (stream == nullptr) {
+    result->Error("MediaStreamAddTrack",
+                  "MediaStreamAddTrack() stream is null");
+    return;
+  }
 
-    MediaStreamRemoveTrack(stream, track, std::move(result));
+  scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
+  if (track == nullptr) {
+    result->Error("MediaStreamAddTrack",
+                  "MediaStreamAddTrack() track is null");
+    return;
+  }
 
-    for (int i = 0; i < renders_.size(); i++) {
-      FlutterVideoRenderer* renderer = renders_.at(i).get();
-      if (renderer->CheckVideoTrack(streamId)) {
-        renderer->SetVideoTrack(nullptr);
-      }
-    }
-  } else if (method_call.method_name().compare("addTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
+  MediaStreamAddTrack(stream, track, std::move(result));
+  std::string kind = track->kind().std_string();
+  for (int i = 0; i < renders_.size(); i++) {
+    FlutterVideoRenderer* renderer = renders_.at(i).get();
+    if (renderer->CheckMediaStream(streamId) && 0 == kind.compare("video")) {
+      renderer->SetVideoTrack(static_cast<RTCVideoTrack*>(track.get()));
     }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const std::string trackId = findString(params, "trackId");
-    const EncodableList streamIds = findList(params, "streamIds");
+  }
+}
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("AddTrack", "AddTrack() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleMediaStreamRemoveTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
-    if (track == nullptr) {
-      result->Error("AddTrack", "AddTrack() track is null");
-      return;
-    }
-    std::vector<std::string> ids;
-    for (EncodableValue value : streamIds) {
-      ids.push_back(GetValue<std::string>(value));
-    }
+  const std::string streamId = findString(params, "streamId");
+  const std::string trackId = findString(params, kTrackIdKey);
 
-    AddTrack(pc, track, ids, std::move(result));
+  scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
+  if (stream == nullptr) {
+    result->Error("MediaStreamRemoveTrack",
+                  "MediaStreamRemoveTrack() stream is null");
+    return;
+  }
 
-  } else if (method_call.method_name().compare("removeTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
+  if (track == nullptr) {
+    result->Error("MediaStreamRemoveTrack",
+                  "MediaStreamRemoveTrack() track is null");
+    return;
+  }
 
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const std::string senderId = findString(params, "senderId");
+  MediaStreamRemoveTrack(stream, track, std::move(result));
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("removeTrack", "removeTrack() peerConnection is null");
-      return;
+  for (int i = 0; i < renders_.size(); i++) {
+    FlutterVideoRenderer* renderer = renders_.at(i).get();
+    if (renderer->CheckVideoTrack(streamId)) {
+      renderer->SetVideoTrack(nullptr);
     }
+  }
+}
 
-    RemoveTrack(pc, senderId, std::move(result));
+void FlutterWebRTC::HandleCaptureFrame(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-  } else if (method_call.method_name().compare("addTransceiver") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const EncodableMap transceiverInit = findMap(params, "transceiverInit");
-    const std::string mediaType = findString(params, "mediaType");
-    const std::string trackId = findString(params, "trackId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("addTransceiver",
-                    "addTransceiver() peerConnection is null");
-      return;
-    }
-    AddTransceiver(pc, trackId, mediaType, transceiverInit, std::move(result));
-  } else if (method_call.method_name().compare("getTransceivers") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getTransceivers",
-                    "getTransceivers() peerConnection is null");
-      return;
-    }
+  const std::string path = findString(params, "path");
+  if (path.empty()) {
+    result->Error("captureFrame", "captureFrame() path is null or empty");
+    return;
+  }
 
-    GetTransceivers(pc, std::move(result));
-  } else if (method_call.method_name().compare("getReceivers") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getReceivers", "getReceivers() peerConnection is null");
-      return;
-    }
+  const std::string trackId = findString(params, kTrackIdKey);
+  RTCMediaTrack* track = MediaTrackForId(trackId);
+  if (nullptr == track) {
+    result->Error("captureFrame", "captureFrame() track is null");
+    return;
+  }
+  std::string kind = track->kind().std_string();
+  if (0 != kind.compare("video")) {
+    result->Error("captureFrame", "captureFrame() track not is video track");
+    return;
+  }
+  CaptureFrame(reinterpret_cast<RTCVideoTrack*>(track), path,
+               std::move(result));
+}
 
-    GetReceivers(pc, std::move(result));
+void FlutterWebRTC::HandleCreateLocalMediaStream(
+    const MethodCallProxy& /*method_call*/,
+    std::unique_ptr<MethodResultProxy> result) {
+  CreateLocalMediaStream(std::move(result));
+}
 
-  } else if (method_call.method_name().compare("getSenders") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getSenders", "getSenders() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleGetDisplayMedia(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const EncodableMap& constraints = findMap(params, "constraints");
 
-    GetSenders(pc, std::move(result));
-  } else if (method_call.method_name().compare("rtpSenderSetTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpSenderSetTrack",
-                    "rtpSenderSetTrack() peerConnection is null");
-      return;
-    }
+  GetDisplayMedia(constraints, std::move(result));
+}
 
-    const std::string trackId = findString(params, "trackId");
-    RTCMediaTrack* track = MediaTrackForId(trackId);
+void FlutterWebRTC::HandleGetDesktopSources(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  // types: ["screen", "window"]
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Bad arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-    if (rtpSenderId.empty()) {
-      result->Error("rtpSenderSetTrack",
-                    "rtpSenderSetTrack() rtpSenderId is null or empty");
-      return;
-    }
-    RtpSenderSetTrack(pc, track, rtpSenderId, std::move(result));
-  } else if (method_call.method_name().compare("rtpSenderSetStreams") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpSenderSetStream",
-                    "rtpSenderSetStream() peerConnection is null");
-      return;
-    }
+  const EncodableList& types = findList(params, "types");
+  if (types.empty()) {
+    result->Error("Bad Arguments", "Types is required");
+    return;
+  }
+  GetDesktopSources(types, std::move(result));
+}
 
-    const EncodableList encodableStreamIds = findList(params, "streamIds");
-    if (encodableStreamIds.empty()) {
-      result->Error("rtpSenderSetStream",
-                    "rtpSenderSetStream() streamId is null or empty");
-      return;
-    }
-    std::vector<std::string> streamIds{};
-    for (EncodableValue value : encodableStreamIds) {
-      streamIds.push_back(GetValue<std::string>(value));
-    }
+void FlutterWebRTC::HandleUpdateDesktopSources(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  // types: ["screen", "window"]
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Bad arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-    if (rtpSenderId.empty()) {
-      result->Error("rtpSenderSetStream",
-                    "rtpSenderSetStream() rtpSenderId is null or empty");
-      return;
-    }
-    RtpSenderSetStream(pc, streamIds, rtpSenderId, std::move(result));
-  } else if (method_call.method_name().compare("rtpSenderReplaceTrack") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpSenderReplaceTrack",
-                    "rtpSenderReplaceTrack() peerConnection is null");
-      return;
-    }
+  const EncodableList& types = findList(params, "types");
+  if (types.empty()) {
+    result->Error("Bad Arguments", "Types is required");
+    return;
+  }
+  UpdateDesktopSources(types, std::move(result));
+}
 
-    const std::string trackId = findString(params, "trackId");
-    RTCMediaTrack* track = MediaTrackForId(trackId);
+void FlutterWebRTC::HandleGetDesktopSourceThumbnail(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Bad arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-    if (rtpSenderId.empty()) {
-      result->Error("rtpSenderReplaceTrack",
-                    "rtpSenderReplaceTrack() rtpSenderId is null or empty");
-      return;
-    }
-    RtpSenderReplaceTrack(pc, track, rtpSenderId, std::move(result));
-  } else if (method_call.method_name().compare("rtpSenderSetParameters") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpSenderSetParameters",
-                    "rtpSenderSetParameters() peerConnection is null");
-      return;
-    }
+  std::string sourceId = findString(params, "sourceId");
+  if (sourceId.empty()) {
+    result->Error("Bad Arguments", "Incorrect sourceId");
+    return;
+  }
+  const EncodableMap& thumbnailSize = findMap(params, "thumbnailSize");
+  if (!thumbnailSize.empty()) {
+    int width = 0;
+    int height = 0;
+    GetDesktopSourceThumbnail(sourceId, width, height, std::move(result));
+  } else {
+    result->Error("Bad Arguments", "Bad arguments received");
+  }
+}
 
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-    if (rtpSenderId.empty()) {
-      result->Error("rtpSenderSetParameters",
-                    "rtpSenderSetParameters() rtpSenderId is null or empty");
-      return;
-    }
+void FlutterWebRTC::HandleCreatePeerConnection(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const EncodableMap& configuration = findMap(params, "configuration");
+  const EncodableMap& constraints = findMap(params, "constraints");
+  CreateRTCPeerConnection(configuration, constraints, std::move(result));
+}
 
-    const EncodableMap parameters = findMap(params, "parameters");
-    if (0 == parameters.size()) {
-      result->Error("rtpSenderSetParameters",
-                    "rtpSenderSetParameters() parameters is null or empty");
-      return;
-    }
+void FlutterWebRTC::HandleCreateOffer(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  OfferAnswerArguments args;
+  if (!OfferAnswerSchema().Decode(method_call, &args, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("createOfferFailed",
+                  "createOffer() peerConnection is null");
+    return;
+  }
+  static const EncodableMap kNoConstraints;
+  CreateOffer(args.constraints ? *args.constraints : kNoConstraints, pc,
+              std::move(result));
+}
 
-    RtpSenderSetParameters(pc, rtpSenderId, parameters, std::move(result));
-  } else if (method_call.method_name().compare("rtpTransceiverStop") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpTransceiverStop",
-                    "rtpTransceiverStop() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleCreateAnswer(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  OfferAnswerArguments args;
+  if (!OfferAnswerSchema().Decode(method_call, &args, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("createAnswerFailed",
+                  "createAnswer() peerConnection is null");
+    return;
+  }
+  static const EncodableMap kNoConstraints;
+  CreateAnswer(args.constraints ? *args.constraints : kNoConstraints, pc,
+              std::move(result));
+}
 
-    const std::string transceiverId = findString(params, "transceiverId");
-    if (transceiverId.empty()) {
-      result->Error("rtpTransceiverStop",
-                    "rtpTransceiverStop() transceiverId is null or empty");
-      return;
-    }
+void FlutterWebRTC::HandleAddStream(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string streamId = findString(params, "streamId");
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
+  if (!stream) {
+    result->Error("addStreamFailed", "addStream() stream not found!");
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("addStreamFailed", "addStream() peerConnection is null");
+    return;
+  }
+  pc->AddStream(stream);
+  result->Success();
+}
 
-    RtpTransceiverStop(pc, transceiverId, std::move(result));
-  } else if (method_call.method_name().compare(
-                 "rtpTransceiverGetCurrentDirection") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error(
-          "rtpTransceiverGetCurrentDirection",
-          "rtpTransceiverGetCurrentDirection() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleRemoveStream(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string streamId = findString(params, "streamId");
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  scoped_refptr<RTCMediaStream> stream = MediaStreamForId(streamId);
+  if (!stream) {
+    result->Error("removeStreamFailed", "removeStream() stream not found!");
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("removeStreamFailed",
+                  "removeStream() peerConnection is null");
+    return;
+  }
+  pc->RemoveStream(stream);
+  result->Success();
+}
 
-    const std::string transceiverId = findString(params, "transceiverId");
-    if (transceiverId.empty()) {
-      result->Error("rtpTransceiverGetCurrentDirection",
-                    "rtpTransceiverGetCurrentDirection() transceiverId is "
-                    "null or empty");
-      return;
-    }
+void FlutterWebRTC::HandleSetLocalDescription(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  SetDescriptionArguments args;
+  SessionDescriptionArguments sdp;
+  if (!SetDescriptionSchema().Decode(method_call, &args, result.get()) ||
+      !DecodeSessionDescription(method_call.method_name(), *args.description,
+                                &sdp, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("setLocalDescriptionFailed",
+                  "setLocalDescription() peerConnection is null");
+    return;
+  }
 
-    RtpTransceiverGetCurrentDirection(pc, transceiverId, std::move(result));
-  } else if (method_call.method_name().compare("rtpTransceiverSetDirection") ==
-             0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("rtpTransceiverSetDirection",
-                    "rtpTransceiverSetDirection() peerConnection is null");
-      return;
-    }
+  SdpParseError error;
+  scoped_refptr<RTCSessionDescription> description =
+      RTCSessionDescription::Create(sdp.type.c_str(), sdp.sdp.c_str(), &error);
 
-    const std::string transceiverId = findString(params, "transceiverId");
-    if (transceiverId.empty()) {
-      result->Error("rtpTransceiverSetDirection",
-                    "rtpTransceiverSetDirection() transceiverId is "
-                    "null or empty");
-      return;
-    }
+  if (description.get() != nullptr) {
+    SetLocalDescription(description.get(), pc, std::move(result));
+  } else {
+    result->Error("setLocalDescriptionFailed", "Invalid type or sdp");
+  }
+}
 
-    const std::string direction = findString(params, "direction");
-    if (transceiverId.empty()) {
-      result->Error("rtpTransceiverSetDirection",
-                    "rtpTransceiverSetDirection() direction is null or empty");
-      return;
-    }
-
-    RtpTransceiverSetDirection(pc, transceiverId, direction, std::move(result));
-  } else if (method_call.method_name().compare("setConfiguration") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("setConfiguration",
-                    "setConfiguration() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleSetRemoteDescription(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  SetDescriptionArguments args;
+  SessionDescriptionArguments sdp;
+  if (!SetDescriptionSchema().Decode(method_call, &args, result.get()) ||
+      !DecodeSessionDescription(method_call.method_name(), *args.description,
+                                &sdp, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("setRemoteDescriptionFailed",
+                  "setRemoteDescription() peerConnection is null");
+    return;
+  }
 
-    const EncodableMap configuration = findMap(params, "configuration");
-    if (configuration.empty()) {
-      result->Error("setConfiguration",
-                    "setConfiguration() configuration is null or empty");
-      return;
-    }
-    SetConfiguration(pc, configuration, std::move(result));
-  } else if (method_call.method_name().compare("captureFrame") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  SdpParseError error;
+  scoped_refptr<RTCSessionDescription> description =
+      RTCSessionDescription::Create(sdp.type.c_str(), sdp.sdp.c_str(), &error);
 
-    const std::string path = findString(params, "path");
-    if (path.empty()) {
-      result->Error("captureFrame", "captureFrame() path is null or empty");
-      return;
-    }
+  if (description.get() != nullptr) {
+    SetRemoteDescription(description.get(), pc, std::move(result));
+  } else {
+    result->Error("setRemoteDescriptionFailed", "Invalid type or sdp");
+  }
+}
 
-    const std::string trackId = findString(params, "trackId");
-    RTCMediaTrack* track = MediaTrackForId(trackId);
-    if (nullptr == track) {
-      result->Error("captureFrame", "captureFrame() track is null");
-      return;
-    }
-    std::string kind = track->kind().std_string();
-    if (0 != kind.compare("video")) {
-      result->Error("captureFrame", "captureFrame() track not is video track");
-      return;
-    }
-    CaptureFrame(reinterpret_cast<RTCVideoTrack*>(track), path,
-                 std::move(result));
-
-  } else if (method_call.method_name().compare("createLocalMediaStream") == 0) {
-    CreateLocalMediaStream(std::move(result));
-  } else if (method_call.method_name().compare("canInsertDtmf") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("canInsertDtmf", "canInsertDtmf() peerConnection is null");
-      return;
-    }
+void FlutterWebRTC::HandleAddCandidate(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  static const ArgumentSchema<AddCandidateArguments> schema =
+      ArgumentSchema<AddCandidateArguments>()
+          .Required(kPeerConnectionIdKey,
+                    &AddCandidateArguments::peer_connection_id)
+          .Required(kCandidateKey, &AddCandidateArguments::candidate);
+  // The candidate fields are all optional: an empty candidate marks the
+  // end of candidates.
+  static const ArgumentSchema<IceCandidateArguments> candidate_schema =
+      ArgumentSchema<IceCandidateArguments>()
+          .Optional(kCandidateKey, &IceCandidateArguments::candidate)
+          .Optional(kSdpMidKey, &IceCandidateArguments::sdp_mid)
+          .Optional(kSdpMLineIndexKey, &IceCandidateArguments::sdp_mline_index);
+
+  AddCandidateArguments args;
+  if (!schema.Decode(method_call, &args, result.get())) {
+    return;
+  }
+  IceCandidateArguments candidate;
+  std::string decode_error;
+  if (!candidate_schema.Decode(*args.candidate, &candidate, &decode_error)) {
+    result->Error("Bad Arguments", "addCandidate() candidate " + decode_error);
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("addCandidateFailed",
+                  "addCandidate() peerConnection is null");
+    return;
+  }
 
-    auto rtpSender = GetRtpSenderById(pc, rtpSenderId);
+  SdpParseError error;
+  if (candidate.candidate.empty()) {
+    // received the end-of-candidates
+    result->Success();
+    return;
+  }
+  scoped_refptr<RTCIceCandidate> rtc_candidate = RTCIceCandidate::Create(
+      candidate.candidate.c_str(), candidate.sdp_mid.c_str(),
+      candidate.sdp_mline_index, &error);
 
-    if (rtpSender == nullptr) {
-      result->Error("sendDtmf", "sendDtmf() rtpSender is null");
-      return;
-    }
-    auto dtmfSender = rtpSender->dtmf_sender();
-    bool canInsertDtmf = dtmfSender->CanInsertDtmf();
-
-    result->Success(EncodableValue(canInsertDtmf));
-  } else if (method_call.method_name().compare("sendDtmf") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    const std::string rtpSenderId = findString(params, "rtpSenderId");
-    const std::string tone = findString(params, "tone");
-    int duration = findInt(params, "duration");
-    int gap = findInt(params, "gap");
-
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("sendDtmf", "sendDtmf() peerConnection is null");
-      return;
-    }
+  if (rtc_candidate.get() != nullptr) {
+    AddIceCandidate(rtc_candidate.get(), pc, std::move(result));
+  } else {
+    result->Error("addCandidateFailed", "Invalid candidate");
+  }
+}
 
-    auto rtpSender = GetRtpSenderById(pc, rtpSenderId);
+void FlutterWebRTC::HandleGetStats(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  static const ArgumentSchema<GetStatsArguments> schema =
+      ArgumentSchema<GetStatsArguments>()
+          .Required(kPeerConnectionIdKey,
+                    &GetStatsArguments::peer_connection_id)
+          .Optional(kTrackIdKey, &GetStatsArguments::track_id);
+
+  GetStatsArguments args;
+  if (!schema.Decode(method_call, &args, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("getStatsFailed", "getStats() peerConnection is null");
+    return;
+  }
+  GetStats(args.track_id, pc, std::move(result));
+}
 
-    if (rtpSender == nullptr) {
-      result->Error("sendDtmf", "sendDtmf() rtpSender is null");
-      return;
-    }
+void FlutterWebRTC::HandleRestartIce(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("restartIceFailed", "restartIce() peerConnection is null");
+    return;
+  }
+  pc->RestartIce();
+  result->Success();
+}
 
-    auto dtmfSender = rtpSender->dtmf_sender();
-    dtmfSender->InsertDtmf(tone, duration, gap);
+void FlutterWebRTC::HandlePeerConnectionClose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("peerConnectionCloseFailed",
+                  "peerConnectionClose() peerConnection is null");
+    return;
+  }
+  RTCPeerConnectionClose(pc, peerConnectionId, std::move(result));
+}
 
+void FlutterWebRTC::HandlePeerConnectionDispose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
     result->Success();
-  } else if (method_call.method_name().compare("getRtpSenderCapabilities") ==
-             0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-
-    RTCMediaType mediaType = RTCMediaType::AUDIO;
-    const std::string kind = findString(params, "kind");
-    if (0 == kind.compare("video")) {
-      mediaType = RTCMediaType::VIDEO;
-    } else if (0 == kind.compare("audio")) {
-      mediaType = RTCMediaType::AUDIO;
-    } else {
-      result->Error("getRtpSenderCapabilities",
-                    "getRtpSenderCapabilities() kind is null or empty");
-      return;
-    }
-    auto capabilities = factory_->GetRtpSenderCapabilities(mediaType);
-    EncodableMap map;
-    EncodableList codecsList;
-    for (auto codec : capabilities->codecs().std_vector()) {
-      EncodableMap codecMap;
-      codecMap[EncodableValue("mimeType")] =
-          EncodableValue(codec->mime_type().std_string());
-      codecMap[EncodableValue("clockRate")] =
-          EncodableValue(codec->clock_rate());
-      codecMap[EncodableValue("channels")] = EncodableValue(codec->channels());
-      codecMap[EncodableValue("sdpFmtpLine")] =
-          EncodableValue(codec->sdp_fmtp_line().std_string());
-      codecsList.push_back(EncodableValue(codecMap));
-    }
-    map[EncodableValue("codecs")] = EncodableValue(codecsList);
-    map[EncodableValue("headerExtensions")] = EncodableValue(EncodableList());
-    map[EncodableValue("fecMechanisms")] = EncodableValue(EncodableList());
-
-    result->Success(EncodableValue(map));
-  } else if (method_call.method_name().compare("getRtpReceiverCapabilities") ==
-             0) {
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-
-    RTCMediaType mediaType = RTCMediaType::AUDIO;
-    const std::string kind = findString(params, "kind");
-    if (0 == kind.compare("video")) {
-      mediaType = RTCMediaType::VIDEO;
-    } else if (0 == kind.compare("audio")) {
-      mediaType = RTCMediaType::AUDIO;
-    } else {
-      result->Error("getRtpSenderCapabilities",
-                    "getRtpSenderCapabilities() kind is null or empty");
-      return;
-    }
-    auto capabilities = factory_->GetRtpReceiverCapabilities(mediaType);
-    EncodableMap map;
-    EncodableList codecsList;
-    for (auto codec : capabilities->codecs().std_vector()) {
-      EncodableMap codecMap;
-      codecMap[EncodableValue("mimeType")] =
-          EncodableValue(codec->mime_type().std_string());
-      codecMap[EncodableValue("clockRate")] =
-          EncodableValue(codec->clock_rate());
-      codecMap[EncodableValue("channels")] = EncodableValue(codec->channels());
-      codecMap[EncodableValue("sdpFmtpLine")] =
-          EncodableValue(codec->sdp_fmtp_line().std_string());
-      codecsList.push_back(EncodableValue(codecMap));
-    }
-    map[EncodableValue("codecs")] = EncodableValue(codecsList);
-    map[EncodableValue("headerExtensions")] = EncodableValue(EncodableList());
-    map[EncodableValue("fecMechanisms")] = EncodableValue(EncodableList());
-
-    result->Success(EncodableValue(map));
-  } else if (method_call.method_name().compare("setCodecPreferences") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("setCodecPreferences",
-                    "setCodecPreferences() peerConnection is null");
-      return;
-    }
+    return;
+  }
+  RTCPeerConnectionDispose(pc, peerConnectionId, std::move(result));
+}
 
-    const std::string transceiverId = findString(params, "transceiverId");
-    if (transceiverId.empty()) {
-      result->Error("setCodecPreferences",
-                    "setCodecPreferences() transceiverId is null or empty");
-      return;
-    }
+void FlutterWebRTC::HandleGetLocalDescription(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("GetLocalDescription",
+                  "GetLocalDescription() peerConnection is null");
+    return;
+  }
 
-    const EncodableList codecs = findList(params, "codecs");
-    if (codecs.empty()) {
-      result->Error("Bad Arguments", "Codecs is required");
-      return;
-    }
-    RtpTransceiverSetCodecPreferences(pc, transceiverId, codecs,
-                                      std::move(result));
-  } else if (method_call.method_name().compare("getSignalingState") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  GetLocalDescription(pc, std::move(result));
+}
 
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
+void FlutterWebRTC::HandleGetRemoteDescription(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("GetRemoteDescription",
+                  "GetRemoteDescription() peerConnection is null");
+    return;
+  }
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getSignalingState",
-                    "getSignalingState() peerConnection is null");
-      return;
-    }
-    EncodableMap state;
-    state[EncodableValue("state")] =
-        signalingStateString(pc->signaling_state());
-    result->Success(EncodableValue(state));
-  } else if (method_call.method_name().compare("getIceGatheringState") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  GetRemoteDescription(pc, std::move(result));
+}
 
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
+void FlutterWebRTC::HandleAddTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getIceGatheringState",
-                    "getIceGatheringState() peerConnection is null");
-      return;
-    }
-    EncodableMap state;
-    state[EncodableValue("state")] =
-        iceGatheringStateString(pc->ice_gathering_state());
-    result->Success(EncodableValue(state));
-  } else if (method_call.method_name().compare("getIceConnectionState") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  const std::string trackId = findString(params, kTrackIdKey);
+  const EncodableList& streamIds = findList(params, "streamIds");
 
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("AddTrack", "AddTrack() peerConnection is null");
+    return;
+  }
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getIceConnectionState",
-                    "getIceConnectionState() peerConnection is null");
-      return;
-    }
-    EncodableMap state;
-    state[EncodableValue("state")] =
-        iceConnectionStateString(pc->ice_connection_state());
-    result->Success(EncodableValue(state));
-  } else if (method_call.method_name().compare("getConnectionState") == 0) {
-    if (!method_call.arguments()) {
-      result->Error("Bad Arguments", "Null constraints arguments received");
-      return;
-    }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+  scoped_refptr<RTCMediaTrack> track = MediaTracksForId(trackId);
+  if (track == nullptr) {
+    result->Error("AddTrack", "AddTrack() track is null");
+    return;
+  }
+  std::vector<std::string> ids;
+  for (EncodableValue value : streamIds) {
+    ids.push_back(GetValue<std::string>(value));
+  }
 
-    const std::string peerConnectionId = findString(params, "peerConnectionId");
+  AddTrack(pc, track, ids, std::move(result));
+}
 
-    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
-    if (pc == nullptr) {
-      result->Error("getConnectionState",
-                    "getConnectionState() peerConnection is null");
-      return;
-    }
-    EncodableMap state;
-    state[EncodableValue("state")] =
-        peerConnectionStateString(pc->peer_connection_state());
-    result->Success(EncodableValue(state));
+void FlutterWebRTC::HandleRemoveTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  const std::string senderId = findString(params, "senderId");
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("removeTrack", "removeTrack() peerConnection is null");
+    return;
+  }
+
+  RemoveTrack(pc, senderId, std::move(result));
+}
+
+void FlutterWebRTC::HandleAddTransceiver(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  const EncodableMap& transceiverInit = findMap(params, "transceiverInit");
+  const std::string mediaType = findString(params, "mediaType");
+  const std::string trackId = findString(params, kTrackIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("addTransceiver",
+                  "addTransceiver() peerConnection is null");
+    return;
+  }
+  AddTransceiver(pc, trackId, mediaType, transceiverInit, std::move(result));
+}
+
+void FlutterWebRTC::HandleGetTransceivers(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getTransceivers",
+                  "getTransceivers() peerConnection is null");
+    return;
+  }
+
+  GetTransceivers(pc, std::move(result));
+}
+
+void FlutterWebRTC::HandleGetReceivers(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getReceivers", "getReceivers() peerConnection is null");
+    return;
+  }
+
+  GetReceivers(pc, std::move(result));
+}
+
+void FlutterWebRTC::HandleGetSenders(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getSenders", "getSenders() peerConnection is null");
+    return;
+  }
+
+  GetSenders(pc, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpSenderSetTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpSenderSetTrack",
+                  "rtpSenderSetTrack() peerConnection is null");
+    return;
+  }
+
+  const std::string trackId = findString(params, kTrackIdKey);
+  RTCMediaTrack* track = MediaTrackForId(trackId);
+
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+  if (rtpSenderId.empty()) {
+    result->Error("rtpSenderSetTrack",
+                  "rtpSenderSetTrack() rtpSenderId is null or empty");
+    return;
+  }
+  RtpSenderSetTrack(pc, track, rtpSenderId, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpSenderSetStreams(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpSenderSetStream",
+                  "rtpSenderSetStream() peerConnection is null");
+    return;
+  }
+
+  const EncodableList& encodableStreamIds = findList(params, "streamIds");
+  if (encodableStreamIds.empty()) {
+    result->Error("rtpSenderSetStream",
+                  "rtpSenderSetStream() streamId is null or empty");
+    return;
+  }
+  std::vector<std::string> streamIds{};
+  for (EncodableValue value : encodableStreamIds) {
+    streamIds.push_back(GetValue<std::string>(value));
+  }
+
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+  if (rtpSenderId.empty()) {
+    result->Error("rtpSenderSetStream",
+                  "rtpSenderSetStream() rtpSenderId is null or empty");
+    return;
+  }
+  RtpSenderSetStream(pc, streamIds, rtpSenderId, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpSenderReplaceTrack(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpSenderReplaceTrack",
+                  "rtpSenderReplaceTrack() peerConnection is null");
+    return;
+  }
+
+  const std::string trackId = findString(params, kTrackIdKey);
+  RTCMediaTrack* track = MediaTrackForId(trackId);
+
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+  if (rtpSenderId.empty()) {
+    result->Error("rtpSenderReplaceTrack",
+                  "rtpSenderReplaceTrack() rtpSenderId is null or empty");
+    return;
+  }
+  RtpSenderReplaceTrack(pc, track, rtpSenderId, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpSenderSetParameters(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpSenderSetParameters",
+                  "rtpSenderSetParameters() peerConnection is null");
+    return;
+  }
+
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+  if (rtpSenderId.empty()) {
+    result->Error("rtpSenderSetParameters",
+                  "rtpSenderSetParameters() rtpSenderId is null or empty");
+    return;
+  }
+
+  const EncodableMap& parameters = findMap(params, "parameters");
+  if (0 == parameters.size()) {
+    result->Error("rtpSenderSetParameters",
+                  "rtpSenderSetParameters() parameters is null or empty");
+    return;
+  }
+
+  RtpSenderSetParameters(pc, rtpSenderId, parameters, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpTransceiverStop(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpTransceiverStop",
+                  "rtpTransceiverStop() peerConnection is null");
+    return;
+  }
+
+  const std::string transceiverId = findString(params, "transceiverId");
+  if (transceiverId.empty()) {
+    result->Error("rtpTransceiverStop",
+                  "rtpTransceiverStop() transceiverId is null or empty");
+    return;
+  }
+
+  RtpTransceiverStop(pc, transceiverId, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpTransceiverGetCurrentDirection(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error(
+        "rtpTransceiverGetCurrentDirection",
+        "rtpTransceiverGetCurrentDirection() peerConnection is null");
+    return;
+  }
+
+  const std::string transceiverId = findString(params, "transceiverId");
+  if (transceiverId.empty()) {
+    result->Error("rtpTransceiverGetCurrentDirection",
+                  "rtpTransceiverGetCurrentDirection() transceiverId is "
+                  "null or empty");
+    return;
+  }
+
+  RtpTransceiverGetCurrentDirection(pc, transceiverId, std::move(result));
+}
+
+void FlutterWebRTC::HandleRtpTransceiverSetDirection(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("rtpTransceiverSetDirection",
+                  "rtpTransceiverSetDirection() peerConnection is null");
+    return;
+  }
+
+  const std::string transceiverId = findString(params, "transceiverId");
+  if (transceiverId.empty()) {
+    result->Error("rtpTransceiverSetDirection",
+                  "rtpTransceiverSetDirection() transceiverId is "
+                  "null or empty");
+    return;
+  }
+
+  const std::string direction = findString(params, "direction");
+  if (transceiverId.empty()) {
+    result->Error("rtpTransceiverSetDirection",
+                  "rtpTransceiverSetDirection() direction is null or empty");
+    return;
+  }
+
+  RtpTransceiverSetDirection(pc, transceiverId, direction, std::move(result));
+}
+
+void FlutterWebRTC::HandleSetConfiguration(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("setConfiguration",
+                  "setConfiguration() peerConnection is null");
+    return;
+  }
+
+  const EncodableMap& configuration = findMap(params, "configuration");
+  if (configuration.empty()) {
+    result->Error("setConfiguration",
+                  "setConfiguration() configuration is null or empty");
+    return;
+  }
+  SetConfiguration(pc, configuration, std::move(result));
+}
+
+void FlutterWebRTC::HandleCanInsertDtmf(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("canInsertDtmf", "canInsertDtmf() peerConnection is null");
+    return;
+  }
+
+  auto rtpSender = GetRtpSenderById(pc, rtpSenderId);
+
+  if (rtpSender == nullptr) {
+    result->Error("sendDtmf", "sendDtmf() rtpSender is null");
+    return;
+  }
+  auto dtmfSender = rtpSender->dtmf_sender();
+  bool canInsertDtmf = dtmfSender->CanInsertDtmf();
+
+  result->Success(EncodableValue(canInsertDtmf));
+}
+
+void FlutterWebRTC::HandleSendDtmf(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  const std::string rtpSenderId = findString(params, "rtpSenderId");
+  const std::string tone = findString(params, "tone");
+  int duration = findInt(params, "duration");
+  int gap = findInt(params, "gap");
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("sendDtmf", "sendDtmf() peerConnection is null");
+    return;
+  }
+
+  auto rtpSender = GetRtpSenderById(pc, rtpSenderId);
+
+  if (rtpSender == nullptr) {
+    result->Error("sendDtmf", "sendDtmf() rtpSender is null");
+    return;
+  }
+
+  auto dtmfSender = rtpSender->dtmf_sender();
+  dtmfSender->InsertDtmf(tone, duration, gap);
+
+  result->Success();
+}
+
+void FlutterWebRTC::HandleGetRtpSenderCapabilities(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  RTCMediaType mediaType = RTCMediaType::AUDIO;
+  const std::string kind = findString(params, "kind");
+  if (0 == kind.compare("video")) {
+    mediaType = RTCMediaType::VIDEO;
+  } else if (0 == kind.compare("audio")) {
+    mediaType = RTCMediaType::AUDIO;
   } else {
-    if (HandleFrameCryptorMethodCall(method_call, std::move(result), &result)) {
-      return;
-    } else {
-      result->NotImplemented();
-    }
+    result->Error("getRtpSenderCapabilities",
+                  "getRtpSenderCapabilities() kind is null or empty");
+    return;
+  }
+  auto capabilities = factory_->GetRtpSenderCapabilities(mediaType);
+  EncodableMap map;
+  EncodableList codecsList;
+  for (auto codec : capabilities->codecs().std_vector()) {
+    EncodableMap codecMap;
+    codecMap[EncodableValue("mimeType")] =
+        EncodableValue(codec->mime_type().std_string());
+    codecMap[EncodableValue("clockRate")] =
+        EncodableValue(codec->clock_rate());
+    codecMap[EncodableValue("channels")] = EncodableValue(codec->channels());
+    codecMap[EncodableValue("sdpFmtpLine")] =
+        EncodableValue(codec->sdp_fmtp_line().std_string());
+    codecsList.push_back(EncodableValue(codecMap));
+  }
+  map[EncodableValue("codecs")] = EncodableValue(codecsList);
+  map[EncodableValue("headerExtensions")] = EncodableValue(EncodableList());
+  map[EncodableValue("fecMechanisms")] = EncodableValue(EncodableList());
+
+  result->Success(EncodableValue(map));
+}
+
+void FlutterWebRTC::HandleGetRtpReceiverCapabilities(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  RTCMediaType mediaType = RTCMediaType::AUDIO;
+  const std::string kind = findString(params, "kind");
+  if (0 == kind.compare("video")) {
+    mediaType = RTCMediaType::VIDEO;
+  } else if (0 == kind.compare("audio")) {
+    mediaType = RTCMediaType::AUDIO;
+  } else {
+    result->Error("getRtpSenderCapabilities",
+                  "getRtpSenderCapabilities() kind is null or empty");
+    return;
+  }
+  auto capabilities = factory_->GetRtpReceiverCapabilities(mediaType);
+  EncodableMap map;
+  EncodableList codecsList;
+  for (auto codec : capabilities->codecs().std_vector()) {
+    EncodableMap codecMap;
+    codecMap[EncodableValue("mimeType")] =
+        EncodableValue(codec->mime_type().std_string());
+    codecMap[EncodableValue("clockRate")] =
+        EncodableValue(codec->clock_rate());
+    codecMap[EncodableValue("channels")] = EncodableValue(codec->channels());
+    codecMap[EncodableValue("sdpFmtpLine")] =
+        EncodableValue(codec->sdp_fmtp_line().std_string());
+    codecsList.push_back(EncodableValue(codecMap));
+  }
+  map[EncodableValue("codecs")] = EncodableValue(codecsList);
+  map[EncodableValue("headerExtensions")] = EncodableValue(EncodableList());
+  map[EncodableValue("fecMechanisms")] = EncodableValue(EncodableList());
+
+  result->Success(EncodableValue(map));
+}
+
+void FlutterWebRTC::HandleSetCodecPreferences(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("setCodecPreferences",
+                  "setCodecPreferences() peerConnection is null");
+    return;
+  }
+
+  const std::string transceiverId = findString(params, "transceiverId");
+  if (transceiverId.empty()) {
+    result->Error("setCodecPreferences",
+                  "setCodecPreferences() transceiverId is null or empty");
+    return;
+  }
+
+  const EncodableList& codecs = findList(params, "codecs");
+  if (codecs.empty()) {
+    result->Error("Bad Arguments", "Codecs is required");
+    return;
+  }
+  RtpTransceiverSetCodecPreferences(pc, transceiverId, codecs,
+                                    std::move(result));
+}
+
+void FlutterWebRTC::HandleGetSignalingState(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getSignalingState",
+                  "getSignalingState() peerConnection is null");
+    return;
+  }
+  EncodableMap state;
+  state[EncodableValue("state")] =
+      signalingStateString(pc->signaling_state());
+  result->Success(EncodableValue(state));
+}
+
+void FlutterWebRTC::HandleGetIceGatheringState(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getIceGatheringState",
+                  "getIceGatheringState() peerConnection is null");
+    return;
+  }
+  EncodableMap state;
+  state[EncodableValue("state")] =
+      iceGatheringStateString(pc->ice_gathering_state());
+  result->Success(EncodableValue(state));
+}
+
+void FlutterWebRTC::HandleGetIceConnectionState(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getIceConnectionState",
+                  "getIceConnectionState() peerConnection is null");
+    return;
+  }
+  EncodableMap state;
+  state[EncodableValue("state")] =
+      iceConnectionStateString(pc->ice_connection_state());
+  result->Success(EncodableValue(state));
+}
+
+void FlutterWebRTC::HandleGetConnectionState(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("getConnectionState",
+                  "getConnectionState() peerConnection is null");
+    return;
+  }
+  EncodableMap state;
+  state[EncodableValue("state")] =
+      peerConnectionStateString(pc->peer_connection_state());
+  result->Success(EncodableValue(state));
+}
+
+void FlutterWebRTC::HandleCreateDataChannel(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("createDataChannelFailed",
+                  "createDataChannel() peerConnection is null");
+    return;
+  }
+
+  const std::string label = findString(params, "label");
+  const EncodableMap& dataChannelDict = findMap(params, "dataChannelDict");
+
+  CreateDataChannel(peerConnectionId, label, dataChannelDict, pc,
+                    std::move(result));
+}
+
+void FlutterWebRTC::HandleDataChannelSend(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  static const ArgumentSchema<DataChannelSendArguments> schema =
+      ArgumentSchema<DataChannelSendArguments>()
+          .Required(kPeerConnectionIdKey,
+                    &DataChannelSendArguments::peer_connection_id)
+          .Required(kDataChannelIdKey,
+                    &DataChannelSendArguments::data_channel_id)
+          .Required(kTypeKey, &DataChannelSendArguments::type)
+          .Required(kDataKey, &DataChannelSendArguments::data);
+
+  DataChannelSendArguments args;
+  if (!schema.Decode(method_call, &args, result.get())) {
+    return;
+  }
+  RTCPeerConnection* pc = PeerConnectionForId(args.peer_connection_id);
+  if (pc == nullptr) {
+    result->Error("dataChannelSendFailed",
+                  "dataChannelSend() peerConnection is null");
+    return;
+  }
+
+  RTCDataChannel* data_channel = DataChannelForId(args.data_channel_id);
+  if (data_channel == nullptr) {
+    result->Error("dataChannelSendFailed",
+                  "dataChannelSend() data_channel is null");
+    return;
+  }
+  DataChannelSend(data_channel, args.type, *args.data, std::move(result));
+}
+
+void FlutterWebRTC::HandleDataChannelClose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string peerConnectionId = findString(params, kPeerConnectionIdKey);
+  RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+  if (pc == nullptr) {
+    result->Error("dataChannelCloseFailed",
+                  "dataChannelClose() peerConnection is null");
+    return;
+  }
+
+  const std::string dataChannelId = findString(params, kDataChannelIdKey);
+  RTCDataChannel* data_channel = DataChannelForId(dataChannelId);
+  if (data_channel == nullptr) {
+    result->Error("dataChannelCloseFailed",
+                  "dataChannelClose() data_channel is null");
+    return;
+  }
+  DataChannelClose(data_channel, dataChannelId, std::move(result));
+}
+
+void FlutterWebRTC::HandleCreateVideoRenderer(
+    const MethodCallProxy& /*method_call*/,
+    std::unique_ptr<MethodResultProxy> result) {
+  CreateVideoRendererTexture(std::move(result));
+}
+
+void FlutterWebRTC::HandleVideoRendererDispose(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  int64_t texture_id = findLongInt(params, "textureId");
+  VideoRendererDispose(texture_id, std::move(result));
+}
+
+void FlutterWebRTC::HandleVideoRendererSetSrcObject(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  const std::string stream_id = findString(params, "streamId");
+  int64_t texture_id = findLongInt(params, "textureId");
+  const std::string owner_tag = findString(params, "ownerTag");
+  const std::string track_id = findString(params, kTrackIdKey);
+
+  VideoRendererSetSrcObject(texture_id, stream_id, owner_tag, track_id);
+  result->Success();
+}
+
+void FlutterWebRTC::HandleVideoRendererSetMaxFps(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  int64_t texture_id = findLongInt(params, "textureId");
+  double max_fps = findDouble(params, "maxFps");
+  VideoRendererSetMaxFps(texture_id, max_fps, std::move(result));
+}
+
+void FlutterWebRTC::HandleVideoRendererSetNativeRotation(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
+  }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  int64_t texture_id = findLongInt(params, "textureId");
+  bool enabled = findBoolean(params, "enabled");
+  VideoRendererSetNativeRotation(texture_id, enabled, std::move(result));
+}
+
+void FlutterWebRTC::HandleVideoRendererGetStats(
+    const MethodCallProxy& method_call,
+    std::unique_ptr<MethodResultProxy> result) {
+  if (!method_call.arguments()) {
+    result->Error("Bad Arguments", "Null constraints arguments received");
+    return;
   }
+  const EncodableMap& params =
+      GetValue<EncodableMap>(*method_call.arguments());
+  int64_t texture_id = findLongInt(params, "textureId");
+  VideoRendererGetStats(texture_id, std::move(result));
 }
 
 }  // namespace flutter_webrtc_plugin
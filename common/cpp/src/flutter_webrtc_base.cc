@@ -166,7 +166,7 @@ scoped_refptr<RTCMediaConstraints> FlutterWebRTCBase::ParseMediaConstraints(
 
   if (constraints.find(EncodableValue("mandatory")) != constraints.end()) {
     auto it = constraints.find(EncodableValue("mandatory"));
-    const EncodableMap mandatory = GetValue<EncodableMap>(it->second);
+    const EncodableMap& mandatory = GetValue<EncodableMap>(it->second);
     ParseConstraints(mandatory, media_constraints, kMandatory);
   } else {
     // Log.d(TAG, "mandatory constraints are not a map");
@@ -174,12 +174,12 @@ scoped_refptr<RTCMediaConstraints> FlutterWebRTCBase::ParseMediaConstraints(
 
   auto it = constraints.find(EncodableValue("optional"));
   if (it != constraints.end()) {
-    const EncodableValue optional = it->second;
+    const EncodableValue& optional = it->second;
     if (TypeIs<EncodableMap>(optional)) {
       ParseConstraints(GetValue<EncodableMap>(optional), media_constraints,
                        kOptional);
     } else if (TypeIs<EncodableList>(optional)) {
-      const EncodableList list = GetValue<EncodableList>(optional);
+      const EncodableList& list = GetValue<EncodableList>(optional);
       for (size_t i = 0; i < list.size(); i++) {
         ParseConstraints(GetValue<EncodableMap>(list[i]), media_constraints,
                          kOptional);
@@ -197,7 +197,8 @@ bool FlutterWebRTCBase::CreateIceServers(const EncodableList& iceServersArray,
   size_t size = iceServersArray.size();
   for (size_t i = 0; i < size; i++) {
     IceServer& ice_server = ice_servers[i];
-    EncodableMap iceServerMap = GetValue<EncodableMap>(iceServersArray[i]);
+    const EncodableMap& iceServerMap =
+        GetValue<EncodableMap>(iceServersArray[i]);
 
     if (iceServerMap.find(EncodableValue("username")) != iceServerMap.end()) {
       ice_server.username = GetValue<std::string>(
@@ -218,10 +219,10 @@ bool FlutterWebRTCBase::CreateIceServers(const EncodableList& iceServersArray,
         ice_server.uri = GetValue<std::string>(it->second);
       }
       if (TypeIs<EncodableList>(it->second)) {
-        const EncodableList urls = GetValue<EncodableList>(it->second);
-        for (auto url : urls) {
+        const EncodableList& urls = GetValue<EncodableList>(it->second);
+        for (const EncodableValue& url : urls) {
           if (TypeIs<EncodableMap>(url)) {
-            const EncodableMap map = GetValue<EncodableMap>(url);
+            const EncodableMap& map = GetValue<EncodableMap>(url);
             std::string value;
             auto it2 = map.find(EncodableValue("url"));
             if (it2 != map.end()) {
@@ -241,7 +242,8 @@ bool FlutterWebRTCBase::ParseRTCConfiguration(const EncodableMap& map,
                                               RTCConfiguration& conf) {
   auto it = map.find(EncodableValue("iceServers"));
   if (it != map.end()) {
-    const EncodableList iceServersArray = GetValue<EncodableList>(it->second);
+    const EncodableList& iceServersArray =
+        GetValue<EncodableList>(it->second);
     CreateIceServers(iceServersArray, conf.ice_servers);
   }
   // iceTransportPolicy (public API)
@@ -0,0 +1,243 @@
+// Checks every SIMD kernel this CPU supports against the scalar reference,
+// which they must match bit for bit, and the scaled paths against simple
+// expectations. Pass --bench to also time a 1080p conversion per kernel.
+
+#include "flutter_color_conversion.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace flutter_webrtc_plugin;
+
+namespace {
+
+const ColorKernel kKernels[] = {ColorKernel::kAVX2, ColorKernel::kSSE2,
+                                ColorKernel::kNEON, ColorKernel::kScalar};
+
+struct Frame {
+  int width;
+  int height;
+  int stride_y;
+  int stride_uv;
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+
+  Frame(int w, int h, int padding)
+      : width(w),
+        height(h),
+        stride_y(w + padding),
+        stride_uv((w + 1) / 2 + padding),
+        y(static_cast<size_t>(stride_y) * h),
+        u(static_cast<size_t>(stride_uv) * ((h + 1) / 2)),
+        v(u.size()) {}
+
+  I420Planes planes() const {
+    return {y.data(), u.data(),  v.data(), stride_y,
+            stride_uv, stride_uv, width,    height};
+  }
+};
+
+int g_failures = 0;
+
+void Expect(bool condition, const char* what, int a, int b, int c) {
+  if (!condition) {
+    std::printf("FAIL %s (%d, %d, %d)\n", what, a, b, c);
+    ++g_failures;
+  }
+}
+
+std::vector<uint8_t> Convert(ColorKernel kernel,
+                             const Frame& frame,
+                             int rotation,
+                             PixelOrder order,
+                             int width,
+                             int height) {
+  std::vector<uint8_t> out(static_cast<size_t>(width) * height * 4);
+  ConvertI420WithKernel(kernel, frame.planes(), rotation, order, out.data(),
+                        0, width, height);
+  return out;
+}
+
+// Random frames, sizes, rotations and scales, including odd sizes and the
+// row tails the SIMD kernels hand back to the scalar code.
+void TestKernelsMatchScalar() {
+  std::mt19937 random(1);
+  for (int i = 0; i < 500; ++i) {
+    Frame frame(1 + random() % 130, 1 + random() % 70, random() % 5);
+    for (auto* plane : {&frame.y, &frame.u, &frame.v}) {
+      for (uint8_t& sample : *plane) {
+        sample = static_cast<uint8_t>(random());
+      }
+    }
+    const int rotation = static_cast<int>(random() % 4) * 90;
+    const bool transposed = rotation == 90 || rotation == 270;
+    int width = transposed ? frame.height : frame.width;
+    int height = transposed ? frame.width : frame.height;
+    if (i % 3 == 1) {
+      width = 1 + random() % width;
+      height = 1 + random() % height;
+    } else if (i % 3 == 2) {
+      width = 1 + random() % (width * 2);
+      height = 1 + random() % (height * 2);
+    }
+    const PixelOrder order = i % 2 ? PixelOrder::kRGBA : PixelOrder::kBGRA;
+    const std::vector<uint8_t> reference =
+        Convert(ColorKernel::kScalar, frame, rotation, order, width, height);
+    for (ColorKernel kernel : kKernels) {
+      Expect(Convert(kernel, frame, rotation, order, width, height) ==
+                 reference,
+             ColorKernelName(kernel), width, height, rotation);
+    }
+  }
+}
+
+// A flat frame stays flat at every scale and rotation.
+void TestBoxFilterKeepsFlatColour() {
+  Frame frame(64, 48, 0);
+  std::memset(frame.y.data(), 120, frame.y.size());
+  std::memset(frame.u.data(), 90, frame.u.size());
+  std::memset(frame.v.data(), 200, frame.v.size());
+  const std::vector<uint8_t> pixel =
+      Convert(ColorKernel::kScalar, frame, 0, PixelOrder::kRGBA, 64, 48);
+  for (int rotation = 0; rotation < 360; rotation += 90) {
+    const std::vector<uint8_t> out = Convert(
+        ColorKernel::kScalar, frame, rotation, PixelOrder::kRGBA, 7, 5);
+    for (size_t i = 0; i < out.size(); ++i) {
+      Expect(out[i] == pixel[i % 4], "flat colour", rotation,
+             static_cast<int>(i), out[i]);
+    }
+  }
+}
+
+// Halving a one-pixel checkerboard averages it to grey where point
+// sampling would keep only one of the two colours.
+void TestBoxFilterAveragesDetail() {
+  Frame frame(32, 32, 0);
+  for (int row = 0; row < 32; ++row) {
+    for (int column = 0; column < 32; ++column) {
+      frame.y[row * 32 + column] = (row + column) % 2 ? 235 : 16;
+    }
+  }
+  std::memset(frame.u.data(), 128, frame.u.size());
+  std::memset(frame.v.data(), 128, frame.v.size());
+  const std::vector<uint8_t> out =
+      Convert(ColorKernel::kScalar, frame, 0, PixelOrder::kRGBA, 16, 16);
+  for (size_t i = 0; i < out.size(); i += 4) {
+    Expect(out[i] > 120 && out[i] < 135, "checkerboard", static_cast<int>(i),
+           out[i], 0);
+  }
+}
+
+// Downscaling a rotated frame matches downscaling the same frame rotated
+// beforehand.
+void TestBoxFilterRotation() {
+  std::mt19937 random(2);
+  Frame frame(40, 24, 3);
+  for (auto* plane : {&frame.y, &frame.u, &frame.v}) {
+    for (uint8_t& sample : *plane) {
+      sample = static_cast<uint8_t>(random());
+    }
+  }
+  for (int rotation = 90; rotation < 360; rotation += 90) {
+    const bool transposed = rotation != 180;
+    Frame rotated(transposed ? 24 : 40, transposed ? 40 : 24, 0);
+    const std::vector<uint8_t> upright =
+        Convert(ColorKernel::kScalar, frame, rotation, PixelOrder::kRGBA,
+                rotated.width, rotated.height);
+    // Rebuild the planes of the rotated frame by rotating each of them.
+    auto rotate = [rotation](const uint8_t* src, int stride, int width,
+                             int height, uint8_t* dst) {
+      const int out_width = rotation == 180 ? width : height;
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          int ox = x, oy = y;
+          if (rotation == 90) {
+            ox = height - 1 - y;
+            oy = x;
+          } else if (rotation == 180) {
+            ox = width - 1 - x;
+            oy = height - 1 - y;
+          } else {
+            ox = y;
+            oy = width - 1 - x;
+          }
+          dst[oy * out_width + ox] = src[y * stride + x];
+        }
+      }
+    };
+    rotate(frame.y.data(), frame.stride_y, 40, 24, rotated.y.data());
+    rotate(frame.u.data(), frame.stride_uv, 20, 12, rotated.u.data());
+    rotate(frame.v.data(), frame.stride_uv, 20, 12, rotated.v.data());
+    const std::vector<uint8_t> expected =
+        Convert(ColorKernel::kScalar, rotated, 0, PixelOrder::kRGBA,
+                rotated.width, rotated.height);
+    Expect(upright == expected, "rotation", rotation, 0, 0);
+    const int width = rotated.width / 4;
+    const int height = rotated.height / 4;
+    Expect(Convert(ColorKernel::kScalar, frame, rotation, PixelOrder::kRGBA,
+                   width, height) ==
+               Convert(ColorKernel::kScalar, rotated, 0, PixelOrder::kRGBA,
+                       width, height),
+           "rotated downscale", rotation, width, height);
+  }
+}
+
+void Bench() {
+  Frame frame(1920, 1080, 0);
+  std::mt19937 random(3);
+  for (auto* plane : {&frame.y, &frame.u, &frame.v}) {
+    for (uint8_t& sample : *plane) {
+      sample = static_cast<uint8_t>(random());
+    }
+  }
+  struct Case {
+    const char* name;
+    int rotation;
+    int width;
+    int height;
+  };
+  const Case cases[] = {{"1080p", 0, 1920, 1080},
+                        {"1080p rotated", 90, 1080, 1920},
+                        {"1080p to 360p", 0, 640, 360}};
+  std::vector<uint8_t> out(1920 * 1080 * 4);
+  for (const Case& c : cases) {
+    for (ColorKernel kernel : kKernels) {
+      // Kernels the CPU lacks would silently time the scalar fallback.
+      const ColorKernel active = ActiveColorKernel();
+      if (kernel != ColorKernel::kScalar && kernel != active &&
+          !(active == ColorKernel::kAVX2 && kernel == ColorKernel::kSSE2)) {
+        continue;
+      }
+      const int runs = 50;
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < runs; ++i) {
+        ConvertI420WithKernel(kernel, frame.planes(), c.rotation,
+                              PixelOrder::kRGBA, out.data(), 0, c.width,
+                              c.height);
+      }
+      const std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      std::printf("%-14s %-7s %7.2f ms\n", c.name, ColorKernelName(kernel),
+                  elapsed.count() / runs);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::printf("active kernel: %s\n", ColorKernelName(ActiveColorKernel()));
+  TestKernelsMatchScalar();
+  TestBoxFilterKeepsFlatColour();
+  TestBoxFilterAveragesDetail();
+  TestBoxFilterRotation();
+  if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+    Bench();
+  }
+  std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+  return g_failures ? 1 : 0;
+}
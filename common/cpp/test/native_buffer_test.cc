@@ -0,0 +1,146 @@
+// Checks that a frame leased from a NativeBuffer neither holds up the ring
+// nor changes under its holder, and that filled pushes land in place, in
+// both buffer modes.
+
+#include "NativeBuffer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int kCapacity = 10;
+
+int g_failures = 0;
+
+void Expect(bool condition, const char* what, int a, int b, int c) {
+  if (!condition) {
+    std::printf("FAIL %s (%d, %d, %d)\n", what, a, b, c);
+    ++g_failures;
+  }
+}
+
+int PushNumbered(NativeBuffer& buffer, int number) {
+  std::vector<uint8_t> payload(64, static_cast<uint8_t>(number));
+  return buffer.pushAudioFrame(payload.data(), payload.size(), 48000, 1,
+                               static_cast<uint64_t>(number));
+}
+
+bool HoldsNumber(const MediaFrame* frame, int number) {
+  if (frame->frameTime != static_cast<uint64_t>(number) ||
+      frame->bufferSize != 64) {
+    return false;
+  }
+  for (size_t i = 0; i < frame->bufferSize; ++i) {
+    if (frame->buffer[i] != static_cast<uint8_t>(number)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// One lease held while the producer wraps around the ring several times.
+// Every policy must accept the first kCapacity pushes, since the leased
+// frame no longer occupies the ring; DROP_OLDEST must accept all of them.
+void TestLeaseDoesNotStallRing(BufferMode mode, OverflowPolicy policy) {
+  auto buffer =
+      std::make_shared<NativeBuffer>(kCapacity, 64, mode, policy);
+  Expect(PushNumbered(*buffer, 0) == PUSH_RESULT_OK, "first push", mode,
+         policy, 0);
+  MediaFrame* leased = buffer->acquireFrame();
+  Expect(leased != nullptr, "acquire", mode, policy, 0);
+  if (!leased) {
+    return;
+  }
+
+  const int pushes =
+      policy == OVERFLOW_POLICY_DROP_OLDEST ? 4 * kCapacity : kCapacity;
+  for (int i = 1; i <= pushes; ++i) {
+    Expect(PushNumbered(*buffer, i) == PUSH_RESULT_OK, "push with lease held",
+           mode, policy, i);
+  }
+  Expect(HoldsNumber(leased, 0), "leased frame unchanged", mode, policy, 0);
+
+  // The ring holds the newest kCapacity frames, in order.
+  MediaFrame* frames[kCapacity + 1] = {};
+  const size_t count = buffer->acquireFrames(frames, kCapacity + 1);
+  Expect(count == static_cast<size_t>(kCapacity), "queued count", mode,
+         policy, static_cast<int>(count));
+  for (size_t i = 0; i < count; ++i) {
+    const int number = pushes - kCapacity + 1 + static_cast<int>(i);
+    Expect(HoldsNumber(frames[i], number), "queued frame", mode, policy,
+           number);
+    NativeBuffer::releaseFrame(frames[i]);
+  }
+  NativeBuffer::releaseFrame(leased);
+
+  // Released slots are writable again.
+  for (int i = 0; i < kCapacity; ++i) {
+    Expect(PushNumbered(*buffer, 100 + i) == PUSH_RESULT_OK,
+           "push after release", mode, policy, i);
+  }
+}
+
+// A lease released before the producer reaches it returns its slot as usual.
+void TestReleasedLeaseKeepsSlot(BufferMode mode) {
+  auto buffer = std::make_shared<NativeBuffer>(kCapacity, 64, mode,
+                                               OVERFLOW_POLICY_DROP_NEWEST);
+  for (int round = 0; round < 3 * kCapacity; ++round) {
+    Expect(PushNumbered(*buffer, round) == PUSH_RESULT_OK, "push", mode,
+           round, 0);
+    MediaFrame* frame = buffer->acquireFrame();
+    Expect(frame && HoldsNumber(frame, round), "acquire", mode, round, 0);
+    if (frame) {
+      NativeBuffer::releaseFrame(frame);
+    }
+  }
+}
+
+bool FillNumbered(uint8_t* dst, size_t size, void* context) {
+  std::memset(dst, *static_cast<int*>(context), size);
+  return true;
+}
+
+bool FailFill(uint8_t*, size_t, void*) {
+  return false;
+}
+
+// A filled push writes straight into the slot; a failed fill queues nothing.
+void TestFilledPush(BufferMode mode) {
+  auto buffer = std::make_shared<NativeBuffer>(kCapacity, 64, mode,
+                                               OVERFLOW_POLICY_DROP_NEWEST);
+  int number = 7;
+  Expect(buffer->pushAudioFrameFilled(FillNumbered, &number, 64, 48000, 1,
+                                      7) == PUSH_RESULT_OK,
+         "filled push", mode, 0, 0);
+  Expect(buffer->pushAudioFrameFilled(FailFill, nullptr, 64, 48000, 1, 8) ==
+             PUSH_RESULT_ERROR,
+         "failed fill", mode, 0, 0);
+  MediaFrame* frames[2] = {};
+  const size_t count = buffer->acquireFrames(frames, 2);
+  Expect(count == 1, "filled count", mode, static_cast<int>(count), 0);
+  if (count > 0) {
+    Expect(HoldsNumber(frames[0], 7), "filled frame", mode, 0, 0);
+    NativeBuffer::releaseFrame(frames[0]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  const BufferMode modes[] = {BUFFER_MODE_LOCKED, BUFFER_MODE_SPSC};
+  const OverflowPolicy policies[] = {OVERFLOW_POLICY_BLOCK,
+                                     OVERFLOW_POLICY_DROP_OLDEST,
+                                     OVERFLOW_POLICY_DROP_NEWEST};
+  for (BufferMode mode : modes) {
+    for (OverflowPolicy policy : policies) {
+      TestLeaseDoesNotStallRing(mode, policy);
+    }
+    TestReleasedLeaseKeepsSlot(mode);
+    TestFilledPush(mode);
+  }
+  std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Checks that the standard codec's counting pass sizes a value exactly,
+// padding included, and that the pre-sized encoders write the same bytes as
+// a plain growing buffer.
+
+#include "byte_buffer_streams.h"
+#include "flutter/standard_codec_serializer.h"
+#include "flutter/standard_message_codec.h"
+#include "flutter/standard_method_codec.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using flutter::ByteBufferStreamWriter;
+using flutter::ByteCountingStreamWriter;
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using flutter::StandardCodecSerializer;
+
+int g_failures = 0;
+
+void Expect(bool condition, const char* what, int a, int b, int c) {
+  if (!condition) {
+    std::printf("FAIL %s (%d, %d, %d)\n", what, a, b, c);
+    ++g_failures;
+  }
+}
+
+// A getStats-like reply: nested maps and lists holding every typed list, so
+// each alignment rule is hit at several offsets.
+EncodableValue MakeNestedValue(int variant) {
+  EncodableList reports;
+  for (int i = 0; i <= variant; ++i) {
+    EncodableMap report;
+    report[EncodableValue("id")] = EncodableValue("RTCInboundRTPVideoStream");
+    report[EncodableValue("bytesReceived")] =
+        EncodableValue(static_cast<int64_t>(1) << (32 + i));
+    report[EncodableValue("jitter")] = EncodableValue(0.25 * i);
+    report[EncodableValue("thumbnail")] =
+        EncodableValue(std::vector<uint8_t>(3 + i, 0x5a));
+    report[EncodableValue("ssrcs")] =
+        EncodableValue(std::vector<int32_t>(1 + i, 1234));
+    report[EncodableValue("timestamps")] =
+        EncodableValue(std::vector<int64_t>(2, -i));
+    report[EncodableValue("levels")] =
+        EncodableValue(std::vector<float>(1 + i, 0.5f));
+    report[EncodableValue("samples")] =
+        EncodableValue(std::vector<double>(1 + i, 1.5));
+    report[EncodableValue("muted")] = EncodableValue(i % 2 == 0);
+    report[EncodableValue("codec")] = EncodableValue();
+    reports.push_back(EncodableValue(report));
+  }
+  EncodableMap reply;
+  reply[EncodableValue("reports")] = EncodableValue(reports);
+  reply[EncodableValue("count")] = EncodableValue(variant);
+  return EncodableValue(reply);
+}
+
+// Writing at an odd offset shifts every padding run, which a counter that
+// ignored alignment would get wrong.
+void TestCountMatchesWrite(int variant, size_t prefix) {
+  const EncodableValue value = MakeNestedValue(variant);
+  const StandardCodecSerializer& serializer =
+      StandardCodecSerializer::GetInstance();
+
+  std::vector<uint8_t> written;
+  ByteBufferStreamWriter writer(&written);
+  ByteCountingStreamWriter counter;
+  for (size_t i = 0; i < prefix; ++i) {
+    writer.WriteByte(0);
+    counter.WriteByte(0);
+  }
+  serializer.WriteValue(value, &writer);
+  serializer.WriteValue(value, &counter);
+  Expect(counter.size() == written.size(), "counted size", variant,
+         static_cast<int>(prefix), static_cast<int>(counter.size()));
+}
+
+void TestMessageCodec(int variant) {
+  const EncodableValue value = MakeNestedValue(variant);
+  std::vector<uint8_t> expected;
+  ByteBufferStreamWriter writer(&expected);
+  StandardCodecSerializer::GetInstance().WriteValue(value, &writer);
+
+  const auto& codec = flutter::StandardMessageCodec::GetInstance();
+  auto encoded = codec.EncodeMessage(value);
+  Expect(*encoded == expected, "message bytes", variant,
+         static_cast<int>(encoded->size()), static_cast<int>(expected.size()));
+  Expect(encoded->capacity() == encoded->size(), "message sized once",
+         variant, static_cast<int>(encoded->capacity()), 0);
+
+  auto decoded = codec.DecodeMessage(*encoded);
+  Expect(decoded && *decoded == value, "message round trip", variant, 0, 0);
+}
+
+void TestSuccessEnvelope(int variant) {
+  const EncodableValue value = MakeNestedValue(variant);
+  std::vector<uint8_t> expected(1, 0);
+  ByteBufferStreamWriter writer(&expected);
+  StandardCodecSerializer::GetInstance().WriteValue(value, &writer);
+
+  const auto& codec = flutter::StandardMethodCodec::GetInstance();
+  auto encoded = codec.EncodeSuccessEnvelope(&value);
+  Expect(*encoded == expected, "envelope bytes", variant,
+         static_cast<int>(encoded->size()), static_cast<int>(expected.size()));
+  Expect(encoded->capacity() == encoded->size(), "envelope sized once",
+         variant, static_cast<int>(encoded->capacity()), 0);
+}
+
+}  // namespace
+
+int main() {
+  for (int variant = 0; variant < 4; ++variant) {
+    for (size_t prefix = 0; prefix < 8; ++prefix) {
+      TestCountMatchesWrite(variant, prefix);
+    }
+    TestMessageCodec(variant);
+    TestSuccessEnvelope(variant);
+  }
+  std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+  return g_failures ? 1 : 0;
+}
@@ -12,6 +12,7 @@
 
 @implementation RTCAudioInterceptor {
     BOOL _initialized;
+    int32_t _nativeBufferHandle;
 }
 
 - (instancetype)init {
@@ -31,9 +32,12 @@
         int capacity = 30;
         int maxBufferSize = 48000 * 2 * 5;
         
-        _initialized = [NativeBufferBridge initializeBuffer:audioBufferKey 
-                                                   capacity:capacity 
-                                               maxBufferSize:maxBufferSize];
+        _nativeBufferHandle = [NativeBufferBridge createBuffer:audioBufferKey
+                                                      capacity:capacity
+                                                 maxBufferSize:maxBufferSize
+                                                          mode:NativeBufferModeSPSC
+                                                overflowPolicy:NativeBufferOverflowPolicyDropOldest];
+        _initialized = (_nativeBufferHandle != 0);
         
         if (!_initialized) {
             NSLog(@"Failed to initialize native audio buffer");
@@ -50,10 +54,10 @@
     
     NSData *byteData = [NSData dataWithBytes:audioData length:dataSize];
     
-    BOOL success = [NativeBufferBridge pushAudioBuffer:audioBufferKey 
-                                                buffer:byteData 
-                                            sampleRate:sampleRate 
-                                              channels:channelCount];
+    BOOL success = [NativeBufferBridge pushAudioBufferWithHandle:_nativeBufferHandle
+                                                          buffer:byteData
+                                                      sampleRate:sampleRate
+                                                        channels:channelCount];
     
     if (!success) {
         NSLog(@"Failed to push audio to native buffer");
@@ -0,0 +1,51 @@
+#ifndef ACCESS_UNIT_PARSER_H
+#define ACCESS_UNIT_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "NativeBuffer.h"
+
+// Just enough of an MSB-first bit reader for the few header fields the
+// parser and the MP4 writer need.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), size_(size), bit_(0) {}
+
+    bool read(int bits, uint32_t* value) {
+        uint32_t result = 0;
+        for (int i = 0; i < bits; ++i) {
+            if (bit_ >= size_ * 8) {
+                return false;
+            }
+            result = (result << 1) | ((data_[bit_ / 8] >> (7 - bit_ % 8)) & 1);
+            ++bit_;
+        }
+        *value = result;
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t bit_;
+};
+
+// Reads an AV1 leb128 value at *pos and advances *pos past it.
+bool readLeb128(const uint8_t* data, size_t size, size_t* pos, uint64_t* value);
+
+// Indexes one encoded video frame without copying it. H.264 and H.265 are
+// expected in Annex-B form (3- or 4-byte start codes), AV1 as a sequence of
+// OBUs in the low-overhead bitstream format. VP8/VP9 are only inspected for
+// the keyframe bit. Unknown codecs and malformed input produce an index with
+// whatever could be recovered; parsing never fails the push.
+void parseAccessUnit(VideoCodecType codec_type, const uint8_t* data, size_t size,
+                     AccessUnitIndex* out_index);
+
+// True for units a decoder needs before the first picture: SPS/PPS for H.264,
+// VPS/SPS/PPS for H.265 and the sequence header OBU for AV1.
+bool isParameterSetUnit(VideoCodecType codec_type, uint8_t unit_type);
+// True for access unit delimiters and the AV1 temporal delimiter.
+bool isDelimiterUnit(VideoCodecType codec_type, uint8_t unit_type);
+
+#endif // ACCESS_UNIT_PARSER_H
@@ -0,0 +1,74 @@
+#ifndef FRAGMENTED_MP4_WRITER_H
+#define FRAGMENTED_MP4_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "NativeBuffer.h"
+
+// Streams a single video track as fragmented MP4 (ISO BMFF): an init segment
+// (ftyp + moov) followed by moof/mdat pairs. Only the samples of the fragment
+// being built are held in memory, and a finished fragment never has to be
+// revisited, so a crash loses at most the fragment in progress.
+//
+// H.264 and H.265 samples are taken in Annex-B form and stored length-
+// prefixed; AV1 samples are stored as OBUs without temporal delimiters. The
+// sample entries are avc3/hev1, so parameter sets may also appear in band.
+// Times are in milliseconds, matching MediaFrame::frameTime.
+class FragmentedMp4Writer {
+public:
+    static const uint32_t kTimescale = 1000;
+
+    FragmentedMp4Writer();
+    ~FragmentedMp4Writer();
+
+    FragmentedMp4Writer(const FragmentedMp4Writer&) = delete;
+    FragmentedMp4Writer& operator=(const FragmentedMp4Writer&) = delete;
+
+    static bool supportsCodec(VideoCodecType codec_type);
+
+    // Creates path and writes the init segment. parameter_sets holds the
+    // codec's parameter set units without start codes (SPS/PPS, VPS/SPS/PPS)
+    // or the AV1 sequence header OBU, in decode order.
+    bool open(const std::string& path, VideoCodecType codec_type, int width, int height,
+              int rotation, const std::vector<std::vector<uint8_t>>& parameter_sets);
+    // Adds a sample to the fragment in progress. Its duration is set later
+    // with setLastSampleDuration, once the next frame's time is known.
+    bool appendSample(const uint8_t* data, size_t size, bool sync);
+    void setLastSampleDuration(uint32_t duration);
+    // Writes the fragment in progress, if any, as one moof/mdat pair.
+    bool flushFragment();
+    // Flushes and closes the file. Returns false if any write failed.
+    bool close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    size_t pendingSamples() const { return samples_.size(); }
+    size_t pendingBytes() const { return mdat_.size(); }
+    uint64_t pendingDuration() const { return pending_duration_; }
+
+private:
+    struct Sample {
+        uint32_t size;
+        uint32_t duration;
+        bool sync;
+    };
+
+    bool write(const std::vector<uint8_t>& bytes);
+    bool writeInitSegment(int width, int height, int rotation,
+                          const std::vector<std::vector<uint8_t>>& parameter_sets);
+
+    FILE* file_;
+    VideoCodecType codec_type_;
+    bool failed_;
+    uint32_t sequence_number_;
+    uint64_t decode_time_;
+    uint64_t pending_duration_;
+    std::vector<Sample> samples_;
+    std::vector<uint8_t> mdat_;
+    std::vector<uint8_t> scratch_;
+};
+
+#endif // FRAGMENTED_MP4_WRITER_H
@@ -0,0 +1,131 @@
+#include "FrameBufferPool.h"
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameBufferPool& FrameBufferPool::shared() {
+    // Never destroyed: frames may still be released from media threads while
+    // static destructors run.
+    static FrameBufferPool* pool = new FrameBufferPool();
+    return *pool;
+}
+
+FrameBufferPool::FrameBufferPool() :
+    cached_bytes_(0),
+    blocks_in_use_(0),
+    last_trim_ms_(nowMs())
+{
+}
+
+size_t FrameBufferPool::capacityFor(size_t size) {
+    size_t capacity = size_t(1) << kMinClassShift;
+    while (capacity < size) {
+        if (capacity >= (size_t(1) << kMaxClassShift)) {
+            return size;
+        }
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+bool FrameBufferPool::isOversized(size_t capacity, size_t size) {
+    return capacity >= capacityFor(size) * 4;
+}
+
+int FrameBufferPool::classIndex(size_t capacity) {
+    for (int shift = kMinClassShift; shift <= kMaxClassShift; ++shift) {
+        if (capacity == (size_t(1) << shift)) {
+            return shift - kMinClassShift;
+        }
+    }
+    return -1;
+}
+
+uint8_t* FrameBufferPool::allocate(size_t size, size_t* out_capacity) {
+    maybeTrimIdle();
+    const size_t capacity = capacityFor(size);
+    const int index = classIndex(capacity);
+    if (index >= 0) {
+        SizeClass& size_class = classes_[index];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.free_blocks.empty()) {
+            uint8_t* block = size_class.free_blocks.back();
+            size_class.free_blocks.pop_back();
+            size_class.low_water = std::min(size_class.low_water, size_class.free_blocks.size());
+            cached_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+            blocks_in_use_.fetch_add(1, std::memory_order_relaxed);
+            *out_capacity = capacity;
+            return block;
+        }
+    }
+    uint8_t* block = new (std::nothrow) uint8_t[capacity];
+    if (block) {
+        blocks_in_use_.fetch_add(1, std::memory_order_relaxed);
+        *out_capacity = capacity;
+    }
+    return block;
+}
+
+void FrameBufferPool::release(uint8_t* block, size_t capacity) {
+    if (!block) {
+        return;
+    }
+    const bool last_in_use = blocks_in_use_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    const int index = classIndex(capacity);
+    if (index < 0 || last_in_use ||
+        cached_bytes_.load(std::memory_order_relaxed) + capacity > kMaxCachedBytes) {
+        delete[] block;
+        if (last_in_use) {
+            // Nothing streams any more, so nothing will ask for the cache
+            // soon; the idle trim would never run again to return it.
+            trim();
+        }
+        return;
+    }
+    {
+        SizeClass& size_class = classes_[index];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        size_class.free_blocks.push_back(block);
+        cached_bytes_.fetch_add(capacity, std::memory_order_relaxed);
+    }
+    maybeTrimIdle();
+}
+
+void FrameBufferPool::trim() {
+    for (int i = 0; i < kNumClasses; ++i) {
+        trimClass(classes_[i], size_t(1) << (i + kMinClassShift), false);
+    }
+}
+
+void FrameBufferPool::maybeTrimIdle() {
+    const int64_t now = nowMs();
+    int64_t last = last_trim_ms_.load(std::memory_order_relaxed);
+    if (now - last < kTrimIntervalMs ||
+        !last_trim_ms_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return;
+    }
+    for (int i = 0; i < kNumClasses; ++i) {
+        trimClass(classes_[i], size_t(1) << (i + kMinClassShift), true);
+    }
+}
+
+void FrameBufferPool::trimClass(SizeClass& size_class, size_t block_size, bool idle_only) {
+    std::vector<uint8_t*> to_free;
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        size_t count = idle_only ? size_class.low_water : size_class.free_blocks.size();
+        count = std::min(count, size_class.free_blocks.size());
+        to_free.assign(size_class.free_blocks.end() - count, size_class.free_blocks.end());
+        size_class.free_blocks.resize(size_class.free_blocks.size() - count);
+        size_class.low_water = size_class.free_blocks.size();
+        cached_bytes_.fetch_sub(count * block_size, std::memory_order_relaxed);
+    }
+    for (uint8_t* block : to_free) {
+        delete[] block;
+    }
+}
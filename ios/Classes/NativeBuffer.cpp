@@ -1,47 +1,388 @@
 #include "NativeBuffer.h"
+#include "AccessUnitParser.h"
 #include <cstring>
 #include <stdexcept>
 #include <new>
+#include <chrono>
+#include <algorithm>
 
-NativeBuffer::NativeBuffer(int capacity, int initial_max_buffer_size) :
+static uint64_t monotonicNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static size_t histogramBucket(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket < NATIVE_BUFFER_HISTOGRAM_BUCKETS - 1) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+static void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+NativeBuffer::NativeBuffer(int capacity, int initial_max_buffer_size,
+                           BufferMode mode, OverflowPolicy overflow_policy) :
     capacity_(static_cast<size_t>(capacity)),
+    mode_(mode),
+    overflow_policy_(overflow_policy),
     current_max_frame_buffer_size_(static_cast<size_t>(initial_max_buffer_size)),
     write_index_(0),
     read_index_(0),
-    count_(0)
+    count_(0),
+    leased_(new bool[static_cast<size_t>(capacity > 0 ? capacity : 1)]()),
+    head_(0),
+    tail_(0),
+    slot_sequence_(new std::atomic<uint64_t>[static_cast<size_t>(capacity > 0 ? capacity : 1)]),
+    producer_waiting_(false),
+    priming_codec_(VIDEO_CODEC_UNKNOWN),
+    has_frame_sink_(false)
 {
     if (capacity <= 0 || initial_max_buffer_size <= 0) {
         throw std::invalid_argument("Capacity and initial_max_buffer_size must be positive.");
     }
+    if (mode != BUFFER_MODE_LOCKED && mode != BUFFER_MODE_SPSC) {
+        throw std::invalid_argument("Unknown buffer mode.");
+    }
+    if (overflow_policy != OVERFLOW_POLICY_BLOCK &&
+        overflow_policy != OVERFLOW_POLICY_DROP_OLDEST &&
+        overflow_policy != OVERFLOW_POLICY_DROP_NEWEST) {
+        throw std::invalid_argument("Unknown overflow policy.");
+    }
 
     frames_.reserve(capacity_);
     for (size_t i = 0; i < capacity_; ++i) {
-        frames_.emplace_back(std::make_unique<MediaFrame>(current_max_frame_buffer_size_));
+        frames_.emplace_back(std::make_unique<MediaFrame>());
+        slot_sequence_[i].store(i, std::memory_order_relaxed);
+    }
+}
+
+bool NativeBuffer::writeFrame(MediaFrame* frame, const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time) {
+    const size_t data_size = payload.size;
+    const uint8_t* previous_buffer = frame->buffer;
+    if (!frame->ensureBufferCapacity(data_size)) {
+        return false;
+    }
+    if (frame->buffer != previous_buffer) {
+        stats_.reallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (data_size > current_max_frame_buffer_size_) {
+        current_max_frame_buffer_size_ = data_size;
+    }
+    if (payload.fill) {
+        if (!payload.fill(frame->buffer, data_size, payload.fill_context)) {
+            return false;
+        }
+    } else {
+        std::memcpy(frame->buffer, payload.data, data_size);
+    }
+    frame->bufferSize = data_size;
+    frame->mediaType = type;
+    frame->frameTime = frame_time;
+    frame->metadata = metadata_union;
+    frame->enqueueTimeNs = monotonicNowNs();
+    if (type == MEDIA_TYPE_VIDEO) {
+        parseAccessUnit(metadata_union.video.codecType, frame->buffer, data_size, &frame->accessUnit);
+        if (frame->accessUnit.flags & (AU_FLAG_KEYFRAME | AU_FLAG_HAS_SPS | AU_FLAG_HAS_PPS |
+                                       AU_FLAG_HAS_VPS | AU_FLAG_HAS_SEQUENCE_HEADER)) {
+            updatePrimingCache(*frame);
+        }
+    }
+    return true;
+}
+
+void NativeBuffer::updatePrimingCache(const MediaFrame& frame) {
+    const VideoCodecType codec = frame.metadata.video.codecType;
+    std::lock_guard<std::mutex> lock(priming_mutex_);
+    if (codec != priming_codec_) {
+        parameter_sets_.clear();
+        last_keyframe_.reset();
+        priming_codec_ = codec;
+    }
+    const AccessUnitIndex& index = frame.accessUnit;
+    for (uint32_t i = 0; i < index.nalCount; ++i) {
+        const NalUnitInfo& unit = index.nals[i];
+        if (isParameterSetUnit(codec, unit.type)) {
+            parameter_sets_[unit.type].assign(frame.buffer + unit.offset,
+                                              frame.buffer + unit.offset + unit.size);
+        }
+    }
+    if (!(index.flags & AU_FLAG_KEYFRAME)) {
+        return;
+    }
+    if (!last_keyframe_) {
+        last_keyframe_ = std::make_unique<MediaFrame>();
+    }
+    if (!last_keyframe_->ensureBufferCapacity(frame.bufferSize)) {
+        last_keyframe_.reset();
+        return;
+    }
+    std::memcpy(last_keyframe_->buffer, frame.buffer, frame.bufferSize);
+    last_keyframe_->bufferSize = frame.bufferSize;
+    last_keyframe_->mediaType = frame.mediaType;
+    last_keyframe_->frameTime = frame.frameTime;
+    last_keyframe_->metadata = frame.metadata;
+    last_keyframe_->accessUnit = frame.accessUnit;
+}
+
+MediaFrame* NativeBuffer::acquirePrimingFrame() {
+    static const uint8_t kStartCode[] = {0, 0, 0, 1};
+    std::lock_guard<std::mutex> lock(priming_mutex_);
+    if (!last_keyframe_) {
+        return nullptr;
     }
+    const MediaFrame& keyframe = *last_keyframe_;
+    const AccessUnitIndex& index = keyframe.accessUnit;
+    const bool annex_b = priming_codec_ != VIDEO_CODEC_AV1;
+
+    // Missing parameter sets go after any access unit delimiter (AV1 temporal
+    // delimiter) and parameter sets the keyframe already has, right before
+    // its first other unit. Annex-B units are split at their 3-byte start code.
+    size_t insert_at = keyframe.bufferSize;
+    for (uint32_t i = 0; i < index.nalCount; ++i) {
+        const NalUnitInfo& unit = index.nals[i];
+        if (isParameterSetUnit(priming_codec_, unit.type) || isDelimiterUnit(priming_codec_, unit.type)) {
+            continue;
+        }
+        insert_at = annex_b ? unit.offset - 3 : unit.offset;
+        break;
+    }
+
+    std::vector<const std::vector<uint8_t>*> missing;
+    size_t total_size = keyframe.bufferSize;
+    for (const auto& entry : parameter_sets_) {
+        bool present = false;
+        for (uint32_t i = 0; i < index.nalCount && !present; ++i) {
+            present = index.nals[i].type == entry.first;
+        }
+        if (!present) {
+            missing.push_back(&entry.second);
+            total_size += entry.second.size() + (annex_b ? sizeof(kStartCode) : 0);
+        }
+    }
+
+    std::unique_ptr<MediaFrame> primer(new (std::nothrow) MediaFrame());
+    if (!primer || !primer->ensureBufferCapacity(total_size)) {
+        return nullptr;
+    }
+    uint8_t* out = primer->buffer;
+    std::memcpy(out, keyframe.buffer, insert_at);
+    out += insert_at;
+    for (const std::vector<uint8_t>* unit : missing) {
+        if (annex_b) {
+            std::memcpy(out, kStartCode, sizeof(kStartCode));
+            out += sizeof(kStartCode);
+        }
+        std::memcpy(out, unit->data(), unit->size());
+        out += unit->size();
+    }
+    std::memcpy(out, keyframe.buffer + insert_at, keyframe.bufferSize - insert_at);
+
+    primer->bufferSize = total_size;
+    primer->mediaType = keyframe.mediaType;
+    primer->frameTime = keyframe.frameTime;
+    primer->metadata = keyframe.metadata;
+    primer->detached = true;
+    if (missing.empty()) {
+        primer->accessUnit = index;
+    } else {
+        parseAccessUnit(priming_codec_, primer->buffer, total_size, &primer->accessUnit);
+    }
+    return primer.release();
+}
+
+int NativeBuffer::pushInternal(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time) {
+    int result = mode_ == BUFFER_MODE_SPSC
+        ? pushLockFree(payload, type, metadata_union, frame_time)
+        : pushLocked(payload, type, metadata_union, frame_time);
+    recordPush(result, payload.size);
+    return result;
 }
 
-int NativeBuffer::pushInternal(const uint8_t* data, size_t data_size, MediaType type, MediaMetadata metadata_union, uint64_t frame_time) {
+void NativeBuffer::recordPush(int result, size_t data_size) {
+    if (result == PUSH_RESULT_OK) {
+        stats_.pushed_frames.fetch_add(1, std::memory_order_relaxed);
+        stats_.bytes_pushed.fetch_add(data_size, std::memory_order_relaxed);
+    } else if (result == PUSH_RESULT_DROPPED) {
+        stats_.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        stats_.failed_pushes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void NativeBuffer::recordQueueDepth(uint64_t depth) {
+    stats_.queue_depth_histogram[histogramBucket(depth)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(stats_.max_queue_depth, depth);
+}
+
+void NativeBuffer::recordDequeue(const MediaFrame* frame) {
+    stats_.popped_frames.fetch_add(1, std::memory_order_relaxed);
+    stats_.bytes_popped.fetch_add(frame->bufferSize, std::memory_order_relaxed);
+    const uint64_t now = monotonicNowNs();
+    const uint64_t latency_us = now > frame->enqueueTimeNs ? (now - frame->enqueueTimeNs) / 1000 : 0;
+    stats_.latency_sum_us.fetch_add(latency_us, std::memory_order_relaxed);
+    stats_.latency_histogram_us[histogramBucket(latency_us)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(stats_.max_latency_us, latency_us);
+}
+
+void NativeBuffer::stats(NativeBufferStats* out) const {
+    const auto load = [](const std::atomic<uint64_t>& value) {
+        return value.load(std::memory_order_relaxed);
+    };
+    out->pushedFrames = load(stats_.pushed_frames);
+    out->poppedFrames = load(stats_.popped_frames);
+    out->droppedFrames = load(stats_.dropped_frames);
+    out->failedPushes = load(stats_.failed_pushes);
+    out->blockedPushes = load(stats_.blocked_pushes);
+    out->blockedNanos = load(stats_.blocked_nanos);
+    out->reallocations = load(stats_.reallocations);
+    out->bytesPushed = load(stats_.bytes_pushed);
+    out->bytesPopped = load(stats_.bytes_popped);
+    out->maxQueueDepth = load(stats_.max_queue_depth);
+    out->latencySumMicros = load(stats_.latency_sum_us);
+    out->maxLatencyMicros = load(stats_.max_latency_us);
+    for (size_t i = 0; i < NATIVE_BUFFER_HISTOGRAM_BUCKETS; ++i) {
+        out->queueDepthHistogram[i] = load(stats_.queue_depth_histogram[i]);
+        out->latencyHistogramMicros[i] = load(stats_.latency_histogram_us[i]);
+    }
+}
+
+int NativeBuffer::pushLocked(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time) {
     std::unique_lock<std::mutex> lock(mutex_);
-    MediaFrame* frame_to_write = frames_[write_index_].get();
-    if (data_size > frame_to_write->bufferCapacity) {
-        if (!frame_to_write->ensureBufferCapacity(data_size)) {
-            return -1;
+    uint64_t blocked_since = 0;
+    while (count_ == capacity_ || leased_[write_index_]) {
+        if (leased_[write_index_]) {
+            // Consumed but still leased: the ring is not full, so hand the
+            // frame over to its lease and give the slot a fresh one.
+            MediaFrame* replacement = new (std::nothrow) MediaFrame();
+            if (!replacement) {
+                return PUSH_RESULT_DROPPED;
+            }
+            frames_[write_index_].release();
+            frames_[write_index_].reset(replacement);
+            leased_[write_index_] = false;
+            continue;
+        }
+        if (overflow_policy_ == OVERFLOW_POLICY_DROP_OLDEST) {
+            // A full ring means the oldest queued frame sits at write_index_.
+            read_index_ = (read_index_ + 1) % capacity_;
+            count_--;
+            stats_.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (overflow_policy_ != OVERFLOW_POLICY_BLOCK) {
+            return PUSH_RESULT_DROPPED;
         }
-        if (data_size > current_max_frame_buffer_size_) {
-            current_max_frame_buffer_size_ = data_size;
+        if (blocked_since == 0) {
+            blocked_since = monotonicNowNs();
         }
+        not_full_cv_.wait(lock);
+    }
+    if (blocked_since != 0) {
+        stats_.blocked_pushes.fetch_add(1, std::memory_order_relaxed);
+        stats_.blocked_nanos.fetch_add(monotonicNowNs() - blocked_since, std::memory_order_relaxed);
+    }
+    if (!writeFrame(frames_[write_index_].get(), payload, type, metadata_union, frame_time)) {
+        return PUSH_RESULT_ERROR;
     }
-    not_full_cv_.wait(lock, [this] { return count_ < capacity_; });
-    std::memcpy(frame_to_write->buffer.get(), data, data_size);
-    frame_to_write->bufferSize = data_size;
-    frame_to_write->mediaType = type;
-    frame_to_write->frameTime = frame_time;
-    frame_to_write->metadata = metadata_union;
     write_index_ = (write_index_ + 1) % capacity_;
     count_++;
+    const size_t depth = count_;
     lock.unlock();
+    recordQueueDepth(depth);
     not_empty_cv_.notify_one();
-    return 0;
+    return PUSH_RESULT_OK;
+}
+
+int NativeBuffer::pushLockFree(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>& sequence = slot_sequence_[head % capacity_];
+    uint64_t blocked_since = 0;
+    while (sequence.load(std::memory_order_acquire) != head) {
+        // The slot still holds position head - capacity_, either queued or leased.
+        if (tail_.load(std::memory_order_acquire) + capacity_ != head) {
+            // Already consumed and pinned by a lease, so the ring is not full.
+            if (!detachLeasedSlot(head)) {
+                return PUSH_RESULT_DROPPED;
+            }
+            continue;
+        }
+        if (overflow_policy_ == OVERFLOW_POLICY_DROP_OLDEST) {
+            uint64_t tail = tail_.load(std::memory_order_acquire);
+            if (tail + capacity_ != head) {
+                // The consumer took it meanwhile; detach it on the next pass.
+                continue;
+            }
+            // Races with the consumer for the oldest frame; if the consumer
+            // wins it returns the slot itself.
+            if (tail_.compare_exchange_strong(tail, tail + 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+                sequence.store(head, std::memory_order_release);
+                stats_.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        if (overflow_policy_ == OVERFLOW_POLICY_DROP_NEWEST) {
+            return PUSH_RESULT_DROPPED;
+        }
+        // OVERFLOW_POLICY_BLOCK: park until the consumer frees the slot. The
+        // timed wait covers a wakeup that lands between the check and the wait.
+        if (blocked_since == 0) {
+            blocked_since = monotonicNowNs();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        producer_waiting_.store(true, std::memory_order_seq_cst);
+        not_full_cv_.wait_for(lock, std::chrono::milliseconds(5), [this, &sequence, head] {
+            return sequence.load(std::memory_order_acquire) == head ||
+                   tail_.load(std::memory_order_acquire) + capacity_ != head;
+        });
+        producer_waiting_.store(false, std::memory_order_relaxed);
+    }
+    if (blocked_since != 0) {
+        stats_.blocked_pushes.fetch_add(1, std::memory_order_relaxed);
+        stats_.blocked_nanos.fetch_add(monotonicNowNs() - blocked_since, std::memory_order_relaxed);
+    }
+    if (!writeFrame(frames_[head % capacity_].get(), payload, type, metadata_union, frame_time)) {
+        return PUSH_RESULT_ERROR;
+    }
+    sequence.store(head + 1, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+    // The consumer may have moved tail_ meanwhile; never report more than
+    // the ring can hold.
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    recordQueueDepth(head + 1 > tail ? std::min<uint64_t>(head + 1 - tail, capacity_) : 0);
+    return PUSH_RESULT_OK;
+}
+
+bool NativeBuffer::detachLeasedSlot(uint64_t head) {
+    const size_t index = head % capacity_;
+    MediaFrame* replacement = new (std::nothrow) MediaFrame();
+    if (!replacement) {
+        return false;
+    }
+    // Taking the slot with a compare-exchange settles the race with
+    // releaseSlot: whichever side moves the sequence off position + 1 first
+    // wins, and a release that loses knows its frame was handed over.
+    uint64_t expected = head - capacity_ + 1;
+    if (!slot_sequence_[index].compare_exchange_strong(expected, head,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+        // Released meanwhile; the slot is writable as it is.
+        delete replacement;
+        return true;
+    }
+    // The consumer never reads a slot at or past head_, so swapping the
+    // frame object here does not race with it.
+    frames_[index].release();
+    frames_[index].reset(replacement);
+    return true;
 }
 
 int NativeBuffer::pushVideoFrame(const uint8_t* data, size_t data_size,
@@ -53,7 +394,24 @@ int NativeBuffer::pushVideoFrame(const uint8_t* data, size_t data_size,
     metadata_union.video.rotation = rotation;
     metadata_union.video.frameType = frame_type;
     metadata_union.video.codecType = codec_type;
-    return pushInternal(data, data_size, MEDIA_TYPE_VIDEO, metadata_union, frame_time);
+    if (has_frame_sink_.load(std::memory_order_acquire) && data && data_size > 0) {
+        std::shared_ptr<FrameSink> sink;
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex_);
+            sink = frame_sink_;
+        }
+        if (sink) {
+            sink->onVideoFrame(data, data_size, metadata_union, frame_time);
+        }
+    }
+    return pushInternal(FramePayload{data, data_size, nullptr, nullptr},
+                        MEDIA_TYPE_VIDEO, metadata_union, frame_time);
+}
+
+void NativeBuffer::setFrameSink(std::shared_ptr<FrameSink> sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    has_frame_sink_.store(sink != nullptr, std::memory_order_release);
+    frame_sink_ = std::move(sink);
 }
 
 int NativeBuffer::pushAudioFrame(const uint8_t* data, size_t data_size,
@@ -61,16 +419,169 @@ int NativeBuffer::pushAudioFrame(const uint8_t* data, size_t data_size,
     MediaMetadata metadata_union;
     metadata_union.audio.sampleRate = sample_rate;
     metadata_union.audio.channels = channels;
-    return pushInternal(data, data_size, MEDIA_TYPE_AUDIO, metadata_union, frame_time);
+    return pushInternal(FramePayload{data, data_size, nullptr, nullptr},
+                        MEDIA_TYPE_AUDIO, metadata_union, frame_time);
+}
+
+int NativeBuffer::pushAudioFrameFilled(FrameFiller fill, void* context, size_t data_size,
+                                       int sample_rate, int channels, uint64_t frame_time) {
+    MediaMetadata metadata_union;
+    metadata_union.audio.sampleRate = sample_rate;
+    metadata_union.audio.channels = channels;
+    return pushInternal(FramePayload{nullptr, data_size, fill, context},
+                        MEDIA_TYPE_AUDIO, metadata_union, frame_time);
 }
 
 MediaFrame* NativeBuffer::popFrame() {
+    uint64_t position = 0;
+    MediaFrame* frame = take(&position, false);
+    if (frame && mode_ == BUFFER_MODE_SPSC && !releaseSlot(position, frame)) {
+        // The producer detached the frame before it could be returned; keep
+        // it alive until the next pop.
+        popped_detached_.reset(frame);
+    }
+    return frame;
+}
+
+MediaFrame* NativeBuffer::acquireFrame() {
+    uint64_t position = 0;
+    MediaFrame* frame = take(&position, true);
+    if (frame) {
+        frame->leasePosition = position;
+        frame->leaseOwner = shared_from_this();
+    }
+    return frame;
+}
+
+size_t NativeBuffer::acquireFrames(MediaFrame** out_frames, size_t max_frames) {
+    size_t acquired = 0;
+    if (mode_ == BUFFER_MODE_SPSC) {
+        uint64_t position = 0;
+        MediaFrame* frame = nullptr;
+        while (acquired < max_frames && (frame = takeLockFree(&position)) != nullptr) {
+            frame->leasePosition = position;
+            out_frames[acquired++] = frame;
+        }
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (acquired < max_frames && count_ > 0) {
+                MediaFrame* frame = frames_[read_index_].get();
+                frame->leasePosition = read_index_;
+                leased_[read_index_] = true;
+                read_index_ = (read_index_ + 1) % capacity_;
+                count_--;
+                out_frames[acquired++] = frame;
+                recordDequeue(frame);
+            }
+        }
+        if (acquired > 0) {
+            not_full_cv_.notify_one();
+        }
+    }
+    if (acquired > 0) {
+        std::shared_ptr<NativeBuffer> self = shared_from_this();
+        for (size_t i = 0; i < acquired; ++i) {
+            out_frames[i]->leaseOwner = self;
+        }
+    }
+    return acquired;
+}
+
+void NativeBuffer::releaseFrame(MediaFrame* frame) {
+    if (!frame) {
+        return;
+    }
+    if (frame->detached) {
+        delete frame;
+        return;
+    }
+    // Moving the owner out first means the buffer is destroyed on scope exit
+    // if it was freed while this lease was outstanding.
+    std::shared_ptr<NativeBuffer> owner = std::move(frame->leaseOwner);
+    if (!owner) {
+        return;
+    }
+    if (!owner->releaseSlot(frame->leasePosition, frame)) {
+        // Detached from the ring by the producer; the lease owns it.
+        delete frame;
+    }
+}
+
+MediaFrame* NativeBuffer::take(uint64_t* position, bool pin) {
+    if (mode_ == BUFFER_MODE_SPSC) {
+        // Lock-free slots stay pinned until releaseSlot either way.
+        return takeLockFree(position);
+    }
+    return takeLocked(position, pin);
+}
+
+MediaFrame* NativeBuffer::takeLocked(uint64_t* position, bool pin) {
     std::unique_lock<std::mutex> lock(mutex_);
     not_empty_cv_.wait(lock, [this] { return count_ > 0; });
     MediaFrame* frame_to_read = frames_[read_index_].get();
+    *position = read_index_;
+    if (pin) {
+        leased_[read_index_] = true;
+    }
     read_index_ = (read_index_ + 1) % capacity_;
     count_--;
+    // Unpinned slots may be overwritten once the lock is dropped; pinned
+    // ones are detached by the producer, so either way there is room now.
+    recordDequeue(frame_to_read);
     lock.unlock();
     not_full_cv_.notify_one();
     return frame_to_read;
 }
+
+MediaFrame* NativeBuffer::takeLockFree(uint64_t* position) {
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    MediaFrame* frame = nullptr;
+    for (;;) {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        if (tail == head) {
+            return nullptr;
+        }
+        // Read the frame while the slot is still queued: once tail_ moves
+        // past it, the producer may detach it and swap in a fresh one.
+        frame = frames_[tail % capacity_].get();
+        if (tail_.compare_exchange_weak(tail, tail + 1,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire)) {
+            break;
+        }
+    }
+    *position = tail;
+    recordDequeue(frame);
+    // A taken slot no longer holds up the producer, leased or not.
+    if (producer_waiting_.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        not_full_cv_.notify_one();
+    }
+    return frame;
+}
+
+bool NativeBuffer::releaseSlot(uint64_t position, const MediaFrame* frame) {
+    if (mode_ == BUFFER_MODE_SPSC) {
+        uint64_t expected = position + 1;
+        if (!slot_sequence_[position % capacity_].compare_exchange_strong(
+                expected, position + capacity_,
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return false;
+        }
+        if (producer_waiting_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            not_full_cv_.notify_one();
+        }
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_[position].get() != frame) {
+            return false;
+        }
+        leased_[position] = false;
+    }
+    not_full_cv_.notify_one();
+    return true;
+}
@@ -5,8 +5,12 @@
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <cstdint>
 #include <exception>
+#include <map>
+
+#include "FrameBufferPool.h"
 
 typedef enum {
     VIDEO_CODEC_UNKNOWN = 0,
@@ -22,6 +26,23 @@ typedef enum {
   MEDIA_TYPE_AUDIO = 1
 } MediaType;
 
+typedef enum {
+  BUFFER_MODE_LOCKED = 0,
+  BUFFER_MODE_SPSC = 1
+} BufferMode;
+
+typedef enum {
+  OVERFLOW_POLICY_BLOCK = 0,
+  OVERFLOW_POLICY_DROP_OLDEST = 1,
+  OVERFLOW_POLICY_DROP_NEWEST = 2
+} OverflowPolicy;
+
+typedef enum {
+  PUSH_RESULT_ERROR = -1,
+  PUSH_RESULT_OK = 0,
+  PUSH_RESULT_DROPPED = 1
+} PushResult;
+
 typedef union {
   struct {
     int width;
@@ -37,54 +58,159 @@ typedef union {
   } audio;
 } MediaMetadata;
 
+// Upper bound on the units recorded per frame; the rest set AU_FLAG_TRUNCATED.
+#define MAX_ACCESS_UNIT_NALS 32
+
+typedef enum {
+  AU_FLAG_KEYFRAME = 1 << 0,
+  AU_FLAG_HAS_SPS = 1 << 1,
+  AU_FLAG_HAS_PPS = 1 << 2,
+  AU_FLAG_HAS_VPS = 1 << 3,
+  AU_FLAG_HAS_SEQUENCE_HEADER = 1 << 4,
+  AU_FLAG_TRUNCATED = 1 << 5,
+  AU_FLAG_MALFORMED = 1 << 6
+} AccessUnitFlags;
+
+// One NAL unit (H.264/H.265) or OBU (AV1). offset points at the unit header,
+// past any Annex-B start code, and size covers header and payload.
+typedef struct {
+  uint32_t offset;
+  uint32_t size;
+  uint8_t type;
+  int8_t temporalId;
+  uint16_t reserved;
+} NalUnitInfo;
+
+// Per-frame index built by parseAccessUnit when a video frame is pushed.
+// VP8/VP9 frames carry no units and only report AU_FLAG_KEYFRAME.
+typedef struct {
+  uint32_t flags;
+  int32_t temporalId;
+  uint32_t nalCount;
+  NalUnitInfo nals[MAX_ACCESS_UNIT_NALS];
+} AccessUnitIndex;
+
+#define NATIVE_BUFFER_HISTOGRAM_BUCKETS 24
+
+// Counters of one NativeBuffer since it was created. Histogram bucket 0
+// counts zero values and bucket i counts values in [2^(i-1), 2^i); the last
+// bucket also takes everything larger. Mirrored by NativeBufferStatsNative in
+// lib/bindings/native_bindings.dart.
+typedef struct NativeBufferStats {
+  uint64_t pushedFrames;
+  uint64_t poppedFrames;
+  // Frames evicted by OVERFLOW_POLICY_DROP_OLDEST or refused by a full ring.
+  uint64_t droppedFrames;
+  uint64_t failedPushes;
+  // Pushes that had to wait for room under OVERFLOW_POLICY_BLOCK.
+  uint64_t blockedPushes;
+  uint64_t blockedNanos;
+  // Payload blocks swapped in by MediaFrame::ensureBufferCapacity.
+  uint64_t reallocations;
+  uint64_t bytesPushed;
+  uint64_t bytesPopped;
+  uint64_t maxQueueDepth;
+  // Time from a frame being written into the ring to it being popped.
+  uint64_t latencySumMicros;
+  uint64_t maxLatencyMicros;
+  // Frames queued right after each successful push.
+  uint64_t queueDepthHistogram[NATIVE_BUFFER_HISTOGRAM_BUCKETS];
+  uint64_t latencyHistogramMicros[NATIVE_BUFFER_HISTOGRAM_BUCKETS];
+} NativeBufferStats;
+
+class NativeBuffer;
+
 class MediaFrame {
 public:
     MediaType mediaType;
     uint64_t frameTime;
-    std::unique_ptr<uint8_t[]> buffer;
+    // Owned block from FrameBufferPool::shared(); nullptr until first written.
+    uint8_t* buffer;
     size_t bufferSize;
     size_t bufferCapacity;
     MediaMetadata metadata;
+    // Only filled in for MEDIA_TYPE_VIDEO frames.
+    AccessUnitIndex accessUnit;
+    // Fields above are mirrored by MediaFrameNative in lib/bindings/native_bindings.dart.
+    // While the frame is leased, leaseOwner keeps the buffer alive and
+    // leasePosition identifies the ring slot to unpin on release.
+    uint64_t leasePosition;
+    std::shared_ptr<NativeBuffer> leaseOwner;
+    // Set on frames built by acquirePrimingFrame, which belong to the caller
+    // rather than to a ring slot; releaseFrame deletes them.
+    bool detached;
+    // Monotonic time the frame was written into its slot, for latency stats.
+    uint64_t enqueueTimeNs;
 
-    explicit MediaFrame(size_t initial_buffer_capacity) :
+    MediaFrame() :
         mediaType(MEDIA_TYPE_VIDEO),
         frameTime(0),
-        buffer(std::make_unique<uint8_t[]>(initial_buffer_capacity)),
+        buffer(nullptr),
         bufferSize(0),
-        bufferCapacity(initial_buffer_capacity),
-        metadata{}
+        bufferCapacity(0),
+        metadata{},
+        accessUnit{},
+        leasePosition(0),
+        detached(false),
+        enqueueTimeNs(0)
     {
-        if (!buffer) {
-             throw std::runtime_error("Failed to allocate initial MediaFrame buffer.");
-        }
         metadata.video.codecType = VIDEO_CODEC_UNKNOWN;
     }
 
+    ~MediaFrame() {
+        FrameBufferPool::shared().release(buffer, bufferCapacity);
+    }
+
     MediaFrame(const MediaFrame&) = delete;
     MediaFrame& operator=(const MediaFrame&) = delete;
-    MediaFrame(MediaFrame&&) = default;
-    MediaFrame& operator=(MediaFrame&&) = default;
 
     bool hasBuffer() const { return buffer != nullptr; }
+    // Makes buffer hold at least required_capacity bytes. A block far larger
+    // than needed (e.g. left over from a keyframe) is swapped for a smaller
+    // one, so the slot's footprint follows the stream instead of its peak.
     bool ensureBufferCapacity(size_t required_capacity) {
-        if (required_capacity <= bufferCapacity) {
+        if (required_capacity <= bufferCapacity &&
+            !FrameBufferPool::isOversized(bufferCapacity, required_capacity)) {
             return true;
         }
-        try {
-            auto new_buffer = std::make_unique<uint8_t[]>(required_capacity);
-            buffer = std::move(new_buffer);
-            bufferCapacity = required_capacity;
-            bufferSize = 0;
-            return true;
-        } catch (const std::bad_alloc&) {
-            return false;
+        FrameBufferPool& pool = FrameBufferPool::shared();
+        size_t new_capacity = 0;
+        uint8_t* new_buffer = pool.allocate(required_capacity, &new_capacity);
+        if (!new_buffer) {
+            return required_capacity <= bufferCapacity;
         }
+        pool.release(buffer, bufferCapacity);
+        buffer = new_buffer;
+        bufferCapacity = new_capacity;
+        bufferSize = 0;
+        return true;
     }
 };
 
-class NativeBuffer {
+// Receives every video frame pushed into a NativeBuffer it is attached to,
+// on the producer thread and before the ring applies its overflow policy, so
+// it sees frames the consumer may never get. Must return quickly.
+class FrameSink {
 public:
-    NativeBuffer(int capacity, int initial_max_buffer_size);
+    virtual ~FrameSink() = default;
+    virtual void onVideoFrame(const uint8_t* data, size_t data_size,
+                              const MediaMetadata& metadata, uint64_t frame_time) = 0;
+};
+
+// Writes size payload bytes to dst for a push; returning false abandons it.
+typedef bool (*FrameFiller)(uint8_t* dst, size_t size, void* context);
+
+class NativeBuffer : public std::enable_shared_from_this<NativeBuffer> {
+public:
+    // BUFFER_MODE_LOCKED guards the ring with a mutex; BUFFER_MODE_SPSC uses
+    // atomic indices and per-slot sequence numbers and assumes exactly one
+    // producer thread and one consumer thread. The overflow policy decides
+    // what a push does when the ring is full. Payload memory is taken from
+    // FrameBufferPool on first use, so initial_max_buffer_size is only a
+    // sanity-checked hint and nothing is reserved up front.
+    NativeBuffer(int capacity, int initial_max_buffer_size,
+                 BufferMode mode = BUFFER_MODE_LOCKED,
+                 OverflowPolicy overflow_policy = OVERFLOW_POLICY_BLOCK);
     ~NativeBuffer() = default;
 
     NativeBuffer(const NativeBuffer&) = delete;
@@ -95,21 +221,142 @@ public:
                        int rotation, int frame_type, VideoCodecType codec_type);
     int pushAudioFrame(const uint8_t* data, size_t data_size,
                        int sample_rate, int channels, uint64_t frame_time);
+    // Like pushAudioFrame, but fill writes the payload straight into the
+    // slot, for callers that would otherwise stage it in a buffer of their
+    // own first. A failed fill is reported as PUSH_RESULT_ERROR.
+    int pushAudioFrameFilled(FrameFiller fill, void* context, size_t data_size,
+                             int sample_rate, int channels, uint64_t frame_time);
+    // In BUFFER_MODE_LOCKED this waits for a frame; in BUFFER_MODE_SPSC it
+    // returns nullptr when the ring is empty. The slot is writable again as
+    // soon as this returns, so the frame is only valid until the next push
+    // or pop.
     MediaFrame* popFrame();
 
+    // Like popFrame, but the frame stays valid until releaseFrame is called,
+    // so the payload can be read in place. A leased frame does not hold up
+    // the ring: when the producer wraps around to its slot, the frame is
+    // detached and left to the lease, and the slot gets a fresh frame.
+    // The buffer must be owned by a std::shared_ptr; the lease keeps it alive.
+    MediaFrame* acquireFrame();
+    // Leases up to max_frames queued frames in order without waiting and
+    // returns how many were written to out_frames. Each one must be released.
+    size_t acquireFrames(MediaFrame** out_frames, size_t max_frames);
+    // Ends the lease on a frame returned by acquireFrame(s), or frees a
+    // priming frame. Safe to call after the buffer has been removed from its
+    // registry. Every frame must be released exactly once: the same object
+    // can be leased again once its slot is reused, so a second release could
+    // end someone else's lease.
+    static void releaseFrame(MediaFrame* frame);
+
+    // Returns a copy of the most recent video keyframe, with the latest
+    // cached parameter sets (SPS/PPS/VPS, AV1 sequence header) it lacks
+    // inserted ahead of its first picture unit, so a consumer that joins
+    // mid-stream can start decoding without waiting for the next keyframe.
+    // Returns nullptr until a keyframe has been pushed. Does not touch the
+    // ring; the caller owns the frame and must pass it to releaseFrame.
+    MediaFrame* acquirePrimingFrame();
+
+    // Attaches sink, replacing any previous one; nullptr detaches.
+    void setFrameSink(std::shared_ptr<FrameSink> sink);
+
+    // Copies the counters without locking; individual fields are consistent,
+    // but a snapshot taken during pushes may mix slightly different moments.
+    void stats(NativeBufferStats* out) const;
+
+    BufferMode mode() const { return mode_; }
+    OverflowPolicy overflowPolicy() const { return overflow_policy_; }
+
 private:
-    int pushInternal(const uint8_t* data, size_t data_size, MediaType type, MediaMetadata metadata_union, uint64_t frame_time);
+    // The payload of a push: copied from data, or written by fill if set.
+    struct FramePayload {
+        const uint8_t* data;
+        size_t size;
+        FrameFiller fill;
+        void* fill_context;
+    };
+
+    int pushInternal(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time);
+    int pushLocked(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time);
+    int pushLockFree(const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time);
+    MediaFrame* take(uint64_t* position, bool pin);
+    MediaFrame* takeLocked(uint64_t* position, bool pin);
+    MediaFrame* takeLockFree(uint64_t* position);
+    // Returns the slot of a taken frame to the producer, or false if the
+    // producer detached frame from the slot first; it then belongs to the
+    // caller.
+    bool releaseSlot(uint64_t position, const MediaFrame* frame);
+    // Hands the leased frame in the slot for position head - capacity_ to
+    // its lease and puts a fresh frame in the slot. False if out of memory.
+    bool detachLeasedSlot(uint64_t head);
+    bool writeFrame(MediaFrame* frame, const FramePayload& payload, MediaType type, MediaMetadata metadata_union, uint64_t frame_time);
+    void updatePrimingCache(const MediaFrame& frame);
+    void recordPush(int result, size_t data_size);
+    void recordQueueDepth(uint64_t depth);
+    void recordDequeue(const MediaFrame* frame);
 
     std::vector<std::unique_ptr<MediaFrame>> frames_;
     const size_t capacity_;
+    const BufferMode mode_;
+    const OverflowPolicy overflow_policy_;
     size_t current_max_frame_buffer_size_;
+
+    // BUFFER_MODE_LOCKED state, guarded by mutex_. leased_[i] is set while
+    // the frame in slot i is leased; pushes detach it from the slot.
     size_t write_index_;
     size_t read_index_;
     size_t count_;
+    std::unique_ptr<bool[]> leased_;
 
     std::mutex mutex_;
     std::condition_variable not_empty_cv_;
     std::condition_variable not_full_cv_;
+
+    // BUFFER_MODE_SPSC state. head_ is only advanced by the producer; tail_ is
+    // advanced by the consumer, and by the producer when dropping the oldest
+    // frame, so it is updated with compare-exchange. slot_sequence_[i] equals
+    // the position the slot is next writable at, and position + 1 once it
+    // holds that position's frame; a slot is returned to the producer by
+    // storing position + capacity.
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slot_sequence_;
+    std::atomic<bool> producer_waiting_;
+    // A frame popFrame returned after the producer detached it. Consumer only.
+    std::unique_ptr<MediaFrame> popped_detached_;
+
+    // Priming cache, guarded by priming_mutex_. Only frames that carry
+    // parameter sets or a keyframe take the lock, so ordinary pushes don't.
+    // parameter_sets_ keeps the latest unit of each type in ascending type
+    // order, which is also the order decoders expect them in.
+    std::mutex priming_mutex_;
+    VideoCodecType priming_codec_;
+    std::map<uint8_t, std::vector<uint8_t>> parameter_sets_;
+    std::unique_ptr<MediaFrame> last_keyframe_;
+
+    // Every counter is updated with relaxed atomics, so keeping stats costs
+    // no locks on either side of the ring.
+    struct StatsCounters {
+        std::atomic<uint64_t> pushed_frames{0};
+        std::atomic<uint64_t> popped_frames{0};
+        std::atomic<uint64_t> dropped_frames{0};
+        std::atomic<uint64_t> failed_pushes{0};
+        std::atomic<uint64_t> blocked_pushes{0};
+        std::atomic<uint64_t> blocked_nanos{0};
+        std::atomic<uint64_t> reallocations{0};
+        std::atomic<uint64_t> bytes_pushed{0};
+        std::atomic<uint64_t> bytes_popped{0};
+        std::atomic<uint64_t> max_queue_depth{0};
+        std::atomic<uint64_t> latency_sum_us{0};
+        std::atomic<uint64_t> max_latency_us{0};
+        std::atomic<uint64_t> queue_depth_histogram[NATIVE_BUFFER_HISTOGRAM_BUCKETS] = {};
+        std::atomic<uint64_t> latency_histogram_us[NATIVE_BUFFER_HISTOGRAM_BUCKETS] = {};
+    };
+    StatsCounters stats_;
+
+    // has_frame_sink_ lets pushes skip sink_mutex_ when nothing is attached.
+    std::mutex sink_mutex_;
+    std::shared_ptr<FrameSink> frame_sink_;
+    std::atomic<bool> has_frame_sink_;
 };
 
 #endif // NATIVE_BUFFER_H
@@ -2,10 +2,52 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Mirrors BufferMode / OverflowPolicy in NativeBuffer.h.
+typedef NS_ENUM(int, NativeBufferMode) {
+    NativeBufferModeLocked = 0,
+    NativeBufferModeSPSC = 1,
+};
+
+typedef NS_ENUM(int, NativeBufferOverflowPolicy) {
+    NativeBufferOverflowPolicyBlock = 0,
+    NativeBufferOverflowPolicyDropOldest = 1,
+    NativeBufferOverflowPolicyDropNewest = 2,
+};
+
 @interface NativeBufferBridge : NSObject
 
 + (BOOL)initializeBuffer:(NSString *)key capacity:(int)capacity maxBufferSize:(int)maxBufferSize;
 
++ (BOOL)initializeBuffer:(NSString *)key
+                capacity:(int)capacity
+           maxBufferSize:(int)maxBufferSize
+                    mode:(NativeBufferMode)mode
+          overflowPolicy:(NativeBufferOverflowPolicy)overflowPolicy;
+
+// Returns the handle of the buffer registered under key, or 0 on failure.
+// The handle-based calls below skip the key lookup on every frame.
++ (int32_t)createBuffer:(NSString *)key
+               capacity:(int)capacity
+          maxBufferSize:(int)maxBufferSize
+                   mode:(NativeBufferMode)mode
+         overflowPolicy:(NativeBufferOverflowPolicy)overflowPolicy;
+
++ (BOOL)pushVideoBufferWithHandle:(int32_t)handle
+                           buffer:(NSData *)buffer
+                            width:(int)width
+                           height:(int)height
+                        frameTime:(int64_t)frameTime
+                         rotation:(int)rotation
+                        frameType:(int)frameType
+                        codecType:(int)codecType;
+
++ (BOOL)pushAudioBufferWithHandle:(int32_t)handle
+                           buffer:(NSData *)buffer
+                       sampleRate:(int)sampleRate
+                         channels:(int)channels;
+
++ (void)freeBufferWithHandle:(int32_t)handle;
+
 + (BOOL)pushVideoBuffer:(NSString *)key
                  buffer:(NSData *)buffer
                   width:(int)width
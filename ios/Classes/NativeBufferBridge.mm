@@ -4,9 +4,98 @@
 @implementation NativeBufferBridge
 
 + (BOOL)initializeBuffer:(NSString *)key capacity:(int)capacity maxBufferSize:(int)maxBufferSize {
-    if (!key) return NO;
-    int result = initNativeBufferFFI([key UTF8String], capacity, maxBufferSize);
-    return (result != 0);
+    return [self initializeBuffer:key
+                         capacity:capacity
+                    maxBufferSize:maxBufferSize
+                             mode:NativeBufferModeLocked
+                   overflowPolicy:NativeBufferOverflowPolicyBlock];
+}
+
++ (BOOL)initializeBuffer:(NSString *)key
+                capacity:(int)capacity
+           maxBufferSize:(int)maxBufferSize
+                    mode:(NativeBufferMode)mode
+          overflowPolicy:(NativeBufferOverflowPolicy)overflowPolicy {
+    return [self createBuffer:key
+                     capacity:capacity
+                maxBufferSize:maxBufferSize
+                         mode:mode
+               overflowPolicy:overflowPolicy] != 0;
+}
+
++ (int32_t)createBuffer:(NSString *)key
+               capacity:(int)capacity
+          maxBufferSize:(int)maxBufferSize
+                   mode:(NativeBufferMode)mode
+         overflowPolicy:(NativeBufferOverflowPolicy)overflowPolicy {
+    if (!key) return 0;
+    return initNativeBufferFFI([key UTF8String], capacity, maxBufferSize, mode, overflowPolicy);
+}
+
++ (BOOL)pushVideoBufferWithHandle:(int32_t)handle
+                           buffer:(NSData *)buffer
+                            width:(int)width
+                           height:(int)height
+                        frameTime:(int64_t)frameTime
+                         rotation:(int)rotation
+                        frameType:(int)frameType
+                        codecType:(int)codecType {
+    if (handle == 0 || !buffer) {
+        NSLog(@"NativeBufferBridge: Error - Pushing video with invalid handle or nil buffer.");
+        return NO;
+    }
+
+    size_t length = (size_t)[buffer length];
+    if (length == 0) {
+        return YES;
+    }
+
+    int ffi_result = pushVideoNativeBufferByHandleFFI(
+        handle,
+        (const uint8_t *)[buffer bytes],
+        length,
+        width,
+        height,
+        (uint64_t)frameTime,
+        rotation,
+        frameType,
+        codecType
+    );
+
+    return (ffi_result != 0);
+}
+
++ (BOOL)pushAudioBufferWithHandle:(int32_t)handle
+                           buffer:(NSData *)buffer
+                       sampleRate:(int)sampleRate
+                         channels:(int)channels {
+    if (handle == 0 || !buffer) {
+        NSLog(@"NativeBufferBridge: Error - Pushing audio with invalid handle or nil buffer.");
+        return NO;
+    }
+
+    size_t length = (size_t)[buffer length];
+    if (length == 0) {
+        return YES;
+    }
+
+    uint64_t frameTime = (uint64_t)([[NSDate date] timeIntervalSince1970] * 1000.0);
+
+    int ffi_result = pushAudioNativeBufferByHandleFFI(
+        handle,
+        (const uint8_t *)[buffer bytes],
+        length,
+        sampleRate,
+        channels,
+        frameTime
+    );
+
+    return (ffi_result != 0);
+}
+
++ (void)freeBufferWithHandle:(int32_t)handle {
+    if (handle == 0) return;
+    freeNativeBufferByHandleFFI(handle);
 }
 
 + (BOOL)pushVideoBuffer:(NSString *)key
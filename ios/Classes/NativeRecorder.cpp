@@ -0,0 +1,226 @@
+#include "NativeRecorder.h"
+#include "AccessUnitParser.h"
+#include <cstring>
+#include <new>
+#include <system_error>
+
+// Bounds on what the producer may queue ahead of the writer thread, and on
+// the fragment held in memory when keyframes are far apart.
+static const size_t kMaxQueuedFrames = 120;
+static const size_t kMaxQueuedBytes = 32 * 1024 * 1024;
+static const size_t kMaxFragmentBytes = 16 * 1024 * 1024;
+static const uint64_t kMaxFragmentDurationMs = 10000;
+static const uint32_t kDefaultFrameDurationMs = 33;
+static const uint32_t kMaxFrameDurationMs = 5000;
+
+NativeRecorder::NativeRecorder(const std::string& path, int fragment_duration_ms) :
+    fragment_duration_ms_(fragment_duration_ms > 0 ? static_cast<uint64_t>(fragment_duration_ms) : 2000),
+    queued_bytes_(0),
+    gap_(false),
+    stopping_(false),
+    rotation_pending_(false),
+    failed_(false),
+    path_(path),
+    next_path_pending_(false),
+    codec_type_(VIDEO_CODEC_UNKNOWN),
+    awaiting_keyframe_(true),
+    has_last_frame_time_(false),
+    last_frame_time_(0),
+    last_duration_(kDefaultFrameDurationMs)
+{
+}
+
+NativeRecorder::~NativeRecorder() {
+    stop();
+}
+
+bool NativeRecorder::start() {
+    try {
+        thread_ = std::thread(&NativeRecorder::run, this);
+    } catch (const std::system_error&) {
+        return false;
+    }
+    return true;
+}
+
+void NativeRecorder::rotate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rotation_pending_ = true;
+    rotation_path_ = path;
+}
+
+bool NativeRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_;
+}
+
+void NativeRecorder::onVideoFrame(const uint8_t* data, size_t data_size,
+                                  const MediaMetadata& metadata, uint64_t frame_time) {
+    if (!FragmentedMp4Writer::supportsCodec(metadata.video.codecType)) {
+        return;
+    }
+    std::unique_ptr<MediaFrame> frame(new (std::nothrow) MediaFrame());
+    const bool copied = frame && frame->ensureBufferCapacity(data_size);
+    if (copied) {
+        std::memcpy(frame->buffer, data, data_size);
+        frame->bufferSize = data_size;
+        frame->mediaType = MEDIA_TYPE_VIDEO;
+        frame->frameTime = frame_time;
+        frame->metadata = metadata;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        if (!copied || queue_.size() >= kMaxQueuedFrames || queued_bytes_ + data_size > kMaxQueuedBytes) {
+            gap_ = true;
+            return;
+        }
+        queue_.push_back(QueuedFrame{std::move(frame), gap_, rotation_pending_, std::move(rotation_path_)});
+        queued_bytes_ += data_size;
+        gap_ = false;
+        rotation_pending_ = false;
+        rotation_path_.clear();
+    }
+    queue_cv_.notify_one();
+}
+
+void NativeRecorder::run() {
+    for (;;) {
+        QueuedFrame item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                break;
+            }
+            item = std::move(queue_.front());
+            queue_.pop_front();
+            queued_bytes_ -= item.frame->bufferSize;
+        }
+        writeFrame(item);
+    }
+    if (writer_.pendingSamples() > 0) {
+        writer_.setLastSampleDuration(last_duration_);
+    }
+    finishFile();
+}
+
+void NativeRecorder::writeFrame(QueuedFrame& item) {
+    MediaFrame& frame = *item.frame;
+    if (item.rotate) {
+        next_path_pending_ = true;
+        next_path_ = std::move(item.rotation_path);
+    }
+    const VideoCodecType codec_type = frame.metadata.video.codecType;
+    parseAccessUnit(codec_type, frame.buffer, frame.bufferSize, &frame.accessUnit);
+    const AccessUnitIndex& index = frame.accessUnit;
+
+    if (codec_type != codec_type_) {
+        // A file holds a single codec. After a switch, recording resumes in
+        // the file passed to the next rotate call.
+        if (writer_.isOpen()) {
+            writer_.setLastSampleDuration(last_duration_);
+            finishFile();
+            path_.clear();
+        }
+        codec_type_ = codec_type;
+        parameter_sets_.clear();
+        awaiting_keyframe_ = true;
+    }
+    for (uint32_t i = 0; i < index.nalCount; ++i) {
+        const NalUnitInfo& unit = index.nals[i];
+        if (isParameterSetUnit(codec_type, unit.type)) {
+            parameter_sets_[unit.type].assign(frame.buffer + unit.offset,
+                                              frame.buffer + unit.offset + unit.size);
+        }
+    }
+
+    const bool sync = (index.flags & AU_FLAG_KEYFRAME) != 0;
+    if (item.after_gap) {
+        awaiting_keyframe_ = true;
+    }
+    if (awaiting_keyframe_ && !sync) {
+        return;
+    }
+
+    // This frame's time is what closes out the previous sample.
+    if (writer_.pendingSamples() > 0) {
+        writer_.setLastSampleDuration(durationUntil(frame.frameTime));
+    }
+    if (sync && next_path_pending_) {
+        finishFile();
+        path_ = std::move(next_path_);
+        next_path_pending_ = false;
+    }
+    if (writer_.isOpen() && writer_.pendingSamples() > 0 &&
+        ((sync && writer_.pendingDuration() >= fragment_duration_ms_) ||
+         writer_.pendingDuration() >= kMaxFragmentDurationMs ||
+         writer_.pendingBytes() >= kMaxFragmentBytes)) {
+        if (!writer_.flushFragment()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+        }
+    }
+
+    if (!writer_.isOpen()) {
+        if (!sync || path_.empty() || !hasParameterSets()) {
+            return;
+        }
+        std::vector<std::vector<uint8_t>> parameter_sets;
+        for (const auto& entry : parameter_sets_) {
+            parameter_sets.push_back(entry.second);
+        }
+        if (!writer_.open(path_, codec_type, frame.metadata.video.width, frame.metadata.video.height,
+                          frame.metadata.video.rotation, parameter_sets)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+            path_.clear();
+            return;
+        }
+        has_last_frame_time_ = false;
+    }
+
+    if (writer_.appendSample(frame.buffer, frame.bufferSize, sync)) {
+        awaiting_keyframe_ = false;
+        has_last_frame_time_ = true;
+        last_frame_time_ = frame.frameTime;
+    }
+}
+
+bool NativeRecorder::hasParameterSets() const {
+    switch (codec_type_) {
+        case VIDEO_CODEC_H264:
+            return parameter_sets_.count(7) && parameter_sets_.count(8);
+        case VIDEO_CODEC_H265:
+            return parameter_sets_.count(32) && parameter_sets_.count(33) && parameter_sets_.count(34);
+        case VIDEO_CODEC_AV1:
+            return parameter_sets_.count(1) != 0;
+        default:
+            return false;
+    }
+}
+
+uint32_t NativeRecorder::durationUntil(uint64_t frame_time) {
+    if (has_last_frame_time_ && frame_time > last_frame_time_) {
+        uint64_t delta = frame_time - last_frame_time_;
+        last_duration_ = static_cast<uint32_t>(delta < kMaxFrameDurationMs ? delta : kMaxFrameDurationMs);
+    }
+    return last_duration_;
+}
+
+void NativeRecorder::finishFile() {
+    if (writer_.isOpen() && !writer_.close()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+    }
+}
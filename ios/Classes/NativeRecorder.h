@@ -0,0 +1,86 @@
+#ifndef NATIVE_RECORDER_H
+#define NATIVE_RECORDER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "FragmentedMp4Writer.h"
+#include "NativeBuffer.h"
+
+// Records the video pushed into a NativeBuffer to fragmented MP4 on its own
+// thread, without involving the buffer's consumer. Attach it with
+// NativeBuffer::setFrameSink. Each pushed frame is copied into a bounded
+// queue; when the writer falls behind, frames are dropped and recording
+// resumes at the next keyframe. Every file starts with a keyframe and the
+// parameter sets needed to decode it.
+class NativeRecorder : public FrameSink {
+public:
+    // A fragment is cut at the first keyframe after fragment_duration_ms.
+    NativeRecorder(const std::string& path, int fragment_duration_ms);
+    ~NativeRecorder() override;
+
+    NativeRecorder(const NativeRecorder&) = delete;
+    NativeRecorder& operator=(const NativeRecorder&) = delete;
+
+    bool start();
+    // Continues in a new file at path from the next keyframe on; the current
+    // file is finished right before it.
+    void rotate(const std::string& path);
+    // Writes out everything queued, closes the file and joins the writer
+    // thread. Returns false if creating or writing any file failed.
+    bool stop();
+
+    void onVideoFrame(const uint8_t* data, size_t data_size,
+                      const MediaMetadata& metadata, uint64_t frame_time) override;
+
+private:
+    struct QueuedFrame {
+        std::unique_ptr<MediaFrame> frame;
+        // Frames were dropped right before this one.
+        bool after_gap;
+        // Set on the first frame pushed after rotate, so the switch happens
+        // at the first keyframe pushed after the call, however far the
+        // writer thread lags behind.
+        bool rotate;
+        std::string rotation_path;
+    };
+
+    void run();
+    void writeFrame(QueuedFrame& item);
+    bool hasParameterSets() const;
+    uint32_t durationUntil(uint64_t frame_time);
+    void finishFile();
+
+    const uint64_t fragment_duration_ms_;
+
+    // Guards the queue and the control fields between threads.
+    std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<QueuedFrame> queue_;
+    size_t queued_bytes_;
+    bool gap_;
+    bool stopping_;
+    bool rotation_pending_;
+    std::string rotation_path_;
+    bool failed_;
+    std::thread thread_;
+
+    // Writer thread state.
+    FragmentedMp4Writer writer_;
+    std::string path_;
+    bool next_path_pending_;
+    std::string next_path_;
+    VideoCodecType codec_type_;
+    std::map<uint8_t, std::vector<uint8_t>> parameter_sets_;
+    bool awaiting_keyframe_;
+    bool has_last_frame_time_;
+    uint64_t last_frame_time_;
+    uint32_t last_duration_;
+};
+
+#endif // NATIVE_RECORDER_H
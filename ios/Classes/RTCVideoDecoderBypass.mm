@@ -10,6 +10,7 @@
     NSString *_trackId;
     RTCVideoCodecInfo *_codecInfo;
     BOOL _isRingBufferInitialized;
+    int32_t _nativeBufferHandle;
     RTCVideoDecoderCallback _callback;
 }
 
@@ -20,6 +21,7 @@
         _trackId = trackId ? [trackId copy] : nil;
         _codecInfo = codecInfo;
         _isRingBufferInitialized = NO;
+        _nativeBufferHandle = 0;
     }
     return self;
 }
@@ -49,8 +51,9 @@
 
 - (NSInteger)releaseDecoder {
     NSLog(@"RTCVideoDecoderBypass: Releasing decoder for trackId: %@", _trackId);
-    if (_trackId != nil && _isRingBufferInitialized) {
-        [NativeBufferBridge freeBuffer:_trackId];
+    if (_isRingBufferInitialized) {
+        [NativeBufferBridge freeBufferWithHandle:_nativeBufferHandle];
+        _nativeBufferHandle = 0;
         _isRingBufferInitialized = NO;
     }
     _trackId = nil;
@@ -83,8 +86,15 @@
         int capacity = 10;
         NSLog(@"RTCVideoDecoderBypass: Initialize native buffer: %@ with capacity: %d and buffer size: %d", _trackId, capacity, bufferSize);
 
-        BOOL initSuccess = [NativeBufferBridge initializeBuffer:_trackId capacity:capacity maxBufferSize:bufferSize];
-        if (!initSuccess) {
+        // decode is the only producer and the Dart isolate the only consumer, so
+        // the lock-free ring applies; dropping the oldest frame keeps the decoder
+        // thread from ever waiting on a stalled consumer.
+        _nativeBufferHandle = [NativeBufferBridge createBuffer:_trackId
+                                                      capacity:capacity
+                                                 maxBufferSize:bufferSize
+                                                          mode:NativeBufferModeSPSC
+                                                overflowPolicy:NativeBufferOverflowPolicyDropOldest];
+        if (_nativeBufferHandle == 0) {
             NSLog(@"RTCVideoDecoderBypass: Error - Failed to initialize native buffer for trackId: %@", _trackId);
             return WEBRTC_VIDEO_CODEC_ERROR;
         }
@@ -97,14 +107,14 @@
     int rotation = encodedImage.rotation;
     int frameType = (int)encodedImage.frameType;
     int codecTypeValue = [self codecStringToInt:(_codecInfo ? _codecInfo.name : nil)];
-    BOOL pushSuccess = [NativeBufferBridge pushVideoBuffer:_trackId
-                                                    buffer:buffer
-                                                     width:width
-                                                    height:height
-                                                 frameTime:renderTimeMs
-                                                  rotation:rotation
-                                                 frameType:frameType
-                                                 codecType:codecTypeValue];
+    BOOL pushSuccess = [NativeBufferBridge pushVideoBufferWithHandle:_nativeBufferHandle
+                                                              buffer:buffer
+                                                               width:width
+                                                              height:height
+                                                           frameTime:renderTimeMs
+                                                            rotation:rotation
+                                                           frameType:frameType
+                                                           codecType:codecTypeValue];
 
     if (!pushSuccess) {
         NSLog(@"RTCVideoDecoderBypass: Error - Failed to push frame to native buffer for trackId: %@", _trackId);
@@ -5,6 +5,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+struct NativeBufferStats;
+
 #if defined(_WIN32)
   #define FFI_PLUGIN_EXPORT __declspec(dllexport)
 #else
@@ -15,16 +17,90 @@
 extern "C" {
 #endif
 
-FFI_PLUGIN_EXPORT int initNativeBufferFFI(const char* key, int capacity, int maxBufferSize);
+typedef enum {
+  NOTIFY_MODE_PER_FRAME = 0,
+  NOTIFY_MODE_COALESCED = 1
+} NotifyMode;
+
+// mode: 0 = mutex-guarded ring, 1 = lock-free single-producer/single-consumer ring.
+// overflowPolicy: 0 = block, 1 = drop oldest, 2 = drop newest.
+// Returns a non-zero handle for the buffer registered under key (the existing
+// one if the key is already registered), or 0 on failure. A handle stays
+// valid until the buffer is freed; after that it is rejected rather than
+// reaching a buffer later registered in the same slot.
+FFI_PLUGIN_EXPORT int32_t initNativeBufferFFI(const char* key, int capacity, int maxBufferSize,
+  int mode, int overflowPolicy);
+// Returns the handle registered under key, or 0 if there is none.
+FFI_PLUGIN_EXPORT int32_t lookupNativeBufferFFI(const char* key);
+
 FFI_PLUGIN_EXPORT int pushVideoNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
   int width, int height, uint64_t frameTime, int rotation, int frameType, int codecType);
 FFI_PLUGIN_EXPORT int pushAudioNativeBufferFFI(const char* key, const uint8_t* buffer, size_t dataSize,
   int sampleRate, int channels, uint64_t frameTime);
 FFI_PLUGIN_EXPORT uintptr_t popNativeBufferFFI(const char* key);
+// Returns the next frame with its slot pinned until releaseNativeBufferFrameFFI
+// is called on it, so the payload can be read in place. The signature of the
+// release call matches a Dart NativeFinalizer callback.
+FFI_PLUGIN_EXPORT uintptr_t acquireNativeBufferFFI(const char* key);
+FFI_PLUGIN_EXPORT void releaseNativeBufferFrameFFI(void* frame);
+// Leases up to maxFrames queued frames into outFrames without waiting and
+// returns how many were written. Every returned frame must be released with
+// releaseNativeBufferFrameFFI. Also re-arms a coalesced wakeup for the key.
+FFI_PLUGIN_EXPORT int popBatchNativeBufferFFI(const char* key, uintptr_t* outFrames, int maxFrames);
+// Returns a standalone copy of the latest keyframe with the parameter sets
+// needed to decode it, or 0 if none has been pushed yet. Lets a consumer that
+// joins mid-stream start decoding at once. Release it with
+// releaseNativeBufferFrameFFI.
+FFI_PLUGIN_EXPORT uintptr_t acquirePrimingFrameFFI(const char* key);
 FFI_PLUGIN_EXPORT void freeNativeBufferFFI(const char* key);
 
+// Handle-based variants of the calls above. They take no global lock and
+// allocate nothing, so buffers for different tracks never contend.
+FFI_PLUGIN_EXPORT int pushVideoNativeBufferByHandleFFI(int32_t handle, const uint8_t* buffer, size_t dataSize,
+  int width, int height, uint64_t frameTime, int rotation, int frameType, int codecType);
+FFI_PLUGIN_EXPORT int pushAudioNativeBufferByHandleFFI(int32_t handle, const uint8_t* buffer, size_t dataSize,
+  int sampleRate, int channels, uint64_t frameTime);
+// Like pushAudioNativeBufferByHandleFFI, but fill writes the dataSize payload
+// bytes straight into the ring slot, so a caller copying them out of a Java
+// array or similar copies once. A fill that returns false fails the push.
+typedef bool (*NativeBufferFill)(uint8_t* dst, size_t dataSize, void* context);
+FFI_PLUGIN_EXPORT int pushAudioNativeBufferFilledByHandleFFI(int32_t handle, NativeBufferFill fill, void* context,
+  size_t dataSize, int sampleRate, int channels, uint64_t frameTime);
+FFI_PLUGIN_EXPORT uintptr_t popNativeBufferByHandleFFI(int32_t handle);
+FFI_PLUGIN_EXPORT uintptr_t acquireNativeBufferByHandleFFI(int32_t handle);
+// Returns -1 if the handle is stale, so the caller can look the key up again.
+FFI_PLUGIN_EXPORT int popBatchNativeBufferByHandleFFI(int32_t handle, uintptr_t* outFrames, int maxFrames);
+FFI_PLUGIN_EXPORT uintptr_t acquirePrimingFrameByHandleFFI(int32_t handle);
+FFI_PLUGIN_EXPORT void freeNativeBufferByHandleFFI(int32_t handle);
+
+// Copies the counters of the buffer for key (see NativeBufferStats in
+// NativeBuffer.h) into out. Lock-free on the buffer side, so it is cheap to
+// poll. Returns false if no buffer is registered under key.
+FFI_PLUGIN_EXPORT bool getNativeBufferStatsFFI(const char* key, struct NativeBufferStats* out);
+FFI_PLUGIN_EXPORT bool getNativeBufferStatsByHandleFFI(int32_t handle, struct NativeBufferStats* out);
+
+// Records the video pushed under key to a fragmented MP4 file at path, on a
+// native thread, until stopNativeRecordingFFI. The buffer need not exist yet
+// and may be recreated meanwhile. H.264, H.265 and AV1 are supported. A
+// fragment is cut at the first keyframe after fragmentDurationMs (<= 0 picks
+// a default). Returns false if the key is already being recorded.
+FFI_PLUGIN_EXPORT bool startNativeRecordingFFI(const char* key, const char* path, int fragmentDurationMs);
+// Continues the recording in newPath from the next keyframe on.
+FFI_PLUGIN_EXPORT bool rotateNativeRecordingFFI(const char* key, const char* newPath);
+// Finishes the current file. Returns false if the key was not being recorded
+// or if creating or writing a file failed.
+FFI_PLUGIN_EXPORT bool stopNativeRecordingFFI(const char* key);
+
+// Returns every cached payload block in the shared frame pool to the system.
+// Idle blocks are trimmed automatically, and the whole cache once no frame
+// holds a block; this is for memory-pressure events.
+FFI_PLUGIN_EXPORT void trimNativeBufferPoolFFI(void);
+
 FFI_PLUGIN_EXPORT bool initializeDartApiDL(void* data);
 FFI_PLUGIN_EXPORT bool registerDartPort(const char* channel_name, int64_t port);
+// NOTIFY_MODE_COALESCED posts at most one message until the consumer calls
+// popBatchNativeBufferFFI for the key; registerDartPort uses NOTIFY_MODE_PER_FRAME.
+FFI_PLUGIN_EXPORT bool registerDartPortWithMode(const char* channel_name, int64_t port, int notifyMode);
 
 #ifdef __cplusplus
 } // extern "C"
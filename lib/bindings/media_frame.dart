@@ -2,13 +2,185 @@ import 'dart:typed_data';
 import 'dart:ffi' as ffi;
 import 'native_bindings.dart';
 
+/// How many leased frames the stream helpers let consumers hold per native
+/// buffer. A leased frame keeps its native payload block until
+/// [MediaFrame.release] is called (or, failing that, until it is garbage
+/// collected), so this bounds the native memory a slow consumer can hold;
+/// it is half of the smallest ring (10 slots). Past it, frames are
+/// delivered as copies and released at once.
+const int maxLeasedFramesPerBuffer = 5;
+
+/// Counts the frames leased from one native buffer that are still pinned.
+class FrameLeaseBudget {
+  int _outstanding = 0;
+
+  int get outstanding => _outstanding;
+  bool get exhausted => _outstanding >= maxLeasedFramesPerBuffer;
+}
+
+/// Pins a native frame while its payload view is reachable. Each
+/// [MediaFrame] sharing it holds one reference, dropped by
+/// [MediaFrame.release]; the frame is released natively with the last one.
+/// The finalizers are only a backstop for frames a consumer never releases.
+class _FrameLease implements ffi.Finalizable {
+  _FrameLease(this._ptr, this._budget) {
+    _nativeFinalizer.attach(this, _ptr!.cast(), detach: this);
+    final budget = _budget;
+    if (budget != null) {
+      budget._outstanding++;
+      _budgetFinalizer.attach(this, budget, detach: this);
+    }
+  }
+
+  static final _nativeFinalizer =
+      ffi.NativeFinalizer(releaseNativeBufferFramePtr);
+  static final _budgetFinalizer =
+      Finalizer<FrameLeaseBudget>((budget) => budget._outstanding--);
+  // Keeps the lease reachable for as long as the payload view is, even if
+  // the frame object itself is dropped.
+  static final _views = Expando<_FrameLease>();
+
+  ffi.Pointer<MediaFrameNative>? _ptr;
+  final FrameLeaseBudget? _budget;
+  int _holders = 1;
+
+  Uint8List view() {
+    final nativeFrame = _ptr!.ref;
+    final payload = nativeFrame.buffer.asTypedList(nativeFrame.bufferSize);
+    _views[payload] = this;
+    return payload;
+  }
+
+  _FrameLease retain() {
+    if (_ptr == null) throw StateError('Frame already released');
+    _holders++;
+    return this;
+  }
+
+  void release() {
+    final ptr = _ptr;
+    if (ptr == null || --_holders > 0) return;
+    _ptr = null;
+    _nativeFinalizer.detach(this);
+    final budget = _budget;
+    if (budget != null) {
+      _budgetFinalizer.detach(this);
+      budget._outstanding--;
+    }
+    releaseNativeBufferFrame(ptr.cast());
+  }
+}
+
+/// Takes ownership of the native frame at [ptr] and returns its payload,
+/// plus the lease pinning it when the payload is not a copy. Without a
+/// [budget] the frame is always leased.
+(Uint8List, _FrameLease?) _takePayload(
+    ffi.Pointer<MediaFrameNative> ptr, FrameLeaseBudget? budget) {
+  if (budget != null && budget.exhausted) {
+    final nativeFrame = ptr.ref;
+    final copy = Uint8List.fromList(
+        nativeFrame.buffer.asTypedList(nativeFrame.bufferSize));
+    releaseNativeBufferFrame(ptr.cast());
+    return (copy, null);
+  }
+  final lease = _FrameLease(ptr, budget);
+  return (lease.view(), lease);
+}
+
+/// A NAL unit (H.264/H.265) or OBU (AV1) inside an encoded frame's buffer.
+/// [offset] points at the unit header, past any Annex-B start code.
+class NalUnit {
+  const NalUnit({
+    required this.offset,
+    required this.size,
+    required this.type,
+    required this.temporalId,
+  });
+  final int offset;
+  final int size;
+  final int type;
+
+  /// -1 when the bitstream does not signal it.
+  final int temporalId;
+}
+
+/// Index of an encoded frame built natively when the frame was pushed, so
+/// consumers need not rescan the payload. See [AccessUnitFlags].
+class AccessUnitInfo {
+  const AccessUnitInfo({
+    required this.flags,
+    required this.temporalId,
+    required this.units,
+  });
+
+  factory AccessUnitInfo.fromNative(AccessUnitIndexNative index) {
+    final count = index.nalCount < maxAccessUnitNals
+        ? index.nalCount
+        : maxAccessUnitNals;
+    return AccessUnitInfo(
+      flags: index.flags,
+      temporalId: index.temporalId,
+      units: List<NalUnit>.generate(count, (i) {
+        final unit = index.nals[i];
+        return NalUnit(
+          offset: unit.offset,
+          size: unit.size,
+          type: unit.type,
+          temporalId: unit.temporalId,
+        );
+      }, growable: false),
+    );
+  }
+
+  final int flags;
+  final int temporalId;
+  final List<NalUnit> units;
+
+  bool get isKeyFrame => flags & AccessUnitFlags.keyFrame != 0;
+  bool get hasParameterSets =>
+      flags &
+          (AccessUnitFlags.hasSps |
+              AccessUnitFlags.hasPps |
+              AccessUnitFlags.hasVps |
+              AccessUnitFlags.hasSequenceHeader) !=
+      0;
+}
+
 abstract class MediaFrame {
   MediaFrame({
     required this.frameTime,
     required this.buffer,
   });
   final int frameTime;
+
+  /// The payload. For frames built with `fromPointer` this views native
+  /// memory and must not be read after [release].
   final Uint8List buffer;
+
+  _FrameLease? _lease;
+  bool _released = false;
+
+  /// Returns another handle on this frame, with the same payload and its
+  /// own [release]. The native frame is released once every handle is, so
+  /// each consumer of a frame fanned out to several can release it
+  /// independently. Throws if this handle was already released.
+  MediaFrame share();
+
+  _FrameLease? _retainLease() {
+    if (_released) throw StateError('Frame already released');
+    return _lease?.retain();
+  }
+
+  /// Returns the native frame backing [buffer] to its buffer. Call it as
+  /// soon as the payload has been consumed: until then the frame holds a
+  /// native payload block, and [maxLeasedFramesPerBuffer] outstanding
+  /// frames switch a stream to copies. Safe to call more than once, and a
+  /// no-op for frames that hold a copy.
+  void release() {
+    _released = true;
+    _lease?.release();
+    _lease = null;
+  }
 }
 
 class EncodedVideoFrame extends MediaFrame {
@@ -19,14 +191,16 @@ class EncodedVideoFrame extends MediaFrame {
     required this.rotation,
     required this.frameType,
     required this.codecType,
+    required this.accessUnit,
     required super.buffer,
   });
 
-  factory EncodedVideoFrame.fromPointer(ffi.Pointer<MediaFrameNative> ptr) {
+  /// Takes ownership of the native frame at [ptr]. Frames leased against an
+  /// exhausted [budget] are copied and their slot released right away.
+  factory EncodedVideoFrame.fromPointer(ffi.Pointer<MediaFrameNative> ptr,
+      {FrameLeaseBudget? budget}) {
     final nativeFrame = ptr.ref;
-    Uint8List bufferList =
-        nativeFrame.buffer.asTypedList(nativeFrame.bufferSize);
-    Uint8List buffer = Uint8List.fromList(bufferList);
+    final (buffer, lease) = _takePayload(ptr, budget);
 
     return EncodedVideoFrame(
       width: nativeFrame.metadata.video.width,
@@ -35,14 +209,29 @@ class EncodedVideoFrame extends MediaFrame {
       rotation: nativeFrame.metadata.video.rotation,
       frameType: nativeFrame.metadata.video.frameType,
       codecType: nativeFrame.metadata.video.codecType,
+      accessUnit: AccessUnitInfo.fromNative(nativeFrame.accessUnit),
       buffer: buffer,
-    );
+    ).._lease = lease;
   }
+
+  @override
+  EncodedVideoFrame share() => EncodedVideoFrame(
+        width: width,
+        height: height,
+        frameTime: frameTime,
+        rotation: rotation,
+        frameType: frameType,
+        codecType: codecType,
+        accessUnit: accessUnit,
+        buffer: buffer,
+      ).._lease = _retainLease();
+
   final int width;
   final int height;
   final int rotation;
   final int frameType;
   final int codecType;
+  final AccessUnitInfo accessUnit;
 }
 
 class DecodedAudioSample extends MediaFrame {
@@ -53,19 +242,29 @@ class DecodedAudioSample extends MediaFrame {
     required super.buffer,
   });
 
-  factory DecodedAudioSample.fromPointer(ffi.Pointer<MediaFrameNative> ptr) {
+  /// Takes ownership of the native frame at [ptr]. Frames leased against an
+  /// exhausted [budget] are copied and their slot released right away.
+  factory DecodedAudioSample.fromPointer(ffi.Pointer<MediaFrameNative> ptr,
+      {FrameLeaseBudget? budget}) {
     final nativeFrame = ptr.ref;
-    Uint8List bufferList =
-        nativeFrame.buffer.asTypedList(nativeFrame.bufferSize);
-    Uint8List buffer = Uint8List.fromList(bufferList);
+    final (buffer, lease) = _takePayload(ptr, budget);
 
     return DecodedAudioSample(
       sampleRate: nativeFrame.metadata.audio.sampleRate,
       channels: nativeFrame.metadata.audio.channels,
       frameTime: nativeFrame.frameTime,
       buffer: buffer,
-    );
+    ).._lease = lease;
   }
+
+  @override
+  DecodedAudioSample share() => DecodedAudioSample(
+        sampleRate: sampleRate,
+        channels: channels,
+        frameTime: frameTime,
+        buffer: buffer,
+      ).._lease = _retainLease();
+
   final int sampleRate;
   final int channels;
 }
@@ -66,6 +66,51 @@ base class MediaMetadata extends ffi.Union {
   external AudioMetadata audio;
 }
 
+/// Mirrors MAX_ACCESS_UNIT_NALS in NativeBuffer.h.
+const int maxAccessUnitNals = 32;
+
+/// Mirrors AccessUnitFlags in NativeBuffer.h.
+abstract final class AccessUnitFlags {
+  static const int keyFrame = 1 << 0;
+  static const int hasSps = 1 << 1;
+  static const int hasPps = 1 << 2;
+  static const int hasVps = 1 << 3;
+  static const int hasSequenceHeader = 1 << 4;
+  static const int truncated = 1 << 5;
+  static const int malformed = 1 << 6;
+}
+
+base class NalUnitInfoNative extends ffi.Struct {
+  @ffi.Uint32()
+  external int offset;
+
+  @ffi.Uint32()
+  external int size;
+
+  @ffi.Uint8()
+  external int type;
+
+  @ffi.Int8()
+  external int temporalId;
+
+  @ffi.Uint16()
+  external int reserved;
+}
+
+base class AccessUnitIndexNative extends ffi.Struct {
+  @ffi.Uint32()
+  external int flags;
+
+  @ffi.Int32()
+  external int temporalId;
+
+  @ffi.Uint32()
+  external int nalCount;
+
+  @ffi.Array(maxAccessUnitNals)
+  external ffi.Array<NalUnitInfoNative> nals;
+}
+
 base class MediaFrameNative extends ffi.Struct {
   @ffi.Int32()
   external int mediaType;
@@ -82,6 +127,102 @@ base class MediaFrameNative extends ffi.Struct {
   external int bufferCapacity;
 
   external MediaMetadata metadata;
+
+  external AccessUnitIndexNative accessUnit;
+}
+
+/// Mirrors NATIVE_BUFFER_HISTOGRAM_BUCKETS in NativeBuffer.h.
+const int nativeBufferHistogramBuckets = 24;
+
+/// Mirrors NativeBufferStats in NativeBuffer.h.
+base class NativeBufferStatsNative extends ffi.Struct {
+  @ffi.Uint64()
+  external int pushedFrames;
+
+  @ffi.Uint64()
+  external int poppedFrames;
+
+  @ffi.Uint64()
+  external int droppedFrames;
+
+  @ffi.Uint64()
+  external int failedPushes;
+
+  @ffi.Uint64()
+  external int blockedPushes;
+
+  @ffi.Uint64()
+  external int blockedNanos;
+
+  @ffi.Uint64()
+  external int reallocations;
+
+  @ffi.Uint64()
+  external int bytesPushed;
+
+  @ffi.Uint64()
+  external int bytesPopped;
+
+  @ffi.Uint64()
+  external int maxQueueDepth;
+
+  @ffi.Uint64()
+  external int latencySumMicros;
+
+  @ffi.Uint64()
+  external int maxLatencyMicros;
+
+  @ffi.Array(nativeBufferHistogramBuckets)
+  external ffi.Array<ffi.Uint64> queueDepthHistogram;
+
+  @ffi.Array(nativeBufferHistogramBuckets)
+  external ffi.Array<ffi.Uint64> latencyHistogramMicros;
+}
+
+/// Counters of one native buffer since it was created. Histogram bucket 0
+/// counts zero values and bucket i counts values in [2^(i-1), 2^i); the last
+/// bucket also takes everything larger.
+class NativeBufferStats {
+  NativeBufferStats._fromNative(NativeBufferStatsNative stats)
+      : pushedFrames = stats.pushedFrames,
+        poppedFrames = stats.poppedFrames,
+        droppedFrames = stats.droppedFrames,
+        failedPushes = stats.failedPushes,
+        blockedPushes = stats.blockedPushes,
+        blockedTime = Duration(microseconds: stats.blockedNanos ~/ 1000),
+        reallocations = stats.reallocations,
+        bytesPushed = stats.bytesPushed,
+        bytesPopped = stats.bytesPopped,
+        maxQueueDepth = stats.maxQueueDepth,
+        latencySumMicros = stats.latencySumMicros,
+        maxLatencyMicros = stats.maxLatencyMicros,
+        queueDepthHistogram = List<int>.generate(nativeBufferHistogramBuckets,
+            (i) => stats.queueDepthHistogram[i],
+            growable: false),
+        latencyHistogramMicros = List<int>.generate(
+            nativeBufferHistogramBuckets, (i) => stats.latencyHistogramMicros[i],
+            growable: false);
+
+  final int pushedFrames;
+  final int poppedFrames;
+  final int droppedFrames;
+  final int failedPushes;
+  final int blockedPushes;
+  final Duration blockedTime;
+  final int reallocations;
+  final int bytesPushed;
+  final int bytesPopped;
+  final int maxQueueDepth;
+  final int latencySumMicros;
+  final int maxLatencyMicros;
+  final List<int> queueDepthHistogram;
+  final List<int> latencyHistogramMicros;
+
+  /// Frames pushed but not yet popped, including ones dropped later.
+  int get backlog => pushedFrames - poppedFrames;
+
+  double get meanLatencyMicros =>
+      poppedFrames == 0 ? 0 : latencySumMicros / poppedFrames;
 }
 
 typedef InitializeDartApiDLFunc = ffi.Bool Function(ffi.Pointer<ffi.Void>);
@@ -92,18 +233,89 @@ final _initializeApi = _nativeLib
 
 typedef RegisterDartPortFunc = ffi.Bool Function(ffi.Pointer<Utf8>, ffi.Int64);
 typedef RegisterDartPort = bool Function(ffi.Pointer<Utf8>, int);
-final _registerPort = _nativeLib
-    .lookup<ffi.NativeFunction<RegisterDartPortFunc>>('registerDartPort')
-    .asFunction<RegisterDartPort>();
 
-typedef _NativeBufferPopNative = ffi.Pointer<MediaFrameNative> Function(
-    ffi.Pointer<Utf8> key);
-typedef NativeBufferPopDart = ffi.Pointer<MediaFrameNative> Function(
+/// Mirrors NotifyMode in native_buffer_api.h.
+const int _notifyModeCoalesced = 1;
+
+typedef RegisterDartPortWithModeFunc = ffi.Bool Function(
+    ffi.Pointer<Utf8>, ffi.Int64, ffi.Int32);
+typedef RegisterDartPortWithMode = bool Function(ffi.Pointer<Utf8>, int, int);
+final _registerPortWithMode = _nativeLib
+    .lookup<ffi.NativeFunction<RegisterDartPortWithModeFunc>>(
+        'registerDartPortWithMode')
+    .asFunction<RegisterDartPortWithMode>();
+
+typedef _NativeBufferLookupNative = ffi.Int32 Function(ffi.Pointer<Utf8> key);
+typedef NativeBufferLookupDart = int Function(ffi.Pointer<Utf8> key);
+final NativeBufferLookupDart _nativeBufferLookup = _nativeLib
+    .lookup<ffi.NativeFunction<_NativeBufferLookupNative>>(
+        "lookupNativeBufferFFI")
+    .asFunction();
+
+typedef _NativeBufferPopBatchNative = ffi.Int32 Function(
+    ffi.Int32 handle, ffi.Pointer<ffi.UintPtr> outFrames, ffi.Int32 max);
+typedef NativeBufferPopBatchDart = int Function(
+    int handle, ffi.Pointer<ffi.UintPtr> outFrames, int max);
+final NativeBufferPopBatchDart _nativeBufferPopBatch = _nativeLib
+    .lookup<ffi.NativeFunction<_NativeBufferPopBatchNative>>(
+        "popBatchNativeBufferByHandleFFI")
+    .asFunction();
+
+typedef _AcquirePrimingFrameNative = ffi.UintPtr Function(
     ffi.Pointer<Utf8> key);
-final NativeBufferPopDart _nativeBufferPop = _nativeLib
-    .lookup<ffi.NativeFunction<_NativeBufferPopNative>>("popNativeBufferFFI")
+typedef AcquirePrimingFrameDart = int Function(ffi.Pointer<Utf8> key);
+final AcquirePrimingFrameDart _acquirePrimingFrame = _nativeLib
+    .lookup<ffi.NativeFunction<_AcquirePrimingFrameNative>>(
+        "acquirePrimingFrameFFI")
     .asFunction();
 
+typedef _GetNativeBufferStatsNative = ffi.Bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<NativeBufferStatsNative> out);
+typedef GetNativeBufferStatsDart = bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<NativeBufferStatsNative> out);
+final GetNativeBufferStatsDart _getNativeBufferStats = _nativeLib
+    .lookup<ffi.NativeFunction<_GetNativeBufferStatsNative>>(
+        "getNativeBufferStatsFFI")
+    .asFunction();
+
+typedef _StartNativeRecordingNative = ffi.Bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<Utf8> path, ffi.Int32 fragmentMs);
+typedef StartNativeRecordingDart = bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<Utf8> path, int fragmentMs);
+final StartNativeRecordingDart _startNativeRecording = _nativeLib
+    .lookup<ffi.NativeFunction<_StartNativeRecordingNative>>(
+        "startNativeRecordingFFI")
+    .asFunction();
+
+typedef _RotateNativeRecordingNative = ffi.Bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<Utf8> path);
+typedef RotateNativeRecordingDart = bool Function(
+    ffi.Pointer<Utf8> key, ffi.Pointer<Utf8> path);
+final RotateNativeRecordingDart _rotateNativeRecording = _nativeLib
+    .lookup<ffi.NativeFunction<_RotateNativeRecordingNative>>(
+        "rotateNativeRecordingFFI")
+    .asFunction();
+
+typedef _StopNativeRecordingNative = ffi.Bool Function(ffi.Pointer<Utf8> key);
+typedef StopNativeRecordingDart = bool Function(ffi.Pointer<Utf8> key);
+final StopNativeRecordingDart _stopNativeRecording = _nativeLib
+    .lookup<ffi.NativeFunction<_StopNativeRecordingNative>>(
+        "stopNativeRecordingFFI")
+    .asFunction();
+
+/// Unpins a frame leased by `acquireNativeBufferFFI` or
+/// `popBatchNativeBufferFFI`, or frees one from `acquirePrimingFrameFFI`.
+/// Called by [MediaFrame.release], and attached as the finalizer of the
+/// zero-copy payload views built in media_frame.dart for frames that are
+/// never released.
+final ffi.Pointer<ffi.NativeFinalizerFunction> releaseNativeBufferFramePtr =
+    _nativeLib.lookup<ffi.NativeFinalizerFunction>(
+        "releaseNativeBufferFrameFFI");
+final void Function(ffi.Pointer<ffi.Void>) releaseNativeBufferFrame =
+    releaseNativeBufferFramePtr
+        .cast<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>()
+        .asFunction();
+
 class WebRTCMediaStreamer {
   factory WebRTCMediaStreamer() => _instance;
   WebRTCMediaStreamer._internal() {
@@ -113,37 +325,148 @@ class WebRTCMediaStreamer {
 
   final Map<String, StreamController<EncodedVideoFrame>>
       _videoStreamControllers = {};
+  // Synchronous, so every listener has taken its own handle on a frame by
+  // the time the drain releases the one it delivered.
   final StreamController<DecodedAudioSample> _audioStreamController =
-      StreamController<DecodedAudioSample>.broadcast();
+      StreamController<DecodedAudioSample>.broadcast(sync: true);
   final Map<String, ReceivePort> _receivePorts = {};
+  final Map<String, ffi.Pointer<Utf8>> _nativeKeys = {};
+  final Map<String, int> _nativeHandles = {};
+  final Map<String, FrameLeaseBudget> _leaseBudgets = {};
+  static const int _maxFramesPerBatch = 32;
+  static final ffi.Pointer<ffi.UintPtr> _batchFrames =
+      calloc<ffi.UintPtr>(_maxFramesPerBatch);
+  static final ffi.Pointer<NativeBufferStatsNative> _statsScratch =
+      calloc<NativeBufferStatsNative>();
   static final Completer<bool> _dartApiInitializationCompleter =
       Completer<bool>();
   static bool _dartApiInitialized = false;
   bool _audioStreamInitialized = false;
 
+  /// Encoded frames of [trackId]. Payloads view native memory: call
+  /// [MediaFrame.release] once a frame is consumed. At most
+  /// [maxLeasedFramesPerBuffer] frames stay pinned per track; beyond that
+  /// frames arrive as copies. Each listener gets its own handle on a frame
+  /// (see [MediaFrame.share]) and releases it independently.
   Future<Stream<EncodedVideoFrame>> videoFramesFrom(String trackId) async {
     await _dartApiInitializationCompleter.future;
-    if (_videoStreamControllers.containsKey(trackId)) {
-      return _videoStreamControllers[trackId]!.stream;
+    final existing = _videoStreamControllers[trackId];
+    if (existing != null) {
+      return _primedVideoStream(trackId, existing.stream);
     }
 
     final controller = _createVideoStreamController(trackId);
     await _setupFrameNotifications(trackId, controller);
+    return _primedVideoStream(trackId, controller.stream);
+  }
+
+  /// Reads the counters of the native buffer for [trackId], or of the audio
+  /// buffer for [audioKey]. Returns null while no buffer exists. Cheap
+  /// enough to poll, e.g. to alert on a lagging consumer.
+  NativeBufferStats? bufferStats(String key) {
+    final found = using((arena) =>
+        _getNativeBufferStats(key.toNativeUtf8(allocator: arena), _statsScratch));
+    return found ? NativeBufferStats._fromNative(_statsScratch.ref) : null;
+  }
+
+  /// Records the encoded video of [trackId] to a fragmented MP4 at [path].
+  /// Muxing runs on a native thread fed straight from the decoder bypass, so
+  /// frames never cross into Dart. H.264, H.265 and AV1 are supported.
+  bool startRecording(String trackId, String path,
+      {Duration fragmentDuration = const Duration(seconds: 2)}) {
+    return using((arena) => _startNativeRecording(
+        trackId.toNativeUtf8(allocator: arena),
+        path.toNativeUtf8(allocator: arena),
+        fragmentDuration.inMilliseconds));
+  }
+
+  /// Continues the recording of [trackId] in a new file at [path], starting
+  /// at the next keyframe.
+  bool rotateRecording(String trackId, String path) {
+    return using((arena) => _rotateNativeRecording(
+        trackId.toNativeUtf8(allocator: arena),
+        path.toNativeUtf8(allocator: arena)));
+  }
+
+  /// Finishes the recording of [trackId]. Returns false if the track was not
+  /// being recorded or a file could not be written.
+  bool stopRecording(String trackId) {
+    return using((arena) =>
+        _stopNativeRecording(trackId.toNativeUtf8(allocator: arena)));
+  }
+
+  /// Gives each listener of [live] the latest keyframe, with the parameter
+  /// sets needed to decode it, before any live frame, so a subscriber that
+  /// joins mid-stream need not wait a full GOP. Live frames no newer than
+  /// that keyframe are skipped until the stream catches up with it.
+  Stream<EncodedVideoFrame> _primedVideoStream(
+      String trackId, Stream<EncodedVideoFrame> live) {
+    return _perListenerStream(live,
+        primer: () => _acquirePrimingVideoFrame(trackId));
+  }
+
+  /// Gives each listener of the synchronous broadcast [live] its own handle
+  /// on every frame, optionally preceded by a [primer] frame. The handle is
+  /// taken while [live] delivers, before the drain releases its own, so
+  /// the subscription to [live] is never paused: a paused listener's
+  /// handles queue in its controller instead.
+  Stream<T> _perListenerStream<T extends MediaFrame>(Stream<T> live,
+      {T? Function()? primer}) {
+    late StreamController<T> controller;
+    StreamSubscription<T>? subscription;
+    controller = StreamController<T>(
+      onListen: () {
+        final first = primer?.call();
+        var skipUntil = -1;
+        if (first != null) {
+          skipUntil = first.frameTime;
+          controller.add(first);
+        }
+        // Subscribing in the same turn as the primer is taken means no live
+        // frame can be drained in between.
+        subscription = live.listen(
+          (frame) {
+            if (frame.frameTime <= skipUntil) return;
+            skipUntil = -1;
+            controller.add(frame.share() as T);
+          },
+          onError: controller.addError,
+          onDone: controller.close,
+        );
+      },
+      onCancel: () => subscription?.cancel(),
+    );
     return controller.stream;
   }
 
+  EncodedVideoFrame? _acquirePrimingVideoFrame(String trackId) {
+    final keyPtr = _nativeKeys[trackId];
+    if (keyPtr == null) return null;
+    final address = _acquirePrimingFrame(keyPtr);
+    if (address == 0) return null;
+    final framePtr = ffi.Pointer<MediaFrameNative>.fromAddress(address);
+    if (framePtr.ref.mediaType != MediaType.video.value) {
+      releaseNativeBufferFrame(framePtr.cast());
+      return null;
+    }
+    return EncodedVideoFrame.fromPointer(framePtr);
+  }
+
+  /// Decoded audio. Release samples as for [videoFramesFrom].
   Future<Stream<DecodedAudioSample>> audioFrames() async {
     await _dartApiInitializationCompleter.future;
     if (!_audioStreamInitialized) {
       await _initializeAudioStream();
     }
-    return _audioStreamController.stream;
+    return _perListenerStream(_audioStreamController.stream);
   }
 
   StreamController<EncodedVideoFrame> _createVideoStreamController(
       String trackId) {
     late StreamController<EncodedVideoFrame> controller;
+    // Synchronous for the same reason as _audioStreamController.
     controller = StreamController<EncodedVideoFrame>.broadcast(
+      sync: true,
       onListen: () {},
       onCancel: () {
         if (!controller.hasListener) {
@@ -162,29 +485,19 @@ class WebRTCMediaStreamer {
     final trackIdPtr = trackId.toNativeUtf8();
 
     try {
-      final registered =
-          _registerPort(trackIdPtr, receivePort.sendPort.nativePort);
+      final registered = _registerPortWithMode(
+          trackIdPtr, receivePort.sendPort.nativePort, _notifyModeCoalesced);
       if (!registered) {
-        receivePort.close();
         throw StateError("Failed to register native port for track: $trackId");
       }
 
       _receivePorts[trackId] = receivePort;
-      receivePort.listen((message) {
-        final currentController = _videoStreamControllers[trackId];
-        if (currentController != null && currentController.hasListener) {
-          final frame = _fetchVideoFrame(trackId);
-          if (frame != null && !currentController.isClosed) {
-            currentController.add(frame);
-          }
-        }
-      });
+      _nativeKeys[trackId] = trackIdPtr;
+      receivePort.listen((message) => _drainVideoFrames(trackId));
     } catch (e) {
       receivePort.close();
       calloc.free(trackIdPtr);
       rethrow;
-    } finally {
-      calloc.free(trackIdPtr);
     }
   }
 
@@ -195,30 +508,21 @@ class WebRTCMediaStreamer {
     final audioKeyPtr = audioKey.toNativeUtf8();
 
     try {
-      final registered =
-          _registerPort(audioKeyPtr, receivePort.sendPort.nativePort);
+      final registered = _registerPortWithMode(
+          audioKeyPtr, receivePort.sendPort.nativePort, _notifyModeCoalesced);
       if (!registered) {
-        receivePort.close();
         throw StateError("Failed to register native port for audio");
       }
 
       _receivePorts[audioKey] = receivePort;
-      receivePort.listen((message) {
-        if (_audioStreamController.hasListener) {
-          final frame = _fetchAudioSample();
-          if (frame != null && !_audioStreamController.isClosed) {
-            _audioStreamController.add(frame);
-          }
-        }
-      });
+      _nativeKeys[audioKey] = audioKeyPtr;
+      receivePort.listen((message) => _drainAudioSamples());
 
       _audioStreamInitialized = true;
     } catch (e) {
       receivePort.close();
       calloc.free(audioKeyPtr);
       rethrow;
-    } finally {
-      calloc.free(audioKeyPtr);
     }
   }
 
@@ -242,50 +546,77 @@ class WebRTCMediaStreamer {
     await _dartApiInitializationCompleter.future;
   }
 
-  EncodedVideoFrame? _fetchVideoFrame(String trackId) {
-    final keyPtr = trackId.toNativeUtf8();
-    ffi.Pointer<MediaFrameNative> framePtr = ffi.nullptr;
-    try {
-      framePtr = _nativeBufferPop(keyPtr);
-      if (framePtr == ffi.nullptr || framePtr.address == 0) {
-        return null;
+  void _drainVideoFrames(String trackId) {
+    _drainFrames(trackId, (framePtr) {
+      final controller = _videoStreamControllers[trackId];
+      if (controller == null ||
+          controller.isClosed ||
+          !controller.hasListener ||
+          framePtr.ref.mediaType != MediaType.video.value) {
+        return false;
       }
+      final frame = EncodedVideoFrame.fromPointer(framePtr,
+          budget: _leaseBudgets.putIfAbsent(trackId, FrameLeaseBudget.new));
+      controller.add(frame);
+      // Every listener now holds its own handle.
+      frame.release();
+      return true;
+    });
+  }
 
-      final nativeFrame = framePtr.ref;
-      final mediaType = MediaType.fromValue(nativeFrame.mediaType);
-
-      if (mediaType != MediaType.video) {
-        return null;
+  void _drainAudioSamples() {
+    _drainFrames(audioKey, (framePtr) {
+      if (_audioStreamController.isClosed ||
+          !_audioStreamController.hasListener ||
+          framePtr.ref.mediaType != MediaType.audio.value) {
+        return false;
       }
-      return EncodedVideoFrame.fromPointer(framePtr);
-    } catch (e) {
-      return null;
-    } finally {
-      calloc.free(keyPtr);
-    }
+      final sample = DecodedAudioSample.fromPointer(framePtr,
+          budget: _leaseBudgets.putIfAbsent(audioKey, FrameLeaseBudget.new));
+      _audioStreamController.add(sample);
+      sample.release();
+      return true;
+    });
   }
 
-  DecodedAudioSample? _fetchAudioSample() {
-    final keyPtr = audioKey.toNativeUtf8();
-    ffi.Pointer<MediaFrameNative> framePtr = ffi.nullptr;
-    try {
-      framePtr = _nativeBufferPop(keyPtr);
-      if (framePtr == ffi.nullptr || framePtr.address == 0) {
-        return null;
+  /// Drains everything queued for [key] in batches of [_maxFramesPerBatch],
+  /// which also re-arms the coalesced wakeup. [deliver] returns false when it
+  /// did not take the frame, in which case the lease is released right away.
+  void _drainFrames(
+      String key, bool Function(ffi.Pointer<MediaFrameNative>) deliver) {
+    int count;
+    do {
+      count = _popBatch(key);
+      for (var i = 0; i < count; i++) {
+        final framePtr =
+            ffi.Pointer<MediaFrameNative>.fromAddress(_batchFrames[i]);
+        if (!deliver(framePtr)) {
+          releaseNativeBufferFrame(framePtr.cast());
+        }
       }
+    } while (count == _maxFramesPerBatch);
+  }
 
-      final nativeFrame = framePtr.ref;
-      final mediaType = MediaType.fromValue(nativeFrame.mediaType);
-
-      if (mediaType != MediaType.audio) {
-        return null;
+  /// Pops a batch through the cached native handle for [key]. The handle is
+  /// looked up on first use and again once the native side reports it stale,
+  /// which happens when the decoder recreates the buffer.
+  int _popBatch(String key) {
+    final keyPtr = _nativeKeys[key];
+    if (keyPtr == null) return 0;
+    var handle = _nativeHandles[key] ?? 0;
+    for (var attempt = 0; attempt < 2; attempt++) {
+      if (handle == 0) {
+        handle = _nativeBufferLookup(keyPtr);
+        if (handle == 0) return 0;
+        _nativeHandles[key] = handle;
       }
-      return DecodedAudioSample.fromPointer(framePtr);
-    } catch (e) {
-      return null;
-    } finally {
-      calloc.free(keyPtr);
+      final count =
+          _nativeBufferPopBatch(handle, _batchFrames, _maxFramesPerBatch);
+      if (count >= 0) return count;
+      handle = 0;
+      _nativeHandles.remove(key);
     }
+    return 0;
   }
 
   void _cleanupTrackResources(String trackId) {
@@ -294,6 +625,16 @@ class WebRTCMediaStreamer {
 
     _receivePorts[trackId]?.close();
     _receivePorts.remove(trackId);
+
+    _freeNativeKey(trackId);
+  }
+
+  void _freeNativeKey(String key) {
+    _nativeHandles.remove(key);
+    final keyPtr = _nativeKeys.remove(key);
+    if (keyPtr != null) {
+      calloc.free(keyPtr);
+    }
   }
 
   void dispose() {
@@ -305,5 +646,6 @@ class WebRTCMediaStreamer {
     _audioStreamInitialized = false;
     _receivePorts[audioKey]?.close();
     _receivePorts.remove(audioKey);
+    _freeNativeKey(audioKey);
   }
 }
@@ -20,7 +20,7 @@ class RTCPeerConnectionNative extends RTCPeerConnection {
   RTCPeerConnectionNative(this._peerConnectionId, this._configuration) {
     _eventSubscription = _eventChannelFor(_peerConnectionId)
         .receiveBroadcastStream()
-        .listen(eventListener, onError: errorListener);
+        .listen(unbatchEvents(eventListener), onError: errorListener);
   }
 
   // private:
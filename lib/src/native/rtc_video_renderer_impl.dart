@@ -28,7 +28,7 @@ class RTCVideoRenderer extends ValueNotifier<RTCVideoValue>
     _textureId = response['textureId'];
     _eventSubscription = EventChannel('FlutterWebRTC/Texture$textureId')
         .receiveBroadcastStream()
-        .listen(eventListener, onError: errorListener);
+        .listen(unbatchEvents(eventListener), onError: errorListener);
     _initializing!.complete(null);
   }
 
@@ -95,6 +95,67 @@ class RTCVideoRenderer extends ValueNotifier<RTCVideoValue>
     }
   }
 
+  /// Caps how many frames per second this renderer converts and shows;
+  /// frames above the budget are dropped natively before any conversion.
+  /// Pass 0 to remove the cap. Supported on desktop platforms.
+  Future<void> setMaxFps(double maxFps) async {
+    if (_disposed) {
+      throw 'Can\'t set maxFps: The RTCVideoRenderer is disposed';
+    }
+    if (_textureId == null) throw 'Call initialize before setting maxFps';
+    try {
+      await WebRTC.invokeMethod('videoRendererSetMaxFps', <String, dynamic>{
+        'textureId': _textureId,
+        'maxFps': maxFps,
+      });
+    } on PlatformException catch (e) {
+      throw 'Got exception for RTCVideoRenderer::setMaxFps: ${e.message}';
+    }
+  }
+
+  /// When enabled, frames are rotated natively while they are converted, so
+  /// the texture is always upright and [RTCVideoValue.rotation] stays 0.
+  /// Supported on desktop platforms.
+  Future<void> setNativeRotation(bool enabled) async {
+    if (_disposed) {
+      throw 'Can\'t set native rotation: The RTCVideoRenderer is disposed';
+    }
+    if (_textureId == null) {
+      throw 'Call initialize before setting native rotation';
+    }
+    try {
+      await WebRTC.invokeMethod(
+          'videoRendererSetNativeRotation', <String, dynamic>{
+        'textureId': _textureId,
+        'enabled': enabled,
+      });
+    } on PlatformException catch (e) {
+      throw 'Got exception for RTCVideoRenderer::setNativeRotation: ${e.message}';
+    }
+  }
+
+  /// Reads this renderer's native counters, for diagnostics:
+  /// `skippedConversions` counts conversions that were not needed (repaints
+  /// of the frame already converted, and frames replaced by a newer one
+  /// before conversion), `decimatedFrames` the frames dropped by
+  /// [setMaxFps], and `droppedEvents` the renderer events that could not be
+  /// queued for Dart. Supported on desktop platforms.
+  Future<Map<String, int>> getStats() async {
+    if (_disposed) {
+      throw 'Can\'t get stats: The RTCVideoRenderer is disposed';
+    }
+    if (_textureId == null) throw 'Call initialize before getting stats';
+    try {
+      final response = await WebRTC.invokeMethod(
+          'videoRendererGetStats', <String, dynamic>{
+        'textureId': _textureId,
+      });
+      return Map<String, int>.from(response);
+    } on PlatformException catch (e) {
+      throw 'Got exception for RTCVideoRenderer::getStats: ${e.message}';
+    }
+  }
+
   @override
   Future<void> dispose() async {
     if (_disposed) return;
@@ -2,6 +2,21 @@ import 'dart:io';
 
 import 'package:flutter/services.dart';
 
+/// Wraps an event channel listener so it also accepts batched events: native
+/// code may send several events as one list, which are then handled one by
+/// one in order.
+void Function(dynamic) unbatchEvents(void Function(dynamic) listener) {
+  return (dynamic event) {
+    if (event is List) {
+      for (final e in event) {
+        listener(e);
+      }
+    } else {
+      listener(event);
+    }
+  };
+}
+
 class WebRTC {
   static const MethodChannel _channel = MethodChannel('FlutterWebRTC.Method');
 
@@ -11,6 +11,7 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -78,6 +79,20 @@ EncodedType EncodedTypeForValue(const EncodableValue& value) {
   return EncodedType::kNull;
 }
 
+// Encoders run |write| twice: once against a counting writer to learn the
+// exact encoded size, then against the real buffer. Large replies and
+// events are written with a single allocation and no reallocation.
+template <typename WriteFunction>
+std::unique_ptr<std::vector<uint8_t>> Encode(const WriteFunction& write) {
+  ByteCountingStreamWriter counter;
+  write(&counter);
+  auto encoded = std::make_unique<std::vector<uint8_t>>();
+  encoded->reserve(counter.size());
+  ByteBufferStreamWriter stream(encoded.get());
+  write(&stream);
+  return encoded;
+}
+
 }  // namespace
 
 StandardCodecSerializer::StandardCodecSerializer() = default;
@@ -272,7 +287,7 @@ EncodableValue StandardCodecSerializer::ReadVector(
 }
 
 template <typename T>
-void StandardCodecSerializer::WriteVector(const std::vector<T> vector,
+void StandardCodecSerializer::WriteVector(const std::vector<T>& vector,
                                           ByteStreamWriter* stream) const {
   size_t count = vector.size();
   WriteSize(count, stream);
@@ -328,10 +343,9 @@ std::unique_ptr<EncodableValue> StandardMessageCodec::DecodeMessageInternal(
 std::unique_ptr<std::vector<uint8_t>>
 StandardMessageCodec::EncodeMessageInternal(
     const EncodableValue& message) const {
-  auto encoded = std::make_unique<std::vector<uint8_t>>();
-  ByteBufferStreamWriter stream(encoded.get());
-  serializer_->WriteValue(message, &stream);
-  return encoded;
+  return Encode([&](ByteStreamWriter* stream) {
+    serializer_->WriteValue(message, stream);
+  });
 }
 
 // ===== standard_method_codec.h =====
@@ -382,29 +396,28 @@ StandardMethodCodec::DecodeMethodCallInternal(const uint8_t* message,
 std::unique_ptr<std::vector<uint8_t>>
 StandardMethodCodec::EncodeMethodCallInternal(
     const MethodCall<EncodableValue>& method_call) const {
-  auto encoded = std::make_unique<std::vector<uint8_t>>();
-  ByteBufferStreamWriter stream(encoded.get());
-  serializer_->WriteValue(EncodableValue(method_call.method_name()), &stream);
-  if (method_call.arguments()) {
-    serializer_->WriteValue(*method_call.arguments(), &stream);
-  } else {
-    serializer_->WriteValue(EncodableValue(), &stream);
-  }
-  return encoded;
+  EncodableValue method_name(method_call.method_name());
+  return Encode([&](ByteStreamWriter* stream) {
+    serializer_->WriteValue(method_name, stream);
+    if (method_call.arguments()) {
+      serializer_->WriteValue(*method_call.arguments(), stream);
+    } else {
+      serializer_->WriteValue(EncodableValue(), stream);
+    }
+  });
 }
 
 std::unique_ptr<std::vector<uint8_t>>
 StandardMethodCodec::EncodeSuccessEnvelopeInternal(
     const EncodableValue* result) const {
-  auto encoded = std::make_unique<std::vector<uint8_t>>();
-  ByteBufferStreamWriter stream(encoded.get());
-  stream.WriteByte(0);
-  if (result) {
-    serializer_->WriteValue(*result, &stream);
-  } else {
-    serializer_->WriteValue(EncodableValue(), &stream);
-  }
-  return encoded;
+  return Encode([&](ByteStreamWriter* stream) {
+    stream->WriteByte(0);
+    if (result) {
+      serializer_->WriteValue(*result, stream);
+    } else {
+      serializer_->WriteValue(EncodableValue(), stream);
+    }
+  });
 }
 
 std::unique_ptr<std::vector<uint8_t>>
@@ -412,21 +425,19 @@ StandardMethodCodec::EncodeErrorEnvelopeInternal(
     const std::string& error_code,
     const std::string& error_message,
     const EncodableValue* error_details) const {
-  auto encoded = std::make_unique<std::vector<uint8_t>>();
-  ByteBufferStreamWriter stream(encoded.get());
-  stream.WriteByte(1);
-  serializer_->WriteValue(EncodableValue(error_code), &stream);
-  if (error_message.empty()) {
-    serializer_->WriteValue(EncodableValue(), &stream);
-  } else {
-    serializer_->WriteValue(EncodableValue(error_message), &stream);
-  }
-  if (error_details) {
-    serializer_->WriteValue(*error_details, &stream);
-  } else {
-    serializer_->WriteValue(EncodableValue(), &stream);
-  }
-  return encoded;
+  EncodableValue code(error_code);
+  EncodableValue message =
+      error_message.empty() ? EncodableValue() : EncodableValue(error_message);
+  return Encode([&](ByteStreamWriter* stream) {
+    stream->WriteByte(1);
+    serializer_->WriteValue(code, stream);
+    serializer_->WriteValue(message, stream);
+    if (error_details) {
+      serializer_->WriteValue(*error_details, stream);
+    } else {
+      serializer_->WriteValue(EncodableValue(), stream);
+    }
+  });
 }
 
 bool StandardMethodCodec::DecodeAndProcessResponseEnvelopeInternal(
@@ -67,6 +67,19 @@ class FlutterWebRTCPluginImpl : public FlutterWebRTCPlugin {
 
 void flutter_web_r_t_c_plugin_register_with_registrar(
     FlPluginRegistrar* registrar) {
+  // Events are sent from the GLib main loop, which is the platform thread.
+  EventChannelProxy::SetPlatformTaskRunner([](std::function<void()> task) {
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        [](gpointer data) -> gboolean {
+          (*static_cast<std::function<void()>*>(data))();
+          return G_SOURCE_REMOVE;
+        },
+        new std::function<void()>(std::move(task)),
+        [](gpointer data) {
+          delete static_cast<std::function<void()>*>(data);
+        });
+  });
   static auto* plugin_registrar = new flutter::PluginRegistrar(registrar);
   flutter_webrtc_plugin::FlutterWebRTCPluginImpl::RegisterWithRegistrar(
       plugin_registrar);
@@ -3,8 +3,47 @@
 #include "flutter_common.h"
 #include "flutter_webrtc.h"
 
+#include <windows.h>
+
+#include <functional>
+#include <memory>
+
 const char* kChannelName = "FlutterWebRTC.Method";
 
+namespace {
+
+const wchar_t kTaskWindowClass[] = L"FlutterWebRTCPlatformTaskWindow";
+const UINT kRunTaskMessage = WM_APP + 1;
+
+LRESULT CALLBACK TaskWindowProc(HWND window,
+                                UINT message,
+                                WPARAM wparam,
+                                LPARAM lparam) {
+  if (message == kRunTaskMessage) {
+    std::unique_ptr<std::function<void()>> task(
+        reinterpret_cast<std::function<void()>*>(lparam));
+    (*task)();
+    return 0;
+  }
+  return DefWindowProcW(window, message, wparam, lparam);
+}
+
+// A message-only window owned by the platform thread. The runner's message
+// loop dispatches what is posted to it, which makes it the platform task
+// runner: the engine has no C API to post to that thread.
+HWND CreateTaskWindow() {
+  WNDCLASSW window_class = {};
+  window_class.lpfnWndProc = TaskWindowProc;
+  window_class.hInstance = GetModuleHandleW(nullptr);
+  window_class.lpszClassName = kTaskWindowClass;
+  RegisterClassW(&window_class);
+  return CreateWindowExW(0, kTaskWindowClass, L"", 0, 0, 0, 0, 0,
+                         HWND_MESSAGE, nullptr, window_class.hInstance,
+                         nullptr);
+}
+
+}  // namespace
+
 namespace flutter_webrtc_plugin {
 
 // A webrtc plugin for windows/linux.
@@ -66,6 +105,17 @@ class FlutterWebRTCPluginImpl : public FlutterWebRTCPlugin {
 
 void FlutterWebRTCPluginRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar) {
+  // Registration runs on the platform thread, which then owns the window.
+  static HWND task_window = CreateTaskWindow();
+  if (task_window) {
+    EventChannelProxy::SetPlatformTaskRunner([](std::function<void()> task) {
+      auto* pending = new std::function<void()>(std::move(task));
+      if (!PostMessageW(task_window, kRunTaskMessage, 0,
+                        reinterpret_cast<LPARAM>(pending))) {
+        delete pending;
+      }
+    });
+  }
   static auto* plugin_registrar = new flutter::PluginRegistrar(registrar);
   flutter_webrtc_plugin::FlutterWebRTCPluginImpl::RegisterWithRegistrar(
       plugin_registrar);